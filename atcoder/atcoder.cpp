@@ -6,11 +6,19 @@
 #include "atcoder/dsu"
 #include "atcoder/fenwicktree"
 #include "atcoder/modint"
+#include "atcoder/modmatrix"
 #include "atcoder/math"
 #include "atcoder/bitset"
+#include "atcoder/rankselect"
+#include "atcoder/compressedbitset"
+#include "atcoder/bitmatrix"
+#include "atcoder/string"
 #include "atcoder/segtree"
 #include "atcoder/lazysegtree"
 #include "atcoder/scc"
+#include "atcoder/convolution"
+#include "atcoder/fps"
+#include "atcoder/internal_cpu"
 
 
 
@@ -47,13 +55,22 @@ PyInit_atcoder(void)
         &DsuType,
         &FenwickTreeType,
         &ModIntType,
+        &ModMatrixType,
         &BitSetType,
+        &RankSelectType,
+        &CompressedBitSetType,
+        &BitMatrixType,
         &SegTreeType,
         &LazySegTreeType,
         &SCCGraphType,
         NULL
     };
 
+    internal::cpu_detect();
+    internal::ntt_select_kernel();
+    internal::modmatrix_select_kernel();
+    internal::bitset_select_kernel();
+
     m = PyModule_Create(&atcodermodule);
     if (m == NULL)
         return NULL;
@@ -65,7 +82,12 @@ PyInit_atcoder(void)
         Py_INCREF(typelist[i]);
         PyModule_AddObject(m, name, (PyObject *)typelist[i]);
     }
+    if (PyType_Ready(&BitSetIterType) < 0 || PyType_Ready(&CompressedBitSetIterType) < 0)
+        return NULL;
     PyModule_AddFunctions(m, mathfunctions);
+    PyModule_AddFunctions(m, convolutionfunctions);
+    PyModule_AddFunctions(m, fpsfunctions);
+    PyModule_AddFunctions(m, stringfunctions);
     return m;
 }
 
@@ -0,0 +1,1026 @@
+#ifndef ACL_PYTHON_BITMATRIX
+#define ACL_PYTHON_BITMATRIX
+
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <structmember.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+
+#include "atcoder/utils"
+#include "atcoder/bitset"
+#include "atcoder/internal_bitset"
+
+
+
+namespace atcoder_python {
+
+
+/* bitmatrix object ***************************************/
+
+/* Dense matrix over GF(2).
+
+    >>> a = BitMatrix([[1, 1, 0], [0, 1, 1], [1, 0, 1]])
+    >>> a.rank()
+    2
+    >>> a.solve(BitSet("011"))      # b = (1, 1, 0): bit 0 is the last character
+    010                             # x = (0, 1, 0)
+    >>> a.nullspace().tolist()
+    [[1, 1, 1]]
+
+    Row i is packed like a BitSet: column j is bit j & 63 of word j >> 6,
+    and every row takes w = ceil(m / 64) words of one array. Row
+    operations are word XORs through the BitSet kernels (SIMD when
+    available).
+
+    Elimination and multiplication use the Method of Four Russians with
+    8-column chunks. For elimination the pivots of a chunk are found
+    looking at one word per row, then the 256 XOR combinations of the
+    chunk's pivot rows are tabulated and every other row is cleared in
+    the chunk with a single table-row XOR. The product XORs, for every
+    row of A and every byte of it, one row of the table of combinations
+    of the 8 matching rows of B.
+
+*/
+
+
+extern PyTypeObject BitMatrixType;
+
+#define BitMatrix_Check(v) PyObject_TypeCheck(v, &BitMatrixType)
+
+#define BITMATRIX_K 8
+#define BITMATRIX_MAX_BITS (1LL << 32)
+
+
+struct BitMatrixObject
+{
+    PyObject_HEAD
+    int n, m;
+    int w;  // words per row
+    std::vector<unsigned long long> a;
+};
+
+
+namespace internal {
+
+static inline int
+bitmatrix_test(const unsigned long long *row, int j) {
+    return (int)(row[j >> 6] >> (j & 63) & 1);
+}
+
+/* t[s] (len words) = XOR of rows[i] over the bits i of s, for s < 2^k */
+static void
+bitmatrix_make_table(std::vector<unsigned long long> &t, const unsigned long long *const *rows,
+                     int k, int len) {
+    t.assign((size_t)len << k, 0);
+    for (int s = 1; s < (1 << k); s++) {
+        unsigned long long *dst = t.data() + (size_t)s * len;
+        std::memcpy(dst, t.data() + (size_t)(s & (s - 1)) * len, sizeof(unsigned long long) * len);
+        bitset_kernels.xor_(dst, rows[__builtin_ctz(s)], len);
+    }
+}
+
+/* Row echelon form of the n x (64 w) matrix a on its first cols columns
+   (reduced if `reduced`), by M4RI. It returns the rank and appends the
+   pivot columns to pivots. */
+static int
+bitmatrix_eliminate(unsigned long long *a, int n, int w, int cols, bool reduced,
+                    std::vector<int> *pivots) {
+    std::vector<unsigned long long> table;
+    int r = 0;
+    for (int c = 0; c < cols && r < n; c += BITMATRIX_K) {
+        // the chunk [c, c + K) lies in word w0, since 64 % K == 0
+        int w0 = c >> 6, len = w - w0;
+        int kc = std::min(BITMATRIX_K, cols - c);
+        int pc[BITMATRIX_K], np = 0;
+        const unsigned long long *prow[BITMATRIX_K];
+        for (int j = 0; j < kc && r + np < n; j++) {
+            int col = c + j, found = -1;
+            for (int i = r + np; i < n && found < 0; i++) {
+                // word w0 of row i reduced by the pivots found so far
+                unsigned long long v = a[(size_t)i * w + w0];
+                for (int t = 0; t < np; t++) {
+                    if (v >> (pc[t] & 63) & 1) v ^= prow[t][w0];
+                }
+                if (v >> (col & 63) & 1) found = i;
+            }
+            if (found < 0) continue;
+            unsigned long long *p = a + (size_t)(r + np) * w;
+            if (found != r + np) std::swap_ranges(p, p + w, a + (size_t)found * w);
+            for (int t = 0; t < np; t++) {
+                if (bitmatrix_test(p, pc[t])) bitset_kernels.xor_(p + w0, prow[t] + w0, len);
+            }
+            // keep the pivot rows of the chunk reduced among themselves
+            for (int t = 0; t < np; t++) {
+                unsigned long long *q = a + (size_t)(r + t) * w;
+                if (bitmatrix_test(q, col)) bitset_kernels.xor_(q + w0, p + w0, len);
+            }
+            pc[np] = col;
+            prow[np] = p;
+            np++;
+        }
+        if (np == 0) continue;
+        std::vector<const unsigned long long *> trows(np);
+        for (int t = 0; t < np; t++) trows[t] = prow[t] + w0;
+        bitmatrix_make_table(table, trows.data(), np, len);
+        // every row but the pivot rows [r, r + np)
+        for (int i = (reduced && r) ? 0 : r + np; i < n; i = (i + 1 == r) ? r + np : i + 1) {
+            unsigned long long *row = a + (size_t)i * w;
+            unsigned long long v = row[w0];
+            int s = 0;
+            for (int t = 0; t < np; t++) s |= (int)(v >> (pc[t] & 63) & 1) << t;
+            if (s) bitset_kernels.xor_(row + w0, table.data() + (size_t)s * len, len);
+        }
+        if (pivots) pivots->insert(pivots->end(), pc, pc + np);
+        r += np;
+    }
+    return r;
+}
+
+/* c (n x m, wc words per row) ^= a (n x k, wa words) * b (k x m, wc words) */
+static void
+bitmatrix_mul_impl(const unsigned long long *a, const unsigned long long *b, unsigned long long *c,
+                   int n, int k, int wa, int wc) {
+    std::vector<unsigned long long> table;
+    const unsigned long long *rows[BITMATRIX_K];
+    for (int l = 0; l < k; l += BITMATRIX_K) {
+        int kc = std::min(BITMATRIX_K, k - l);
+        for (int t = 0; t < kc; t++) rows[t] = b + (size_t)(l + t) * wc;
+        bitmatrix_make_table(table, rows, kc, wc);
+        // the bits of a past column k are 0, so s < 2^kc
+        for (int i = 0; i < n; i++) {
+            int s = (int)(a[(size_t)i * wa + (l >> 6)] >> (l & 63) & 255);
+            if (s) bitset_kernels.xor_(c + (size_t)i * wc, table.data() + (size_t)s * wc, wc);
+        }
+    }
+}
+
+/* dst[0, len) = bits [off, off + len) of src; the words of dst past len are 0 */
+static void
+bitmatrix_copy_bits(unsigned long long *dst, const unsigned long long *src, int src_words,
+                    int off, int len) {
+    int words = (len + 63) >> 6, w0 = off >> 6, sft = off & 63;
+    for (int i = 0; i < words; i++) {
+        unsigned long long x = src[w0 + i] >> sft;
+        if (sft && w0 + i + 1 < src_words) x |= src[w0 + i + 1] << (64 - sft);
+        dst[i] = x;
+    }
+    if (len & 63) dst[words - 1] &= (1ULL << (len & 63)) - 1;
+}
+
+} // namespace internal
+
+
+
+static BitMatrixObject *
+bitmatrix_alloc(int n, int m) {
+    BitMatrixObject *self = (BitMatrixObject *)BitMatrixType.tp_alloc(&BitMatrixType, 0);
+    if (self == NULL) return NULL;
+    self->n = n;
+    self->m = m;
+    self->w = (m + 63) >> 6;
+    self->a = std::vector<unsigned long long>((size_t)n * self->w, 0);
+    return self;
+}
+
+static int
+bitmatrix_check_shape(long long n, long long m) {
+    if (n < 0 || m < 0 || n > INT_MAX || m > INT_MAX || (n && m > BITMATRIX_MAX_BITS / n)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n, m and n * m <= 2^32");
+        return -1;
+    }
+    return 0;
+}
+
+static int
+bitmatrix_check_square(BitMatrixObject *self, const char *name) {
+    if (self->n != self->m) {
+        PyErr_Format(PyExc_ValueError, "%s() requires a square matrix (shape: %d x %d)",
+                     name, self->n, self->m);
+        return -1;
+    }
+    return 0;
+}
+
+static inline unsigned long long *
+bitmatrix_row(BitMatrixObject *self, int i) {
+    return self->a.data() + (size_t)i * self->w;
+}
+
+/* row i as a new BitSet */
+static PyObject *
+bitmatrix_row_impl(BitMatrixObject *self, int i) {
+    BitSetObject *z = _bitset_zeros(self->m);
+    if (z == NULL) return NULL;
+    std::copy(bitmatrix_row(self, i), bitmatrix_row(self, i) + self->w, z->bs.begin());
+    return (PyObject *)z;
+}
+
+
+static PyObject *
+bitmatrix_tolist_impl(BitMatrixObject *self) {
+    PyObject *list = PyList_New(self->n);
+    if (list == NULL) return NULL;
+    for (int i = 0; i < self->n; i++) {
+        PyObject *row = PyList_New(self->m);
+        if (row == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        const unsigned long long *r = bitmatrix_row(self, i);
+        for (int j = 0; j < self->m; j++) {
+            PyList_SET_ITEM(row, j, PyLong_FromLong(internal::bitmatrix_test(r, j)));
+        }
+        PyList_SET_ITEM(list, i, row);
+    }
+    return list;
+}
+
+static PyObject *
+bitmatrix_tolist(BitMatrixObject *self, PyObject *args) {
+    return bitmatrix_tolist_impl(self);
+}
+
+PyDoc_STRVAR(bitmatrix_tolist_doc,
+"tolist()\n"
+"--\n\n"
+"Conversion to list of rows\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : list[list[int]]\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm)"
+);
+
+#define ACL_PYTHON_BITMATRIX_TOLIST_METHODDEF \
+    {"tolist", (PyCFunction)bitmatrix_tolist, METH_NOARGS, bitmatrix_tolist_doc},
+
+
+static PyObject *
+bitmatrix_repr(BitMatrixObject *self) {
+    PyObject *list = bitmatrix_tolist_impl(self);
+    if (list == NULL) return NULL;
+    PyObject *name = PyUnicode_FromString("BitMatrix");
+    PyObject *res = sequential_object_repr((PyListObject *)list, name);
+    Py_DECREF(name);
+    Py_DECREF(list);
+    return res;
+}
+
+
+static PyObject *
+bitmatrix_row_method(BitMatrixObject *self, PyObject *arg) {
+    long i = PyLong_AsLong(arg);
+    CHECK_CONVERT(i);
+    if (i < 0) i += self->n;
+    CHECK_INDEX_RANGE(i, self->n);
+    return bitmatrix_row_impl(self, (int)i);
+}
+
+PyDoc_STRVAR(bitmatrix_row_doc,
+"row(i)\n"
+"--\n\n"
+"It returns row i as a BitSet of length m.\n\n"
+"Parameters\n"
+"----------\n"
+"i : int\n"
+"    row index\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : BitSet\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"-n <= i < n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(m / w)"
+);
+
+#define ACL_PYTHON_BITMATRIX_ROW_METHODDEF \
+    {"row", (PyCFunction)bitmatrix_row_method, METH_O, bitmatrix_row_doc},
+
+
+static PyObject *
+bitmatrix_rows(BitMatrixObject *self, PyObject *args) {
+    PyObject *list = PyList_New(self->n);
+    if (list == NULL) return NULL;
+    for (int i = 0; i < self->n; i++) {
+        PyObject *row = bitmatrix_row_impl(self, i);
+        if (row == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, row);
+    }
+    return list;
+}
+
+PyDoc_STRVAR(bitmatrix_rows_doc,
+"rows()\n"
+"--\n\n"
+"Conversion to a list of BitSet rows\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : list[BitSet]\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm / w)"
+);
+
+#define ACL_PYTHON_BITMATRIX_ROWS_METHODDEF \
+    {"rows", (PyCFunction)bitmatrix_rows, METH_NOARGS, bitmatrix_rows_doc},
+
+
+static PyObject *
+bitmatrix_transpose(BitMatrixObject *self, PyObject *args) {
+    BitMatrixObject *z = bitmatrix_alloc(self->m, self->n);
+    if (z == NULL) return NULL;
+    for (int i = 0; i < self->n; i++) {
+        const unsigned long long *r = bitmatrix_row(self, i);
+        for (int k = 0; k < self->w; k++) {
+            for (unsigned long long x = r[k]; x; x &= x - 1) {
+                int j = (k << 6) | __builtin_ctzll(x);
+                bitmatrix_row(z, j)[i >> 6] |= 1ULL << (i & 63);
+            }
+        }
+    }
+    return (PyObject *)z;
+}
+
+PyDoc_STRVAR(bitmatrix_transpose_doc,
+"transpose()\n"
+"--\n\n"
+"It returns the transposed matrix.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : BitMatrix\n"
+"    m x n matrix\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm / w + the number of ones)"
+);
+
+#define ACL_PYTHON_BITMATRIX_TRANSPOSE_METHODDEF \
+    {"transpose", (PyCFunction)bitmatrix_transpose, METH_NOARGS, bitmatrix_transpose_doc},
+
+
+static PyObject *
+bitmatrix_rank(BitMatrixObject *self, PyObject *args) {
+    std::vector<unsigned long long> a = self->a;
+    int n = self->n, w = self->w, m = self->m, r;
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::bitmatrix_eliminate(a.data(), n, w, m, false, NULL);
+    Py_END_ALLOW_THREADS
+    return PyLong_FromLong(r);
+}
+
+PyDoc_STRVAR(bitmatrix_rank_doc,
+"rank()\n"
+"--\n\n"
+"It returns the rank over GF(2).\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm min(n, m) / (8w))"
+);
+
+#define ACL_PYTHON_BITMATRIX_RANK_METHODDEF \
+    {"rank", (PyCFunction)bitmatrix_rank, METH_NOARGS, bitmatrix_rank_doc},
+
+
+static PyObject *
+bitmatrix_reduce(BitMatrixObject *self, PyObject *args) {
+    BitMatrixObject *z = bitmatrix_alloc(self->n, self->m);
+    if (z == NULL) return NULL;
+    z->a = self->a;
+    int n = self->n, w = self->w, m = self->m;
+    Py_BEGIN_ALLOW_THREADS
+    internal::bitmatrix_eliminate(z->a.data(), n, w, m, true, NULL);
+    Py_END_ALLOW_THREADS
+    return (PyObject *)z;
+}
+
+PyDoc_STRVAR(bitmatrix_reduce_doc,
+"reduce()\n"
+"--\n\n"
+"It returns the reduced row echelon form.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : BitMatrix\n"
+"    n x m matrix; the zero rows come last\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n^2 m / (8w))"
+);
+
+#define ACL_PYTHON_BITMATRIX_REDUCE_METHODDEF \
+    {"reduce", (PyCFunction)bitmatrix_reduce, METH_NOARGS, bitmatrix_reduce_doc},
+
+
+/* NULL with ValueError if it is singular */
+static BitMatrixObject *
+bitmatrix_inv_impl(BitMatrixObject *self) {
+    int n = self->n, w = (2 * n + 63) >> 6, r;
+    std::vector<unsigned long long> a((size_t)n * w, 0);
+    for (int i = 0; i < n; i++) {
+        unsigned long long *row = a.data() + (size_t)i * w;
+        std::copy(bitmatrix_row(self, i), bitmatrix_row(self, i) + self->w, row);
+        row[(n + i) >> 6] |= 1ULL << ((n + i) & 63);
+    }
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::bitmatrix_eliminate(a.data(), n, w, n, true, NULL);
+    Py_END_ALLOW_THREADS
+    if (r < n) {
+        PyErr_SetString(PyExc_ValueError, "the matrix is singular");
+        return NULL;
+    }
+    BitMatrixObject *z = bitmatrix_alloc(n, n);
+    if (z == NULL) return NULL;
+    for (int i = 0; i < n; i++) {
+        internal::bitmatrix_copy_bits(bitmatrix_row(z, i), a.data() + (size_t)i * w, w, n, n);
+    }
+    return z;
+}
+
+static PyObject *
+bitmatrix_inv(BitMatrixObject *self, PyObject *args) {
+    if (bitmatrix_check_square(self, "inv")) return NULL;
+    return (PyObject *)bitmatrix_inv_impl(self);
+}
+
+PyDoc_STRVAR(bitmatrix_inv_doc,
+"inv()\n"
+"--\n\n"
+"It returns the inverse matrix.\n"
+"If the matrix is singular, it raises ValueError.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : BitMatrix\n"
+"    inverse matrix\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"n == m\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n^3 / (4w))"
+);
+
+#define ACL_PYTHON_BITMATRIX_INV_METHODDEF \
+    {"inv", (PyCFunction)bitmatrix_inv, METH_NOARGS, bitmatrix_inv_doc},
+
+
+static PyObject *
+bitmatrix_solve(BitMatrixObject *self, PyObject *arg) {
+    if (!BitSet_Check(arg) || ((BitSetObject *)arg)->n != self->n) {
+        PyErr_Format(PyExc_ValueError, "solve() takes a BitSet of length %d", self->n);
+        return NULL;
+    }
+    BitSetObject *b = (BitSetObject *)arg;
+    int n = self->n, m = self->m, w = (m + 1 + 63) >> 6, r;
+    std::vector<unsigned long long> a((size_t)n * w, 0);
+    for (int i = 0; i < n; i++) {
+        unsigned long long *row = a.data() + (size_t)i * w;
+        std::copy(bitmatrix_row(self, i), bitmatrix_row(self, i) + self->w, row);
+        if (_bitset_test(b, i)) row[m >> 6] |= 1ULL << (m & 63);
+    }
+    std::vector<int> pivots;
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::bitmatrix_eliminate(a.data(), n, w, m, true, &pivots);
+    Py_END_ALLOW_THREADS
+    for (int i = r; i < n; i++) {
+        if (internal::bitmatrix_test(a.data() + (size_t)i * w, m)) Py_RETURN_NONE;
+    }
+    BitSetObject *x = _bitset_zeros(m);
+    if (x == NULL) return NULL;
+    for (int i = 0; i < r; i++) {
+        if (internal::bitmatrix_test(a.data() + (size_t)i * w, m)) {
+            x->bs[pivots[i] >> 6] |= 1ULL << (pivots[i] & 63);
+        }
+    }
+    return (PyObject *)x;
+}
+
+PyDoc_STRVAR(bitmatrix_solve_doc,
+"solve(b)\n"
+"--\n\n"
+"It returns a solution x of A x = b over GF(2), or None if there is none.\n"
+"The free variables of x are set to 0.\n\n"
+"Parameters\n"
+"----------\n"
+"b : BitSet\n"
+"    right-hand side of length n\n"
+"\n"
+"Returns\n"
+"-------\n"
+"x : BitSet | None\n"
+"    solution of length m\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"len(b) == n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm min(n, m) / (8w))"
+);
+
+#define ACL_PYTHON_BITMATRIX_SOLVE_METHODDEF \
+    {"solve", (PyCFunction)bitmatrix_solve, METH_O, bitmatrix_solve_doc},
+
+
+static PyObject *
+bitmatrix_nullspace(BitMatrixObject *self, PyObject *args) {
+    std::vector<unsigned long long> a = self->a;
+    int n = self->n, w = self->w, m = self->m, r;
+    std::vector<int> pivots;
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::bitmatrix_eliminate(a.data(), n, w, m, true, &pivots);
+    Py_END_ALLOW_THREADS
+    std::vector<char> is_pivot(m, 0);
+    for (int p : pivots) is_pivot[p] = 1;
+    BitMatrixObject *z = bitmatrix_alloc(m - r, m);
+    if (z == NULL) return NULL;
+    // for a free column f: x_f = 1 and x_{pivots[i]} = (row i)_f
+    for (int f = 0, k = 0; f < m; f++) {
+        if (is_pivot[f]) continue;
+        unsigned long long *v = bitmatrix_row(z, k++);
+        v[f >> 6] |= 1ULL << (f & 63);
+        for (int i = 0; i < r; i++) {
+            if (internal::bitmatrix_test(a.data() + (size_t)i * w, f)) {
+                v[pivots[i] >> 6] |= 1ULL << (pivots[i] & 63);
+            }
+        }
+    }
+    return (PyObject *)z;
+}
+
+PyDoc_STRVAR(bitmatrix_nullspace_doc,
+"nullspace()\n"
+"--\n\n"
+"It returns a basis of the solutions of A x = 0 as the rows of a matrix.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : BitMatrix\n"
+"    (m - rank) x m matrix\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm min(n, m) / (8w) + m^2)"
+);
+
+#define ACL_PYTHON_BITMATRIX_NULLSPACE_METHODDEF \
+    {"nullspace", (PyCFunction)bitmatrix_nullspace, METH_NOARGS, bitmatrix_nullspace_doc},
+
+
+static PyObject *
+bitmatrix_identity(PyObject *type, PyObject *arg) {
+    long n = PyLong_AsLong(arg);
+    CHECK_CONVERT(n);
+    if (bitmatrix_check_shape(n, n)) return NULL;
+    BitMatrixObject *z = bitmatrix_alloc((int)n, (int)n);
+    if (z == NULL) return NULL;
+    for (int i = 0; i < n; i++) bitmatrix_row(z, i)[i >> 6] |= 1ULL << (i & 63);
+    return (PyObject *)z;
+}
+
+PyDoc_STRVAR(bitmatrix_identity_doc,
+"identity(n)\n"
+"--\n\n"
+"It returns the identity matrix of size n.\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    size\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : BitMatrix\n"
+"    n x n identity matrix\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n <= 2^16\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n^2 / w)"
+);
+
+#define ACL_PYTHON_BITMATRIX_IDENTITY_METHODDEF \
+    {"identity", (PyCFunction)bitmatrix_identity, METH_O | METH_CLASS, bitmatrix_identity_doc},
+
+
+static PyMethodDef bitmatrix_methods[] = {
+    ACL_PYTHON_BITMATRIX_TOLIST_METHODDEF
+    ACL_PYTHON_BITMATRIX_ROW_METHODDEF
+    ACL_PYTHON_BITMATRIX_ROWS_METHODDEF
+    ACL_PYTHON_BITMATRIX_TRANSPOSE_METHODDEF
+    ACL_PYTHON_BITMATRIX_RANK_METHODDEF
+    ACL_PYTHON_BITMATRIX_REDUCE_METHODDEF
+    ACL_PYTHON_BITMATRIX_INV_METHODDEF
+    ACL_PYTHON_BITMATRIX_SOLVE_METHODDEF
+    ACL_PYTHON_BITMATRIX_NULLSPACE_METHODDEF
+    ACL_PYTHON_BITMATRIX_IDENTITY_METHODDEF
+    {NULL} /* Sentinel */
+};
+
+
+static PyObject *
+bitmatrix_get_shape(BitMatrixObject *self, void *closure) {
+    return Py_BuildValue("(ii)", self->n, self->m);
+}
+
+static PyGetSetDef bitmatrix_getsets[] = {
+    {"shape", (getter)bitmatrix_get_shape, NULL, "(n, m)", NULL},
+    {NULL} /* Sentinel */
+};
+
+
+/* number protocol ****************************************/
+
+/* A x for a BitSet x of length m: bit i is the parity of row i & x */
+static PyObject *
+bitmatrix_mul_vector(BitMatrixObject *a, BitSetObject *x) {
+    if (x->n != a->m) {
+        PyErr_Format(PyExc_ValueError, "shapes (%d x %d) and BitSet(%d) are not aligned",
+                     a->n, a->m, x->n);
+        return NULL;
+    }
+    BitSetObject *z = _bitset_zeros(a->n);
+    if (z == NULL) return NULL;
+    for (int i = 0; i < a->n; i++) {
+        const unsigned long long *r = bitmatrix_row(a, i);
+        unsigned long long acc = 0;
+        for (int k = 0; k < a->w; k++) acc ^= r[k] & x->bs[k];
+        if (__builtin_parityll(acc)) z->bs[i >> 6] |= 1ULL << (i & 63);
+    }
+    return (PyObject *)z;
+}
+
+static PyObject *
+bitmatrix_matmul(PyObject *v, PyObject *w) {
+    if (BitMatrix_Check(v) && BitSet_Check(w)) {
+        return bitmatrix_mul_vector((BitMatrixObject *)v, (BitSetObject *)w);
+    }
+    if (!BitMatrix_Check(v) || !BitMatrix_Check(w)) Py_RETURN_NOTIMPLEMENTED;
+    BitMatrixObject *a = (BitMatrixObject *)v, *b = (BitMatrixObject *)w;
+    if (a->m != b->n) {
+        PyErr_Format(PyExc_ValueError, "shapes (%d x %d) and (%d x %d) are not aligned",
+                     a->n, a->m, b->n, b->m);
+        return NULL;
+    }
+    if (bitmatrix_check_shape(a->n, b->m)) return NULL;
+    BitMatrixObject *z = bitmatrix_alloc(a->n, b->m);
+    if (z == NULL) return NULL;
+    // copied with the GIL held: another thread may re-initialize a or b
+    std::vector<unsigned long long> x = a->a, y;
+    if (b != a) y = b->a;
+    const unsigned long long *yp = b != a ? y.data() : x.data();
+    int n = a->n, m = a->m, aw = a->w, zw = z->w;
+    Py_BEGIN_ALLOW_THREADS
+    internal::bitmatrix_mul_impl(x.data(), yp, z->a.data(), n, m, aw, zw);
+    Py_END_ALLOW_THREADS
+    return (PyObject *)z;
+}
+
+/* addition over GF(2) is XOR */
+static PyObject *
+bitmatrix_add(PyObject *v, PyObject *w) {
+    if (!BitMatrix_Check(v) || !BitMatrix_Check(w)) Py_RETURN_NOTIMPLEMENTED;
+    BitMatrixObject *a = (BitMatrixObject *)v, *b = (BitMatrixObject *)w;
+    if (a->n != b->n || a->m != b->m) {
+        PyErr_Format(PyExc_ValueError, "shapes (%d x %d) and (%d x %d) differ",
+                     a->n, a->m, b->n, b->m);
+        return NULL;
+    }
+    BitMatrixObject *z = bitmatrix_alloc(a->n, a->m);
+    if (z == NULL) return NULL;
+    z->a = a->a;
+    internal::bitset_kernels.xor_(z->a.data(), b->a.data(), (int)z->a.size());
+    return (PyObject *)z;
+}
+
+
+static PyNumberMethods bitmatrix_as_number = {
+    .nb_add = (binaryfunc)bitmatrix_add,
+    .nb_subtract = (binaryfunc)bitmatrix_add,
+    .nb_xor = (binaryfunc)bitmatrix_add,
+    .nb_matrix_multiply = (binaryfunc)bitmatrix_matmul,
+};
+
+
+/* mapping protocol: M[i, j], M[i] ************************/
+
+static int
+bitmatrix_parse_index(BitMatrixObject *self, PyObject *key, int *i, int *j) {
+    if (!PyTuple_Check(key) || PyTuple_GET_SIZE(key) != 2) {
+        PyErr_SetString(PyExc_TypeError, "BitMatrix indices must be a row i or a pair (i, j)");
+        return -1;
+    }
+    long x = PyLong_AsLong(PyTuple_GET_ITEM(key, 0));
+    if (x == -1 && PyErr_Occurred()) return -1;
+    long y = PyLong_AsLong(PyTuple_GET_ITEM(key, 1));
+    if (y == -1 && PyErr_Occurred()) return -1;
+    if (x < 0) x += self->n;
+    if (y < 0) y += self->m;
+    if (x < 0 || x >= self->n || y < 0 || y >= self->m) {
+        PyErr_SetString(PyExc_IndexError, "BitMatrix index out of range");
+        return -1;
+    }
+    *i = (int)x;
+    *j = (int)y;
+    return 0;
+}
+
+static PyObject *
+bitmatrix_subscript(BitMatrixObject *self, PyObject *key) {
+    if (PyLong_Check(key)) return bitmatrix_row_method(self, key);
+    int i, j;
+    if (bitmatrix_parse_index(self, key, &i, &j)) return NULL;
+    return PyLong_FromLong(internal::bitmatrix_test(bitmatrix_row(self, i), j));
+}
+
+static int
+bitmatrix_ass_subscript(BitMatrixObject *self, PyObject *key, PyObject *value) {
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "BitMatrix elements cannot be deleted");
+        return -1;
+    }
+    if (PyLong_Check(key)) {
+        long i = PyLong_AsLong(key);
+        if (i == -1 && PyErr_Occurred()) return -1;
+        if (i < 0) i += self->n;
+        if (i < 0 || i >= self->n) {
+            PyErr_SetString(PyExc_IndexError, "BitMatrix index out of range");
+            return -1;
+        }
+        if (!BitSet_Check(value) || ((BitSetObject *)value)->n != self->m) {
+            PyErr_Format(PyExc_ValueError, "a row must be a BitSet of length %d", self->m);
+            return -1;
+        }
+        const std::vector<unsigned long long> &bs = ((BitSetObject *)value)->bs;
+        std::copy(bs.begin(), bs.end(), bitmatrix_row(self, (int)i));
+        return 0;
+    }
+    int i, j;
+    if (bitmatrix_parse_index(self, key, &i, &j)) return -1;
+    long v = PyLong_AsLong(value);
+    if (v == -1 && PyErr_Occurred()) return -1;
+    if (v != 0 && v != 1) {
+        PyErr_Format(PyExc_ValueError, "assigned value must be 0 or 1 (not %ld)", v);
+        return -1;
+    }
+    unsigned long long bit = 1ULL << (j & 63);
+    if (v) bitmatrix_row(self, i)[j >> 6] |= bit;
+    else bitmatrix_row(self, i)[j >> 6] &= ~bit;
+    return 0;
+}
+
+static Py_ssize_t
+bitmatrix_length(BitMatrixObject *self) {
+    return (Py_ssize_t)self->n;
+}
+
+static PyMappingMethods bitmatrix_as_mapping = {
+    .mp_length = (lenfunc)bitmatrix_length,
+    .mp_subscript = (binaryfunc)bitmatrix_subscript,
+    .mp_ass_subscript = (objobjargproc)bitmatrix_ass_subscript,
+};
+
+
+static PyObject *
+bitmatrix_richcompare(PyObject *self, PyObject *other, int op) {
+    if (!BitMatrix_Check(self) || !BitMatrix_Check(other)) Py_RETURN_NOTIMPLEMENTED;
+    if (op != Py_EQ && op != Py_NE) Py_RETURN_NOTIMPLEMENTED;
+    BitMatrixObject *a = (BitMatrixObject *)self, *b = (BitMatrixObject *)other;
+    bool eq = a->n == b->n && a->m == b->m && a->a == b->a;
+    if (eq == (op == Py_EQ)) Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+
+PyDoc_STRVAR(bitmatrix_doc,
+"Dense matrix over GF(2) with rows packed 64 columns per word.\n\n"
+"The following operations are supported:\n"
+"    '+', '-', '^' (elementwise XOR, between BitMatrix of the same shape)\n"
+"    '@' (product with a BitMatrix, or with a BitSet as a column vector)\n"
+"    M[i, j] (get or set an element), M[i] (get or set a row as BitSet)\n"
+"    '==', '!='\n\n"
+"BitMatrix(a)  (Constructor 1)\n"
+"    Parameters\n"
+"    ----------\n"
+"    a : list[BitSet] | list[list[int]]\n"
+"        rows of the same length\n"
+"    \n"
+"    Returns\n"
+"    -------\n"
+"    mat : BitMatrix\n"
+"    \n"
+"    Complexity\n"
+"    ----------\n"
+"    \u039F(nm / w) from BitSet rows, \u039F(nm) from lists\n\n"
+"BitMatrix(n, m)  (Constructor 2)\n"
+"    Parameters\n"
+"    ----------\n"
+"    n : int\n"
+"        number of rows\n"
+"    m : int\n"
+"        number of columns\n"
+"    \n"
+"    Returns\n"
+"    -------\n"
+"    mat : BitMatrix\n"
+"        zero matrix\n"
+"    \n"
+"    Constraints\n"
+"    -----------\n"
+"    0 <= n, m and n * m <= 2^32\n"
+"    \n"
+"    Complexity\n"
+"    ----------\n"
+"    \u039F(nm / w)\n\n"
+"Operations ('@' between matrices)\n"
+"    Method of Four Russians: one table of the 256 combinations of 8 rows\n"
+"    of B per 8 columns of A.\n"
+"    \n"
+"    Complexity\n"
+"    ----------\n"
+"    \u039F(nml / (8w))"
+);
+
+
+static int
+bitmatrix_init(BitMatrixObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *o, *o2 = NULL;
+    if (!PyArg_ParseTuple(args, "O|O", &o, &o2)) return -1;
+    if (o2 != NULL) {
+        long long n = PyLong_AsLongLong(o);
+        if (n == -1 && PyErr_Occurred()) return -1;
+        long long m = PyLong_AsLongLong(o2);
+        if (m == -1 && PyErr_Occurred()) return -1;
+        if (bitmatrix_check_shape(n, m)) return -1;
+        self->n = (int)n;
+        self->m = (int)m;
+        self->w = (self->m + 63) >> 6;
+        self->a = std::vector<unsigned long long>((size_t)n * self->w, 0);
+        return 0;
+    }
+    if (!PyList_Check(o)) {
+        PyErr_SetString(PyExc_TypeError, "required: 'list[BitSet]', 'list[list[int]]' or (n, m)");
+        return -1;
+    }
+    Py_ssize_t n = PyList_GET_SIZE(o), m = 0;
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *row = PyList_GET_ITEM(o, i);
+        Py_ssize_t len;
+        if (BitSet_Check(row)) len = ((BitSetObject *)row)->n;
+        else if (PyList_Check(row)) len = PyList_GET_SIZE(row);
+        else {
+            PyErr_SetString(PyExc_TypeError, "required: 'list[BitSet]', 'list[list[int]]' or (n, m)");
+            return -1;
+        }
+        if (i == 0) m = len;
+        if (len != m) {
+            PyErr_SetString(PyExc_ValueError, "all the rows must have the same length");
+            return -1;
+        }
+    }
+    if (bitmatrix_check_shape(n, m)) return -1;
+    int w = (int)((m + 63) >> 6);
+    std::vector<unsigned long long> a((size_t)n * w, 0);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *row = PyList_GET_ITEM(o, i);
+        unsigned long long *dst = a.data() + (size_t)i * w;
+        if (BitSet_Check(row)) {
+            const std::vector<unsigned long long> &bs = ((BitSetObject *)row)->bs;
+            std::copy(bs.begin(), bs.end(), dst);
+            continue;
+        }
+        for (Py_ssize_t j = 0; j < m; j++) {
+            long v = PyLong_AsLong(PyList_GET_ITEM(row, j));
+            if (v == -1 && PyErr_Occurred()) return -1;
+            if (v != 0 && v != 1) {
+                PyErr_Format(PyExc_ValueError, "elements must be 0 or 1 (not %ld)", v);
+                return -1;
+            }
+            if (v) dst[j >> 6] |= 1ULL << (j & 63);
+        }
+    }
+    self->n = (int)n;
+    self->m = (int)m;
+    self->w = w;
+    self->a = std::move(a);
+    return 0;
+}
+
+static PyObject *
+bitmatrix_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    BitMatrixObject *self;
+    self = (BitMatrixObject *)type->tp_alloc(type, 0);
+    if (self != NULL) {
+        self->n = self->m = self->w = 0;
+        self->a = std::vector<unsigned long long>();
+    }
+    return (PyObject *)self;
+}
+
+static void
+bitmatrix_dealloc(BitMatrixObject *self) {
+    std::vector<unsigned long long>().swap(self->a);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+
+PyTypeObject BitMatrixType = {
+    .ob_base = {PyObject_HEAD_INIT(NULL) 0},
+    .tp_name = "atcoder.BitMatrix",
+    .tp_basicsize = sizeof(BitMatrixObject),
+    .tp_itemsize = 0,
+    .tp_dealloc = (destructor)bitmatrix_dealloc,
+    .tp_repr = (reprfunc)bitmatrix_repr,
+    .tp_as_number = &bitmatrix_as_number,
+    .tp_as_mapping = &bitmatrix_as_mapping,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = bitmatrix_doc,
+    .tp_richcompare = bitmatrix_richcompare,
+    .tp_methods = bitmatrix_methods,
+    .tp_getset = bitmatrix_getsets,
+    .tp_init = (initproc)bitmatrix_init,
+    .tp_new = bitmatrix_new,
+    .tp_free = PyObject_Del,
+};
+
+
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_BITMATRIX
@@ -11,14 +11,19 @@
 #include <vector>
 #include <string>
 #include <bitset>
+#include <cstring>
+#include <initializer_list>
 
 
 #include "atcoder/utils"
+#include "atcoder/internal_bitset"
+#include "atcoder/internal_thread"
 
 namespace atcoder_python {
 
 #define BITSET_W 64
 #define BITSET_W_SHIFT 6
+#define BITSET_W_MASK 63
 #define BITSET_ONE 1ULL
 #define BITSET_ALL 18446744073709551615ULL // -1 
 
@@ -57,52 +62,265 @@ extern PyTypeObject BitSetType;
     } while (0)
 
 
+/* Bit idx lives in word idx >> BITSET_W_SHIFT at position idx & BITSET_W_MASK
+   (the least significant bit first), so bs holds exactly m = ceil(n / 64)
+   words. The r = n % 64 used bits of the last word are the low ones and
+   the bits above them are kept 0. */
 struct BitSetObject {
     PyObject_HEAD
     int n;
     int m;
-    int q;
     int r;
     std::vector<unsigned long long> bs;
-    static inline std::vector<unsigned long long> onehot;
-    static inline std::vector<int> shift;
-    static inline std::vector<unsigned long long> upper;
-    static inline std::vector<unsigned long long> lower;
-    static inline bool initialized;
-    std::vector<int> major;
-    std::vector<int> minor;
+    Py_ssize_t shape;   // m, for the exported buffer
+    int exports;        // number of live buffer views of bs
 };
 
 static BitSetObject *
 bitset_copy(BitSetObject *self) {
     PyTypeObject *type = &BitSetType;
     BitSetObject *z = (BitSetObject *)type->tp_alloc(type, 0);
+    if (z == NULL) return NULL;
     z->n = self->n;
     z->m = self->m;
-    z->q = self->q;
     z->r = self->r;
-    z->bs.reserve(z->m);
-    std::copy(self->bs.begin(), self->bs.end(), std::back_inserter(z->bs));
-    z->major.reserve(z->n);
-    std::copy(self->major.begin(), self->major.end(), std::back_inserter(z->major));
-    z->minor.reserve(z->n);
-    std::copy(self->minor.begin(), self->minor.end(), std::back_inserter(z->minor));
+    z->bs = self->bs;
     return z;
 }
 
 
+/* a BitSet of the same length whose words are all 0 */
+static BitSetObject *
+_bitset_empty_like(BitSetObject *self) {
+    PyTypeObject *type = &BitSetType;
+    BitSetObject *z = (BitSetObject *)type->tp_alloc(type, 0);
+    if (z == NULL) return NULL;
+    z->n = self->n;
+    z->m = self->m;
+    z->r = self->r;
+    z->bs.assign(self->m, 0);
+    return z;
+}
+
+/* a BitSet of length n whose bits are all 0 */
+static BitSetObject *
+_bitset_zeros(int n) {
+    PyTypeObject *type = &BitSetType;
+    BitSetObject *z = (BitSetObject *)type->tp_alloc(type, 0);
+    if (z == NULL) return NULL;
+    z->n = n;
+    z->m = (n + BITSET_W - 1) / BITSET_W;
+    z->r = n % BITSET_W;
+    z->bs.assign(z->m, 0);
+    return z;
+}
+
+
+
+/* clear the unused bits of the last word */
+static inline void
+_bitset_trim(BitSetObject *self) {
+    if (self->r) self->bs[self->m - 1] &= (BITSET_ONE << self->r) - 1;
+}
+
+/* Bulk word operations on long BitSets go through _bitset_parallel: f(l, r)
+   is called on consecutive word ranges covering [0, m), and from
+   BITSET_PARALLEL_THRESHOLD words on the ranges are spread over the
+   worker pool with the GIL released, so one call can use the memory
+   bandwidth of every core. The BitSets involved count as exported
+   meanwhile, so a concurrent __init__ can not reallocate their words. */
+#define BITSET_PARALLEL_THRESHOLD (1 << 20)   // words (8 MiB)
+#define BITSET_PARALLEL_CHUNK (1 << 16)       // words per task
+
+template <class F>
 static void
-_bitset_get_index(BitSetObject *self, int idx, int *i, int *j) {
-    if (self->major[idx] == -1) {
-        self->major[idx] = (self->n - 1 - idx) / BITSET_W;
-        self->minor[idx] = (self->n - 1 - idx) % BITSET_W;
+_bitset_parallel(std::initializer_list<BitSetObject *> pin, int m, F f) {
+    if (m < BITSET_PARALLEL_THRESHOLD) {
+        f(0, m);
+        return;
+    }
+    int tasks = (m + BITSET_PARALLEL_CHUNK - 1) / BITSET_PARALLEL_CHUNK;
+    for (BitSetObject *b : pin) b->exports++;
+    Py_BEGIN_ALLOW_THREADS
+    internal::parallel_for(tasks, internal::hardware_threads(), [&](int t) {
+        int l = t * BITSET_PARALLEL_CHUNK;
+        f(l, std::min(m, l + BITSET_PARALLEL_CHUNK));
+    });
+    Py_END_ALLOW_THREADS
+    for (BitSetObject *b : pin) b->exports--;
+}
+
+/* every word set to x (then trimmed) */
+static void
+_bitset_fill_words(BitSetObject *self, unsigned long long x) {
+    unsigned long long *bs = self->bs.data();
+    _bitset_parallel({self}, self->m, [&](int l, int r) { std::fill(bs + l, bs + r, x); });
+    _bitset_trim(self);
+}
+
+/* self's words replaced by words (of the same size) */
+static void
+_bitset_assign_words(BitSetObject *self, std::vector<unsigned long long> &words) {
+    if (!self->exports) {
+        self->bs.swap(words);
+        return;
+    }
+    unsigned long long *bs = self->bs.data();
+    const unsigned long long *src = words.data();
+    _bitset_parallel({self}, self->m, [&](int l, int r) { std::copy(src + l, src + r, bs + l); });
+}
+
+static long long
+_bitset_popcount(BitSetObject *self) {
+    const unsigned long long *bs = self->bs.data();
+    std::vector<long long> part((self->m + BITSET_PARALLEL_CHUNK - 1) / BITSET_PARALLEL_CHUNK + 1, 0);
+    _bitset_parallel({self}, self->m, [&](int l, int r) {
+        part[l / BITSET_PARALLEL_CHUNK] = internal::bitset_kernels.popcount(bs + l, r - l);
+    });
+    long long res = 0;
+    for (long long c : part) res += c;
+    return res;
+}
+
+/* dst (all m words, not self's) = self shifted by k toward the higher
+   (left) or lower (right) indices, 0 <= k < n */
+static void
+_bitset_shift_to(unsigned long long *dst, BitSetObject *self, int k, int left) {
+    int m = self->m, rot = k >> BITSET_W_SHIFT, sft = k & BITSET_W_MASK;
+    const unsigned long long *src = self->bs.data();
+    _bitset_parallel({self}, m, [&](int l, int r) {
+        if (left) internal::bitset_shl_range(dst, src, m, rot, sft, l, r);
+        else internal::bitset_shr_range(dst, src, m, rot, sft, l, r);
+    });
+    if (left && self->r) dst[m - 1] &= (BITSET_ONE << self->r) - 1;
+}
+
+/* self op= other word by word, op one of the bitset_kernels binops */
+static void
+_bitset_binop(BitSetObject *self, BitSetObject *other, internal::bitset_binop_t op) {
+    unsigned long long *dst = self->bs.data();
+    const unsigned long long *src = other->bs.data();
+    _bitset_parallel({self, other}, self->m, [&](int l, int r) { op(dst + l, src + l, r - l); });
+}
+
+
+static inline int
+_bitset_test(const BitSetObject *self, int idx) {
+    return (int)(self->bs[idx >> BITSET_W_SHIFT] >> (idx & BITSET_W_MASK) & 1);
+}
+
+
+/* the smallest set index >= start, or -1 */
+static long long
+_bitset_find_next(const BitSetObject *self, long long start) {
+    if (start < 0) start = 0;
+    if (start >= self->n) return -1;
+    int w = (int)(start >> BITSET_W_SHIFT);
+    unsigned long long x = self->bs[w] & (BITSET_ALL << (start & BITSET_W_MASK));
+    while (!x) {
+        if (++w == self->m) return -1;
+        x = self->bs[w];
+    }
+    return ((long long)w << BITSET_W_SHIFT) | __builtin_ctzll(x);
+}
+
+/* the largest set index < end, or -1 */
+static long long
+_bitset_find_prev(const BitSetObject *self, long long end) {
+    if (end > self->n) end = self->n;
+    if (end <= 0) return -1;
+    int w = (int)((end - 1) >> BITSET_W_SHIFT);
+    unsigned long long x = self->bs[w] & (BITSET_ALL >> (BITSET_W_MASK - ((end - 1) & BITSET_W_MASK)));
+    while (!x) {
+        if (--w < 0) return -1;
+        x = self->bs[w];
+    }
+    return ((long long)w << BITSET_W_SHIFT) | (BITSET_W_MASK - __builtin_clzll(x));
+}
+
+
+/* apply f(word, mask) to the words covering [l, r), where mask selects the
+   bits of the word inside the range; 0 <= l <= r <= n */
+template <class F>
+static inline void
+_bitset_range_apply(BitSetObject *self, int l, int r, F f) {
+    if (l >= r) return;
+    int wl = l >> BITSET_W_SHIFT, wr = (r - 1) >> BITSET_W_SHIFT;
+    unsigned long long ml = BITSET_ALL << (l & BITSET_W_MASK);
+    unsigned long long mr = BITSET_ALL >> (BITSET_W_MASK - ((r - 1) & BITSET_W_MASK));
+    if (wl == wr) {
+        f(self->bs[wl], ml & mr);
+        return;
+    }
+    f(self->bs[wl], ml);
+    for (int w = wl + 1; w < wr; w++) f(self->bs[w], BITSET_ALL);
+    f(self->bs[wr], mr);
+}
+
+static long long
+_bitset_count_range(BitSetObject *self, int l, int r) {
+    if (l >= r) return 0;
+    int wl = l >> BITSET_W_SHIFT, wr = (r - 1) >> BITSET_W_SHIFT;
+    unsigned long long ml = BITSET_ALL << (l & BITSET_W_MASK);
+    unsigned long long mr = BITSET_ALL >> (BITSET_W_MASK - ((r - 1) & BITSET_W_MASK));
+    if (wl == wr) return __builtin_popcountll(self->bs[wl] & ml & mr);
+    return __builtin_popcountll(self->bs[wl] & ml) + __builtin_popcountll(self->bs[wr] & mr)
+           + internal::bitset_kernels.popcount(self->bs.data() + wl + 1, wr - wl - 1);
+}
+
+static int
+_bitset_any_range(BitSetObject *self, int l, int r) {
+    if (l >= r) return 0;
+    int wl = l >> BITSET_W_SHIFT, wr = (r - 1) >> BITSET_W_SHIFT;
+    unsigned long long ml = BITSET_ALL << (l & BITSET_W_MASK);
+    unsigned long long mr = BITSET_ALL >> (BITSET_W_MASK - ((r - 1) & BITSET_W_MASK));
+    if (wl == wr) return (self->bs[wl] & ml & mr) != 0;
+    if (self->bs[wl] & ml) return 1;
+    for (int w = wl + 1; w < wr; w++) {
+        if (self->bs[w]) return 1;
+    }
+    return (self->bs[wr] & mr) != 0;
+}
+
+/* the bits [l, l + len) of self as a new BitSet of length len */
+static BitSetObject *
+_bitset_slice(BitSetObject *self, int l, int len) {
+    BitSetObject *z = _bitset_zeros(len);
+    if (z == NULL) return NULL;
+    int w0 = l >> BITSET_W_SHIFT, sft = l & BITSET_W_MASK;
+    for (int i = 0; i < z->m; i++) {
+        unsigned long long x = self->bs[w0 + i] >> sft;
+        if (sft && w0 + i + 1 < self->m) x |= self->bs[w0 + i + 1] << (BITSET_W - sft);
+        z->bs[i] = x;
     }
-    *i = self->major[idx];
-    *j = self->minor[idx];
+    _bitset_trim(z);
+    return z;
 }
 
 
+/* reverse the bit order inside every byte of x */
+static inline unsigned long long
+_bitset_reverse_byte_bits(unsigned long long x) {
+    x = (x >> 1 & 0x5555555555555555ULL) | (x & 0x5555555555555555ULL) << 1;
+    x = (x >> 2 & 0x3333333333333333ULL) | (x & 0x3333333333333333ULL) << 2;
+    x = (x >> 4 & 0x0f0f0f0f0f0f0f0fULL) | (x & 0x0f0f0f0f0f0f0f0fULL) << 4;
+    return x;
+}
 
+/* the 8 characters '0'/'1' of a byte, most significant bit first */
+static const std::vector<unsigned long long> &
+_bitset_char_table() {
+    static const std::vector<unsigned long long> table = [] {
+        std::vector<unsigned long long> t(256);
+        for (int b = 0; b < 256; b++) {
+            char c[8];
+            for (int j = 0; j < 8; j++) c[j] = (b >> (7 - j) & 1) ? '1' : '0';
+            std::memcpy(&t[b], c, 8);
+        }
+        return t;
+    }();
+    return table;
+}
 
 static PyObject *
 _bitset_tostring(BitSetObject *self) {
@@ -110,14 +328,17 @@ _bitset_tostring(BitSetObject *self) {
 
     int n = self->n;
     unicode = PyUnicode_New(n, 127);
-    for (int idx = 0; idx < n; ++idx) {
-        int i, j;
-        _bitset_get_index(self, idx, &i, &j);
-        unsigned long long v = (self->bs[i] >> BitSetObject::shift[j]) & 1;
-        Py_UCS4 c = (Py_UCS4)(v == 1ULL ? 49 : 48);
-        if (PyUnicode_WriteChar(unicode, n - 1 - idx, c) == -1){
-            return NULL;
-        }
+    if (unicode == NULL) return NULL;
+    Py_UCS1 *data = PyUnicode_1BYTE_DATA(unicode);
+    const std::vector<unsigned long long> &table = _bitset_char_table();
+    // bits [8k, 8k + 8) are the characters [n - 8k - 8, n - 8k)
+    int k = 0;
+    for (; 8 * k + 8 <= n; k++) {
+        unsigned int b = (unsigned int)(self->bs[k >> 3] >> (8 * (k & 7)) & 255);
+        std::memcpy(data + n - 8 * k - 8, &table[b], 8);
+    }
+    for (int idx = 8 * k; idx < n; ++idx) {
+        data[n - 1 - idx] = (Py_UCS1)(_bitset_test(self, idx) ? 49 : 48);
     }
     return unicode;
 }
@@ -138,26 +359,61 @@ bitset_item(BitSetObject *self, Py_ssize_t idx) {
         PyErr_Format(PyExc_IndexError, "index %d is out of range", idx);
         return NULL;
     }
-    int i, j;
-    _bitset_get_index(self, idx, &i, &j);
-    int x = self->bs[i] >> self->shift[j] & 1;
-    return PyLong_FromLong((long)x);
+    return PyLong_FromLong((long)_bitset_test(self, (int)idx));
 }
 
 static int
 bitset_ass_item(BitSetObject *self, Py_ssize_t idx, PyObject *value) {
+    if (0 > idx || idx >= self->n){
+        PyErr_Format(PyExc_IndexError, "index %d is out of range", idx);
+        return -1;
+    }
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "BitSet doesn't support item deletion");
+        return -1;
+    }
     int v = PyLong_AsLong(value);
     if (v != 0 && v != 1) {
         PyErr_Format(PyExc_ValueError, "assigned value must be 0 or 1 (not %d)", v);
         return -1;
     }
-    int i, j;
-    _bitset_get_index(self, idx, &i, &j);
-    int x = self->bs[i] >> self->shift[j] & 1;
-    if (x != v) self->bs[i] ^= self->onehot[j];
+    unsigned long long bit = BITSET_ONE << (idx & BITSET_W_MASK);
+    if (v) self->bs[idx >> BITSET_W_SHIFT] |= bit;
+    else self->bs[idx >> BITSET_W_SHIFT] &= ~bit;
     return 0;
 }
 
+static PyObject *
+bitset_subscript(BitSetObject *self, PyObject *item) {
+    if (PyIndex_Check(item)) {
+        Py_ssize_t idx = PyNumber_AsSsize_t(item, PyExc_IndexError);
+        if (idx == -1 && PyErr_Occurred()) return NULL;
+        if (idx < 0) idx += self->n;
+        return bitset_item(self, idx);
+    }
+    if (!PySlice_Check(item)) {
+        PyErr_Format(PyExc_TypeError, "BitSet indices must be integers or slices, not %.200s",
+                     Py_TYPE(item)->tp_name);
+        return NULL;
+    }
+    Py_ssize_t start, stop, step;
+    if (PySlice_Unpack(item, &start, &stop, &step) < 0) return NULL;
+    Py_ssize_t len = PySlice_AdjustIndices(self->n, &start, &stop, step);
+    if (step == 1) return (PyObject *)_bitset_slice(self, (int)start, (int)len);
+    BitSetObject *z = _bitset_zeros((int)len);
+    if (z == NULL) return NULL;
+    for (Py_ssize_t j = 0, idx = start; j < len; j++, idx += step) {
+        if (_bitset_test(self, (int)idx)) z->bs[j >> BITSET_W_SHIFT] |= BITSET_ONE << (j & BITSET_W_MASK);
+    }
+    return (PyObject *)z;
+}
+
+static PyMappingMethods bitset_as_mapping = {
+    (lenfunc)bitset_length,                      /*mp_length*/
+    (binaryfunc)bitset_subscript,                /*mp_subscript*/
+    0,                                           /*mp_ass_subscript*/
+};
+
 static PySequenceMethods bitset_as_sequence = {
     (lenfunc)bitset_length,                      /*sq_length*/
     0,                                           /*sq_concat*/
@@ -174,49 +430,45 @@ static PySequenceMethods bitset_as_sequence = {
 
 static void
 _bitset_invert(BitSetObject *self) {
-    for (int i = 0; i < self->m; ++i) {
-        self->bs[i] ^= BITSET_ALL;
-    }
+    unsigned long long *bs = self->bs.data();
+    _bitset_parallel({self}, self->m, [&](int l, int r) {
+        for (int i = l; i < r; ++i) bs[i] ^= BITSET_ALL;
+    });
+    _bitset_trim(self);
 }
 
 
 static PyObject *
 bitset_invert(BitSetObject *a) {
     BitSetObject *x = bitset_copy(a);
+    if (x == NULL) return NULL;
     _bitset_invert(x);
     return (PyObject *)x;
 }
 
 
+/* z = self << other (idx -> idx + other, dropping the bits that reach n);
+   z may be self */
 static void
-_bitset_lshift(BitSetObject *self, int other) {
+_bitset_lshift(BitSetObject *z, BitSetObject *self, int other) {
     if (other >= self->n) {
-        std::fill(self->bs.begin(), self->bs.end(), 0);
+        _bitset_fill_words(z, 0);
         return;
     }
-    int rot, sft;
-    rot = other >> BITSET_W_SHIFT;
-    sft = other - (rot << BITSET_W_SHIFT);
-    int m = self->m;
-    if (rot) {
-        for (int i = 0; i < m-rot; ++i) {
-            self->bs[i] = self->bs[i+rot];
-        }
-        std::fill(self->bs.begin()+(m-rot), self->bs.end(), 0);
-    }
-    m -= rot;
-    if (sft) {
-        for (int i = 0; i < m - 1; ++i) {
-            self->bs[i] <<= sft;
-            self->bs[i] |= (self->bs[i + 1] & BitSetObject::upper[sft]) >> (BITSET_W - sft);
-        }
-        self->bs[m-1] <<= sft;
-        if (self->r) {
-            self->bs[m-1] &= BitSetObject::upper[std::max(self->r-sft, 0)];
-        } else {
-            self->bs[m-1] &= BitSetObject::upper[BITSET_W-sft];
+    if (self->m >= BITSET_PARALLEL_THRESHOLD) {
+        if (z != self) {
+            _bitset_shift_to(z->bs.data(), self, other, 1);
+            return;
         }
+        std::vector<unsigned long long> tmp(self->m);
+        _bitset_shift_to(tmp.data(), self, other, 1);
+        _bitset_assign_words(self, tmp);
+        return;
     }
+    int rot = other >> BITSET_W_SHIFT, sft = other & BITSET_W_MASK;
+    internal::bitset_kernels.shl(z->bs.data(), self->bs.data(), self->m, rot, sft);
+    std::fill(z->bs.begin(), z->bs.begin() + rot, 0);
+    _bitset_trim(z);
 }
 
 static PyObject *
@@ -230,8 +482,9 @@ bitset_lshift(PyObject *a, PyObject *b) {
         PyErr_SetString(PyExc_ValueError, "negative shift count");
         return NULL;
     }
-    z = bitset_copy((BitSetObject *)a);
-    _bitset_lshift(z, shift_num);
+    z = _bitset_empty_like((BitSetObject *)a);
+    if (z == NULL) return NULL;
+    _bitset_lshift(z, (BitSetObject *)a, shift_num);
     return (PyObject *)z;
 }
 
@@ -246,35 +499,33 @@ bitset_inplace_lshift(PyObject *a, PyObject *b) {
         PyErr_SetString(PyExc_ValueError, "negative shift count");
         return NULL;
     }
-    _bitset_lshift((BitSetObject *)a, shift_num);
+    _bitset_lshift((BitSetObject *)a, (BitSetObject *)a, shift_num);
     Py_INCREF(a);
     return (PyObject *)a;
 }
 
 
+/* z = self >> other (idx -> idx - other, dropping the bits that go below 0);
+   z may be self */
 static void
-_bitset_rshift(BitSetObject *self, int other) {
+_bitset_rshift(BitSetObject *z, BitSetObject *self, int other) {
     if (other >= self->n) {
-        std::fill(self->bs.begin(), self->bs.end(), 0);
+        _bitset_fill_words(z, 0);
         return;
     }
-    int rot, sft;
-    rot = other >> BITSET_W_SHIFT;
-    sft = other - (rot << BITSET_W_SHIFT);
-    int m = self->m;
-    if (rot) {
-        for (int i = m - 1; i >= rot; --i) {
-            self->bs[i] = self->bs[i-rot];
-        }
-        std::fill(self->bs.begin(), self->bs.begin()+rot, 0);
-    }
-    if (sft) {
-        for (int i = m - 1; i > rot; --i) {
-            self->bs[i] >>= sft;
-            self->bs[i] |= (self->bs[i - 1] & BitSetObject::lower[sft]) << (BITSET_W - sft);
+    if (self->m >= BITSET_PARALLEL_THRESHOLD) {
+        if (z != self) {
+            _bitset_shift_to(z->bs.data(), self, other, 0);
+            return;
         }
-        self->bs[rot] >>= sft;
+        std::vector<unsigned long long> tmp(self->m);
+        _bitset_shift_to(tmp.data(), self, other, 0);
+        _bitset_assign_words(self, tmp);
+        return;
     }
+    int rot = other >> BITSET_W_SHIFT, sft = other & BITSET_W_MASK;
+    internal::bitset_kernels.shr(z->bs.data(), self->bs.data(), self->m, rot, sft);
+    std::fill(z->bs.end() - rot, z->bs.end(), 0);
 }
 
 static PyObject *
@@ -288,8 +539,9 @@ bitset_rshift(PyObject *a, PyObject *b) {
         PyErr_SetString(PyExc_ValueError, "negative shift count");
         return NULL;
     }
-    z = bitset_copy((BitSetObject *)a);
-    _bitset_rshift(z, shift_num);
+    z = _bitset_empty_like((BitSetObject *)a);
+    if (z == NULL) return NULL;
+    _bitset_rshift(z, (BitSetObject *)a, shift_num);
     return (PyObject *)z;
 }
 
@@ -304,16 +556,14 @@ bitset_inplace_rshift(PyObject *a, PyObject *b) {
         PyErr_SetString(PyExc_ValueError, "negative shift count");
         return NULL;
     }
-    _bitset_rshift((BitSetObject *)a, shift_num);
+    _bitset_rshift((BitSetObject *)a, (BitSetObject *)a, shift_num);
     Py_INCREF(a);
     return (PyObject *)a;
 }
 
 static void
 _bitset_and(BitSetObject *self, BitSetObject *other) {
-    for (int i = 0; i < self->n; ++i) {
-        self->bs[i] &= other->bs[i];
-    }
+    _bitset_binop(self, other, internal::bitset_kernels.and_);
 }
 
 static PyObject *
@@ -323,6 +573,7 @@ bitset_and(BitSetObject *a, BitSetObject *b) {
     CHECK_BINOP_BITSET(a, b);
 
     z = bitset_copy(a);
+    if (z == NULL) return NULL;
     _bitset_and(z, b);
     return (PyObject *)z;
 }
@@ -339,9 +590,7 @@ bitset_inplace_and(BitSetObject *a, BitSetObject *b) {
 
 static void
 _bitset_xor(BitSetObject *self, BitSetObject *other) {
-    for (int i = 0; i < self->n; ++i) {
-        self->bs[i] ^= other->bs[i];
-    }
+    _bitset_binop(self, other, internal::bitset_kernels.xor_);
 }
 
 static PyObject *
@@ -351,6 +600,7 @@ bitset_xor(BitSetObject *a, BitSetObject *b) {
     CHECK_BINOP_BITSET(a, b);
 
     z = bitset_copy(a);
+    if (z == NULL) return NULL;
     _bitset_xor(z, b);
     return (PyObject *)z;
 }
@@ -367,9 +617,7 @@ bitset_inplace_xor(BitSetObject *a, BitSetObject *b) {
 
 static void
 _bitset_or(BitSetObject *self, BitSetObject *other) {
-    for (int i = 0; i < self->n; ++i) {
-        self->bs[i] |= other->bs[i];
-    }
+    _bitset_binop(self, other, internal::bitset_kernels.or_);
 }
 
 static PyObject *
@@ -379,6 +627,7 @@ bitset_or(BitSetObject *a, BitSetObject *b) {
     CHECK_BINOP_BITSET(a, b);
 
     z = bitset_copy(a);
+    if (z == NULL) return NULL;
     _bitset_or(z, b);
     return (PyObject *)z;
 }
@@ -445,10 +694,7 @@ bitset_flip(BitSetObject *self, PyObject *const *args, Py_ssize_t nargs) {
             PyErr_Format(PyExc_IndexError, "index %d is out of range", idx);
             return NULL;
         }
-        int i;
-        int j;
-        _bitset_get_index(self, idx, &i, &j);
-        self->bs[i] ^= BitSetObject::onehot[j];
+        self->bs[idx >> BITSET_W_SHIFT] ^= BITSET_ONE << (idx & BITSET_W_MASK);
         Py_RETURN_NONE;
     } else {
         NARGS_VIOLATION("BitSet.flip", 1);
@@ -463,15 +709,7 @@ PyDoc_STRVAR(bitset_flip_doc,"");
 
 static PyObject *
 bitset_count(BitSetObject *self, PyObject *args) {
-    int cnt = 0;
-    std::vector<unsigned long long> bs = self->bs;
-    for (int i = 0; i < self->q; ++i) {
-        cnt += __builtin_popcountll(bs[i]);
-    }
-    if (self->r) {
-        cnt += __builtin_popcountll(bs[self->q] >> (BITSET_W - self->r));
-    }
-    return PyLong_FromLong((long)cnt);
+    return PyLong_FromLongLong(_bitset_popcount(self));
 }
 
 PyDoc_STRVAR(bitset_count_doc,"");
@@ -482,13 +720,11 @@ PyDoc_STRVAR(bitset_count_doc,"");
 
 static PyObject *
 bitset_all(BitSetObject *self, PyObject *args) {
-    for (int i = 0; i < self->q; ++i) {
+    int q = self->r ? self->m - 1 : self->m;
+    for (int i = 0; i < q; ++i) {
         if (self->bs[i] != BITSET_ALL) Py_RETURN_FALSE;
     }
-    if (self->r) {
-        unsigned long long u = BitSetObject::upper[self->r];
-        if ((self->bs[self->q] & u) != u) Py_RETURN_FALSE;
-    }
+    if (self->r && self->bs[q] != (BITSET_ONE << self->r) - 1) Py_RETURN_FALSE;
     Py_RETURN_TRUE;
 }
 
@@ -500,13 +736,9 @@ PyDoc_STRVAR(bitset_all_doc,"");
 
 static PyObject *
 bitset_any(BitSetObject *self, PyObject *args) {
-    for (int i = 0; i < self->q; ++i) {
+    for (int i = 0; i < self->m; ++i) {
         if (self->bs[i]) Py_RETURN_TRUE;
     }
-    if (self->r) {
-        unsigned long long u = BitSetObject::upper[self->r];
-        if (self->bs[self->q] & u) Py_RETURN_TRUE;
-    }
     Py_RETURN_FALSE;
 }
 
@@ -518,13 +750,9 @@ PyDoc_STRVAR(bitset_any_doc,"");
 
 static PyObject *
 bitset_none(BitSetObject *self, PyObject *args) {
-    for (int i = 0; i < self->q; ++i) {
+    for (int i = 0; i < self->m; ++i) {
         if (self->bs[i]) Py_RETURN_FALSE;
     }
-    if (self->r) {
-        unsigned long long u = BitSetObject::upper[self->r];
-        if (self->bs[self->q] & u) Py_RETURN_FALSE;
-    }
     Py_RETURN_TRUE;
 }
 
@@ -543,10 +771,7 @@ bitset_fill(BitSetObject *self, PyObject *args) {
         PyErr_SetString(PyExc_ValueError, msg);
         return NULL;
     }
-    std::fill(self->bs.begin(), self->bs.end(), value ? BITSET_ALL : 0);
-    if (value && (self->r)) {
-        self->bs[self->q] ^= BitSetObject::lower[BITSET_W - self->r];
-    }
+    _bitset_fill_words(self, value ? BITSET_ALL : 0);
     Py_RETURN_NONE;
 }
 
@@ -556,6 +781,563 @@ PyDoc_STRVAR(bitset_fill_doc,"");
     {"fill", (PyCFunction)(void(*)(void))bitset_fill, METH_O, bitset_fill_doc}
 
 
+/* self op= self shifted by k toward the higher (left) or lower (right)
+   indices, in one pass over the words */
+static void
+_bitset_shift_combine(BitSetObject *self, int k, int left, int is_or) {
+    if (k >= self->n) {
+        if (!is_or) _bitset_fill_words(self, 0);
+        return;
+    }
+    if (self->m >= BITSET_PARALLEL_THRESHOLD) {
+        // the in-place kernels walk the words in order: shift into a copy
+        std::vector<unsigned long long> tmp(self->m);
+        _bitset_shift_to(tmp.data(), self, k, left);
+        unsigned long long *bs = self->bs.data();
+        const unsigned long long *src = tmp.data();
+        internal::bitset_binop_t op = is_or ? internal::bitset_kernels.or_ : internal::bitset_kernels.and_;
+        _bitset_parallel({self}, self->m, [&](int l, int r) { op(bs + l, src + l, r - l); });
+        return;
+    }
+    int rot = k >> BITSET_W_SHIFT, sft = k & BITSET_W_MASK;
+    unsigned long long *bs = self->bs.data();
+    if (left) {
+        (is_or ? internal::bitset_kernels.shl_or : internal::bitset_kernels.shl_and)(bs, bs, self->m, rot, sft);
+        if (!is_or) std::fill(self->bs.begin(), self->bs.begin() + rot, 0);
+        _bitset_trim(self);
+    } else {
+        (is_or ? internal::bitset_kernels.shr_or : internal::bitset_kernels.shr_and)(bs, bs, self->m, rot, sft);
+        if (!is_or) std::fill(self->bs.end() - rot, self->bs.end(), 0);
+    }
+}
+
+/* "left" -> 1, "right" -> 0, otherwise -1 with an exception set */
+static int
+_bitset_parse_direction(const char *direction) {
+    if (direction == NULL || strcmp(direction, "left") == 0) return 1;
+    if (strcmp(direction, "right") == 0) return 0;
+    PyErr_Format(PyExc_ValueError, "direction must be 'left' or 'right', not '%s'", direction);
+    return -1;
+}
+
+static PyObject *
+_bitset_shift_combine_method(BitSetObject *self, PyObject *args, PyObject *kwargs, int is_or) {
+    static char *kwlist[] = {(char *)"k", (char *)"direction", NULL};
+    int k;
+    const char *direction = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i|s", kwlist, &k, &direction)) return NULL;
+    int left = _bitset_parse_direction(direction);
+    if (left < 0) return NULL;
+    if (k < 0) {
+        PyErr_SetString(PyExc_ValueError, "negative shift count");
+        return NULL;
+    }
+    _bitset_shift_combine(self, k, left, is_or);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+bitset_shift_or(BitSetObject *self, PyObject *args, PyObject *kwargs) {
+    return _bitset_shift_combine_method(self, args, kwargs, 1);
+}
+
+PyDoc_STRVAR(bitset_shift_or_doc,
+"shift_or(k, direction='left')\n"
+"--\n\n"
+"Set self |= self << k (direction='left') or self |= self >> k\n"
+"(direction='right') in place, without a temporary BitSet.\n\n"
+"Parameters\n"
+"----------\n"
+"k : int\n"
+"    shift count\n"
+"direction : str\n"
+"    'left' (toward the higher indices) or 'right'\n"
+"\n"
+"Returns\n"
+"-------\n"
+"Nothing\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= k\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w), one pass over the words"
+);
+
+#define ACL_PYTHON_BITSET_SHIFT_OR_METHODDEF \
+    {"shift_or", (PyCFunction)(void(*)(void))bitset_shift_or, METH_VARARGS | METH_KEYWORDS, bitset_shift_or_doc}
+
+
+static PyObject *
+bitset_shift_and(BitSetObject *self, PyObject *args, PyObject *kwargs) {
+    return _bitset_shift_combine_method(self, args, kwargs, 0);
+}
+
+PyDoc_STRVAR(bitset_shift_and_doc,
+"shift_and(k, direction='left')\n"
+"--\n\n"
+"Set self &= self << k (direction='left') or self &= self >> k\n"
+"(direction='right') in place, without a temporary BitSet.\n\n"
+"Parameters\n"
+"----------\n"
+"k : int\n"
+"    shift count\n"
+"direction : str\n"
+"    'left' (toward the higher indices) or 'right'\n"
+"\n"
+"Returns\n"
+"-------\n"
+"Nothing\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= k\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w), one pass over the words"
+);
+
+#define ACL_PYTHON_BITSET_SHIFT_AND_METHODDEF \
+    {"shift_and", (PyCFunction)(void(*)(void))bitset_shift_and, METH_VARARGS | METH_KEYWORDS, bitset_shift_and_doc}
+
+
+static PyObject *
+bitset_shift_or_many(BitSetObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"ks", (char *)"direction", NULL};
+    PyObject *ks_obj;
+    const char *direction = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|s", kwlist, &ks_obj, &direction)) return NULL;
+    int left = _bitset_parse_direction(direction);
+    if (left < 0) return NULL;
+    PyObject *seq = PySequence_Fast(ks_obj, "ks must be iterable");
+    if (seq == NULL) return NULL;
+    Py_ssize_t len = PySequence_Fast_GET_SIZE(seq);
+    std::vector<int> ks(len);
+    for (Py_ssize_t i = 0; i < len; i++) {
+        long k = PyLong_AsLong(PySequence_Fast_GET_ITEM(seq, i));
+        if (k == -1 && PyErr_Occurred()) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+        if (k < 0) {
+            Py_DECREF(seq);
+            PyErr_SetString(PyExc_ValueError, "negative shift count");
+            return NULL;
+        }
+        ks[i] = (int)std::min<long>(k, INT_MAX);
+    }
+    Py_DECREF(seq);
+    for (int k : ks) _bitset_shift_combine(self, k, left, 1);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(bitset_shift_or_many_doc,
+"shift_or_many(ks, direction='left')\n"
+"--\n\n"
+"Apply shift_or(k, direction) for every k of ks in order; with\n"
+"self = 1 this is the subset-sum DP over the items ks.\n\n"
+"Parameters\n"
+"----------\n"
+"ks : Sequence[int]\n"
+"    shift counts\n"
+"direction : str\n"
+"    'left' (toward the higher indices) or 'right'\n"
+"\n"
+"Returns\n"
+"-------\n"
+"Nothing\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= ks[i]\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(len(ks) n / w)"
+);
+
+#define ACL_PYTHON_BITSET_SHIFT_OR_MANY_METHODDEF \
+    {"shift_or_many", (PyCFunction)(void(*)(void))bitset_shift_or_many, METH_VARARGS | METH_KEYWORDS, bitset_shift_or_many_doc}
+
+
+static PyObject *
+bitset_find_first(BitSetObject *self, PyObject *args) {
+    return PyLong_FromLongLong(_bitset_find_next(self, 0));
+}
+
+PyDoc_STRVAR(bitset_find_first_doc,
+"find_first()\n"
+"--\n\n"
+"Smallest set index.\n\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    the smallest set index, or -1 if there is none\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_FIND_FIRST_METHODDEF \
+    {"find_first", (PyCFunction)bitset_find_first, METH_NOARGS, bitset_find_first_doc}
+
+
+static PyObject *
+bitset_find_next(BitSetObject *self, PyObject *arg) {
+    long long i = PyLong_AsLongLong(arg);
+    CHECK_CONVERT(i);
+    if (i >= self->n) return PyLong_FromLong(-1);
+    return PyLong_FromLongLong(_bitset_find_next(self, i + 1));
+}
+
+PyDoc_STRVAR(bitset_find_next_doc,
+"find_next(i)\n"
+"--\n\n"
+"Smallest set index greater than i.\n\n"
+"Parameters\n"
+"----------\n"
+"i : int\n"
+"    position\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    the smallest set index greater than i, or -1 if there is none\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_FIND_NEXT_METHODDEF \
+    {"find_next", (PyCFunction)bitset_find_next, METH_O, bitset_find_next_doc}
+
+
+static PyObject *
+bitset_find_prev(BitSetObject *self, PyObject *arg) {
+    long long i = PyLong_AsLongLong(arg);
+    CHECK_CONVERT(i);
+    return PyLong_FromLongLong(_bitset_find_prev(self, i));
+}
+
+PyDoc_STRVAR(bitset_find_prev_doc,
+"find_prev(i)\n"
+"--\n\n"
+"Largest set index less than i.\n\n"
+"Parameters\n"
+"----------\n"
+"i : int\n"
+"    position\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    the largest set index less than i, or -1 if there is none\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_FIND_PREV_METHODDEF \
+    {"find_prev", (PyCFunction)bitset_find_prev, METH_O, bitset_find_prev_doc}
+
+
+static PyObject *
+bitset_to_indices(BitSetObject *self, PyObject *args) {
+    std::vector<int> res;
+    res.reserve(internal::bitset_kernels.popcount(self->bs.data(), self->m));
+    for (int w = 0; w < self->m; w++) {
+        unsigned long long x = self->bs[w];
+        while (x) {
+            res.push_back((w << BITSET_W_SHIFT) | __builtin_ctzll(x));
+            x &= x - 1;
+        }
+    }
+    return _PyArray_FromVector(res, "i");
+}
+
+PyDoc_STRVAR(bitset_to_indices_doc,
+"to_indices()\n"
+"--\n\n"
+"Set indices in increasing order.\n\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'i'\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w + k), where k is the number of set bits"
+);
+
+#define ACL_PYTHON_BITSET_TO_INDICES_METHODDEF \
+    {"to_indices", (PyCFunction)bitset_to_indices, METH_NOARGS, bitset_to_indices_doc}
+
+
+/* parse (l, r) with 0 <= l <= r <= n */
+static int
+_bitset_parse_range(BitSetObject *self, PyObject *const *args, Py_ssize_t nargs,
+                    const char *name, int *l, int *r) {
+    if (nargs != 2) {
+        PyErr_Format(PyExc_TypeError, "%s() takes 2 argument(s)", name);
+        return -1;
+    }
+    long long l_ = PyLong_AsLongLong(args[0]);
+    if (l_ == -1 && PyErr_Occurred()) return -1;
+    long long r_ = PyLong_AsLongLong(args[1]);
+    if (r_ == -1 && PyErr_Occurred()) return -1;
+    if (!(0 <= l_ && l_ <= r_ && r_ <= self->n)) {
+        PyErr_Format(PyExc_IndexError, "range [%lld, %lld) is out of [0, %d]", l_, r_, self->n);
+        return -1;
+    }
+    *l = (int)l_;
+    *r = (int)r_;
+    return 0;
+}
+
+
+static PyObject *
+bitset_set_range(BitSetObject *self, PyObject *const *args, Py_ssize_t nargs) {
+    int l, r;
+    if (_bitset_parse_range(self, args, nargs, "BitSet.set_range", &l, &r)) return NULL;
+    _bitset_range_apply(self, l, r, [](unsigned long long &x, unsigned long long mask) { x |= mask; });
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(bitset_set_range_doc,
+"set_range(l, r)\n"
+"--\n\n"
+"Set the bits in [l, r) to 1.\n\n"
+"Parameters\n"
+"----------\n"
+"l : int\n"
+"    left end (inclusive)\n"
+"r : int\n"
+"    right end (exclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"Nothing\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= l <= r <= n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_SET_RANGE_METHODDEF \
+    {"set_range", (PyCFunction)(void(*)(void))bitset_set_range, METH_FASTCALL, bitset_set_range_doc}
+
+
+
+static PyObject *
+bitset_reset_range(BitSetObject *self, PyObject *const *args, Py_ssize_t nargs) {
+    int l, r;
+    if (_bitset_parse_range(self, args, nargs, "BitSet.reset_range", &l, &r)) return NULL;
+    _bitset_range_apply(self, l, r, [](unsigned long long &x, unsigned long long mask) { x &= ~mask; });
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(bitset_reset_range_doc,
+"reset_range(l, r)\n"
+"--\n\n"
+"Set the bits in [l, r) to 0.\n\n"
+"Parameters\n"
+"----------\n"
+"l : int\n"
+"    left end (inclusive)\n"
+"r : int\n"
+"    right end (exclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"Nothing\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= l <= r <= n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_RESET_RANGE_METHODDEF \
+    {"reset_range", (PyCFunction)(void(*)(void))bitset_reset_range, METH_FASTCALL, bitset_reset_range_doc}
+
+
+
+static PyObject *
+bitset_flip_range(BitSetObject *self, PyObject *const *args, Py_ssize_t nargs) {
+    int l, r;
+    if (_bitset_parse_range(self, args, nargs, "BitSet.flip_range", &l, &r)) return NULL;
+    _bitset_range_apply(self, l, r, [](unsigned long long &x, unsigned long long mask) { x ^= mask; });
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(bitset_flip_range_doc,
+"flip_range(l, r)\n"
+"--\n\n"
+"Flip the bits in [l, r).\n\n"
+"Parameters\n"
+"----------\n"
+"l : int\n"
+"    left end (inclusive)\n"
+"r : int\n"
+"    right end (exclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"Nothing\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= l <= r <= n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_FLIP_RANGE_METHODDEF \
+    {"flip_range", (PyCFunction)(void(*)(void))bitset_flip_range, METH_FASTCALL, bitset_flip_range_doc}
+
+
+
+static PyObject *
+bitset_count_range(BitSetObject *self, PyObject *const *args, Py_ssize_t nargs) {
+    int l, r;
+    if (_bitset_parse_range(self, args, nargs, "BitSet.count_range", &l, &r)) return NULL;
+    return PyLong_FromLongLong(_bitset_count_range(self, l, r));
+}
+
+PyDoc_STRVAR(bitset_count_range_doc,
+"count_range(l, r)\n"
+"--\n\n"
+"Count the set bits in [l, r).\n\n"
+"Parameters\n"
+"----------\n"
+"l : int\n"
+"    left end (inclusive)\n"
+"r : int\n"
+"    right end (exclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    the number of set bits in [l, r)\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= l <= r <= n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_COUNT_RANGE_METHODDEF \
+    {"count_range", (PyCFunction)(void(*)(void))bitset_count_range, METH_FASTCALL, bitset_count_range_doc}
+
+
+
+static PyObject *
+bitset_any_range(BitSetObject *self, PyObject *const *args, Py_ssize_t nargs) {
+    int l, r;
+    if (_bitset_parse_range(self, args, nargs, "BitSet.any_range", &l, &r)) return NULL;
+    return PyBool_FromLong(_bitset_any_range(self, l, r));
+}
+
+PyDoc_STRVAR(bitset_any_range_doc,
+"any_range(l, r)\n"
+"--\n\n"
+"Test whether some bit in [l, r) is set.\n\n"
+"Parameters\n"
+"----------\n"
+"l : int\n"
+"    left end (inclusive)\n"
+"r : int\n"
+"    right end (exclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : bool\n"
+"    True if a bit in [l, r) is 1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= l <= r <= n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_ANY_RANGE_METHODDEF \
+    {"any_range", (PyCFunction)(void(*)(void))bitset_any_range, METH_FASTCALL, bitset_any_range_doc}
+
+
+
+static PyObject *
+bitset_none_range(BitSetObject *self, PyObject *const *args, Py_ssize_t nargs) {
+    int l, r;
+    if (_bitset_parse_range(self, args, nargs, "BitSet.none_range", &l, &r)) return NULL;
+    return PyBool_FromLong(!_bitset_any_range(self, l, r));
+}
+
+PyDoc_STRVAR(bitset_none_range_doc,
+"none_range(l, r)\n"
+"--\n\n"
+"Test whether every bit in [l, r) is 0.\n\n"
+"Parameters\n"
+"----------\n"
+"l : int\n"
+"    left end (inclusive)\n"
+"r : int\n"
+"    right end (exclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : bool\n"
+"    True if no bit in [l, r) is 1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= l <= r <= n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_NONE_RANGE_METHODDEF \
+    {"none_range", (PyCFunction)(void(*)(void))bitset_none_range, METH_FASTCALL, bitset_none_range_doc}
+
+
 static PyObject *
 bitset_tostring(BitSetObject *self, PyObject *args) {
     return _bitset_tostring(self);
@@ -569,16 +1351,226 @@ PyDoc_STRVAR(bitset_tostring_doc,"");
 
 static PyObject *
 bitset_toint(BitSetObject *self, PyObject *args) {
-    PyObject *unicode = _bitset_tostring(self);
-    return PyLong_FromUnicodeObject(unicode, 2);
+    return _PyLong_FromLimbs(self->bs);
 }
 
-PyDoc_STRVAR(bitset_toint_doc,"");
+PyDoc_STRVAR(bitset_toint_doc,
+"toint()\n"
+"--\n\n"
+"The BitSet as an int.\n\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    sum of 2^i over the set indices i\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
 
 #define ACL_PYTHON_BITSET_TOINT_METHODDEF \
     {"toint", (PyCFunction)bitset_toint, METH_NOARGS, bitset_toint_doc}
 
 
+/* "little" -> 1, "big" -> 0, otherwise -1 with an exception set */
+static int
+_bitset_parse_bitorder(const char *bitorder) {
+    if (bitorder == NULL || strcmp(bitorder, "little") == 0) return 1;
+    if (strcmp(bitorder, "big") == 0) return 0;
+    PyErr_Format(PyExc_ValueError, "bitorder must be 'little' or 'big', not '%s'", bitorder);
+    return -1;
+}
+
+static PyObject *
+bitset_to_bytes(BitSetObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"bitorder", NULL};
+    const char *bitorder = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|s", kwlist, &bitorder)) return NULL;
+    int little = _bitset_parse_bitorder(bitorder);
+    if (little < 0) return NULL;
+    Py_ssize_t len = ((Py_ssize_t)self->n + 7) / 8;
+    PyObject *res = PyBytes_FromStringAndSize(NULL, len);
+    if (res == NULL) return NULL;
+    unsigned char *p = (unsigned char *)PyBytes_AS_STRING(res);
+    for (int i = 0; i < self->m; i++) {
+        unsigned long long x = little ? self->bs[i] : _bitset_reverse_byte_bits(self->bs[i]);
+        for (int j = 0; j < 8 && 8 * (Py_ssize_t)i + j < len; j++) p[8 * i + j] = (unsigned char)(x >> (8 * j));
+    }
+    return res;
+}
+
+PyDoc_STRVAR(bitset_to_bytes_doc,
+"to_bytes(bitorder='little')\n"
+"--\n\n"
+"Pack the bits into ceil(n / 8) bytes: bit i goes to byte i // 8, at\n"
+"position i % 8 from the least significant end (bitorder='little') or\n"
+"from the most significant end (bitorder='big', as numpy.packbits).\n\n"
+"Parameters\n"
+"----------\n"
+"bitorder : str\n"
+"    'little' or 'big'\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : bytes\n"
+"    packed bits\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_TO_BYTES_METHODDEF \
+    {"to_bytes", (PyCFunction)(void(*)(void))bitset_to_bytes, METH_VARARGS | METH_KEYWORDS, bitset_to_bytes_doc}
+
+
+static PyObject *
+bitset_from_bytes(PyObject *type, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"data", (char *)"n", (char *)"bitorder", NULL};
+    Py_buffer view;
+    PyObject *n_obj = Py_None;
+    const char *bitorder = NULL;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|Os", kwlist, &view, &n_obj, &bitorder)) return NULL;
+    int little = _bitset_parse_bitorder(bitorder);
+    long long n = 8LL * view.len;
+    if (little >= 0 && n_obj != Py_None) {
+        n = PyLong_AsLongLong(n_obj);
+        if (n == -1 && PyErr_Occurred()) little = -1;
+        else if (n < 0 || n > 8LL * view.len) {
+            PyErr_Format(PyExc_ValueError, "n must be in [0, %lld]", 8LL * view.len);
+            little = -1;
+        }
+    }
+    if (little >= 0 && n > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "BitSet is too long");
+        little = -1;
+    }
+    if (little < 0) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+    BitSetObject *z = _bitset_zeros((int)n);
+    if (z == NULL) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+    const unsigned char *p = (const unsigned char *)view.buf;
+    Py_ssize_t len = (n + 7) / 8;
+    for (int i = 0; i < z->m; i++) {
+        unsigned long long x = 0;
+        for (int j = 0; j < 8 && 8 * (Py_ssize_t)i + j < len; j++) x |= (unsigned long long)p[8 * i + j] << (8 * j);
+        z->bs[i] = little ? x : _bitset_reverse_byte_bits(x);
+    }
+    _bitset_trim(z);
+    PyBuffer_Release(&view);
+    return (PyObject *)z;
+}
+
+PyDoc_STRVAR(bitset_from_bytes_doc,
+"from_bytes(data, n=None, bitorder='little')\n"
+"--\n\n"
+"The inverse of to_bytes.\n\n"
+"Parameters\n"
+"----------\n"
+"data : bytes-like\n"
+"    packed bits\n"
+"n : int\n"
+"    length of the BitSet (8 * len(data) by default); the bits from n on\n"
+"    are ignored\n"
+"bitorder : str\n"
+"    'little' or 'big'\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : BitSet\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n <= 8 len(data)\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_FROM_BYTES_METHODDEF \
+    {"from_bytes", (PyCFunction)(void(*)(void))bitset_from_bytes, METH_VARARGS | METH_KEYWORDS | METH_STATIC, bitset_from_bytes_doc}
+
+
+static PyObject *
+bitset_from_int(PyObject *type, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"x", (char *)"n", NULL};
+    PyObject *x, *n_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|O", kwlist, &PyLong_Type, &x, &n_obj)) return NULL;
+    if (_PyLong_Sign(x) < 0) {
+        PyErr_SetString(PyExc_ValueError, "x must be non-negative");
+        return NULL;
+    }
+    size_t bits = _PyLong_NumBits(x);
+    if (bits == (size_t)-1 && PyErr_Occurred()) return NULL;
+    long long n = (long long)bits;
+    if (n_obj != Py_None) {
+        n = PyLong_AsLongLong(n_obj);
+        if (n == -1 && PyErr_Occurred()) return NULL;
+        if (n < 0) {
+            PyErr_SetString(PyExc_ValueError, "BitSet size must be non-negative");
+            return NULL;
+        }
+        if ((long long)bits > n) {
+            PyErr_Format(PyExc_ValueError, "x does not fit in %lld bits", n);
+            return NULL;
+        }
+    }
+    if (n > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "BitSet is too long");
+        return NULL;
+    }
+    BitSetObject *z = _bitset_zeros((int)n);
+    if (z == NULL) return NULL;
+    // x has at most n bits, so it fits in the m words
+    if (_PyLong_AsLimbs(x, z->bs.data(), z->m) < 0) {
+        Py_DECREF(z);
+        return NULL;
+    }
+    return (PyObject *)z;
+}
+
+PyDoc_STRVAR(bitset_from_int_doc,
+"from_int(x, n=None)\n"
+"--\n\n"
+"The inverse of toint: bit i of the result is bit i of x.\n\n"
+"Parameters\n"
+"----------\n"
+"x : int\n"
+"    non-negative integer\n"
+"n : int\n"
+"    length of the BitSet (x.bit_length() by default)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : BitSet\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= x < 2^n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_BITSET_FROM_INT_METHODDEF \
+    {"from_int", (PyCFunction)(void(*)(void))bitset_from_int, METH_VARARGS | METH_KEYWORDS | METH_STATIC, bitset_from_int_doc}
+
+
 
 
 static PyMethodDef bitset_methods[] = {
@@ -590,22 +1582,29 @@ static PyMethodDef bitset_methods[] = {
     ACL_PYTHON_BITSET_FILL_METHODDEF,
     ACL_PYTHON_BITSET_TOSTRING_METHODDEF,
     ACL_PYTHON_BITSET_TOINT_METHODDEF,
+    ACL_PYTHON_BITSET_TO_BYTES_METHODDEF,
+    ACL_PYTHON_BITSET_FROM_BYTES_METHODDEF,
+    ACL_PYTHON_BITSET_FROM_INT_METHODDEF,
+    ACL_PYTHON_BITSET_SHIFT_OR_METHODDEF,
+    ACL_PYTHON_BITSET_SHIFT_AND_METHODDEF,
+    ACL_PYTHON_BITSET_SHIFT_OR_MANY_METHODDEF,
+    ACL_PYTHON_BITSET_FIND_FIRST_METHODDEF,
+    ACL_PYTHON_BITSET_FIND_NEXT_METHODDEF,
+    ACL_PYTHON_BITSET_FIND_PREV_METHODDEF,
+    ACL_PYTHON_BITSET_TO_INDICES_METHODDEF,
+    ACL_PYTHON_BITSET_SET_RANGE_METHODDEF,
+    ACL_PYTHON_BITSET_RESET_RANGE_METHODDEF,
+    ACL_PYTHON_BITSET_FLIP_RANGE_METHODDEF,
+    ACL_PYTHON_BITSET_COUNT_RANGE_METHODDEF,
+    ACL_PYTHON_BITSET_ANY_RANGE_METHODDEF,
+    ACL_PYTHON_BITSET_NONE_RANGE_METHODDEF,
     {NULL} /*sentinel*/
 };
 
 static int
 bitset_compare(BitSetObject *a, BitSetObject *b) {
     if (a->n != b->n) return 1;
-    for (int i = 0; i < a->q; ++i) {
-        if (a->bs[i] != b->bs[i]) return 1;
-    }
-    if (a->r) {
-        unsigned long long x, y;
-        x = a->bs[a->q] & BitSetObject::upper[a->r];
-        y = b->bs[a->q] & BitSetObject::upper[a->r];
-        if (x != y) return 1;
-    }
-    return 0;
+    return a->bs != b->bs;
 }
 
 static PyObject *
@@ -624,65 +1623,62 @@ static int
 bitset_init(BitSetObject *self, PyObject *args, PyObject *kwargs) { 
     int n = 0;
     PyObject *o;
+    // parsed into a local buffer so that a failure leaves self untouched
+    std::vector<unsigned long long> bs;
 
 
     if (!PyArg_ParseTuple(args, "O", &o)) return -1;
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "cannot re-initialize a BitSet with exported buffers");
+        return -1;
+    }
     if (PyLong_Check(o)) {
         n = (int)PyLong_AsLong(o);
-        self->bs = std::vector<unsigned long long>(n);
+        if (n < 0) {
+            if (!PyErr_Occurred()) PyErr_SetString(PyExc_ValueError, "BitSet size must be non-negative");
+            return -1;
+        }
+        bs.assign((n + BITSET_W - 1) / BITSET_W, 0ULL);
 
     } else if (PyUnicode_Check(o)) {
         if (PyUnicode_READY(o) == -1) return -1;
         Py_ssize_t m = PyUnicode_GET_LENGTH(o);
         n = (int)m;
-        self->bs = std::vector<unsigned long long>(n);
+        bs.assign((n + BITSET_W - 1) / BITSET_W, 0ULL);
         int kind = PyUnicode_KIND(o);
         void *data = PyUnicode_DATA(o);
-        unsigned long long v = 0;
-        int i = 0, j = 0;
-        for (Py_ssize_t idx = 0; idx < m; ++idx) {
-            v <<= 1;
-            Py_UCS4 c = PyUnicode_READ(kind, data, idx);
-            if (c == 49) {
-                v |= 1;
+        // the last character is bit 0
+        int idx = 0;
+        if (kind == PyUnicode_1BYTE_KIND) {
+            /* 8 characters at a time: the characters [n - idx - 8, n - idx)
+               loaded as a word have the digit of bit idx + 7 - j in the low
+               bit of byte j, and the multiplication gathers those 8 bits
+               into the top byte */
+            const unsigned char *p = (const unsigned char *)data;
+            for (; idx + 8 <= n; idx += 8) {
+                unsigned long long v;
+                std::memcpy(&v, p + n - idx - 8, 8);
+                if ((v & 0xfefefefefefefefeULL) != 0x3030303030303030ULL) break;
+                unsigned long long b = (v & 0x0101010101010101ULL) * 0x8040201008040201ULL >> 56;
+                bs[idx >> BITSET_W_SHIFT] |= b << (idx & BITSET_W_MASK);
             }
-            ++j;
-            if (j == BITSET_W) {
-                self->bs[i] = v;
-                v = 0;
-                ++i;
-                j = 0;
-            } else if (idx == m - 1) {
-                self->bs[i] = v << (BITSET_W - j);
+        }
+        for (; idx < n; ++idx) {
+            Py_UCS4 c = PyUnicode_READ(kind, data, n - 1 - idx);
+            if (c != 48 && c != 49) {
+                PyErr_SetString(PyExc_ValueError, "BitSet() str must consist of '0' and '1'");
+                return -1;
             }
+            if (c == 49) bs[idx >> BITSET_W_SHIFT] |= BITSET_ONE << (idx & BITSET_W_MASK);
         }
     } else {
+        PyErr_SetString(PyExc_TypeError, "BitSet() takes int or str");
         return -1;
     }
+    self->bs.swap(bs);
     self->n = n;
     self->m = (n + BITSET_W - 1) / BITSET_W;
     self->r = n % BITSET_W;
-    self->q = self->r ? self->m - 1 : self->m;
-    if (!BitSetObject::initialized) {
-        self->onehot = std::vector<unsigned long long>(BITSET_W);
-        self->shift = std::vector<int>(BITSET_W);
-        self->upper = std::vector<unsigned long long>(BITSET_W + 1);
-        self->lower = std::vector<unsigned long long>(BITSET_W + 1);
-        for(int i = 0; i < BITSET_W; ++i){
-            self->onehot[i] = BITSET_ONE << (BITSET_W - i - 1);
-            self->shift[i] = BITSET_W - i - 1;
-            self->lower[i + 1] = self->lower[i] << 1 | 1;
-        }
-        for(int i = 1; i <= BITSET_W; ++i){
-            self->upper[i] = self->lower[BITSET_W - i] ^ BITSET_ALL;
-        }
-        BitSetObject::initialized = true;
-    }
-    self->major = std::vector<int>(n, -1);
-    self->minor = std::vector<int>(n, -1);
-    
-
-
     return 0;
 }
 
@@ -693,13 +1689,134 @@ bitset_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
     return (PyObject *)self;
 }
 
+static void
+bitset_dealloc(BitSetObject *self) {
+    std::vector<unsigned long long>().swap(self->bs);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+
+/* buffer protocol: the m words, read-only ***********************/
+
+static int
+bitset_getbuffer(BitSetObject *self, Py_buffer *view, int flags) {
+    static unsigned long long empty = 0;
+    static Py_ssize_t stride = sizeof(unsigned long long);
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "BitSet buffer is read-only");
+        view->obj = NULL;
+        return -1;
+    }
+    self->shape = self->m;
+    view->obj = (PyObject *)self;
+    Py_INCREF(self);
+    view->buf = self->m ? (void *)self->bs.data() : (void *)&empty;
+    view->len = (Py_ssize_t)self->m * sizeof(unsigned long long);
+    view->readonly = 1;
+    view->itemsize = sizeof(unsigned long long);
+    view->format = (flags & PyBUF_FORMAT) ? (char *)"Q" : NULL;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &self->shape : NULL;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? &stride : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    self->exports++;
+    return 0;
+}
+
+static void
+bitset_releasebuffer(BitSetObject *self, Py_buffer *view) {
+    self->exports--;
+}
+
+static PyBufferProcs bitset_as_buffer = {
+    (getbufferproc)bitset_getbuffer,
+    (releasebufferproc)bitset_releasebuffer,
+};
+
+
+/* iterator over the set indices ***********************************/
+
+extern PyTypeObject BitSetIterType;
+
+/* the word under the cursor is copied, so a bit changed in it after the
+   iterator reached it is not seen */
+struct BitSetIterObject {
+    PyObject_HEAD
+    BitSetObject *bitset;
+    int w;
+    unsigned long long x;
+};
+
+static PyObject *
+bitset_iter(BitSetObject *self) {
+    BitSetIterObject *it = PyObject_New(BitSetIterObject, &BitSetIterType);
+    if (it == NULL) return NULL;
+    Py_INCREF(self);
+    it->bitset = self;
+    it->w = 0;
+    it->x = self->m ? self->bs[0] : 0;
+    return (PyObject *)it;
+}
+
+static PyObject *
+bitset_iter_next(BitSetIterObject *it) {
+    BitSetObject *bs = it->bitset;
+    while (!it->x) {
+        if (++it->w >= bs->m) {
+            it->w = bs->m;
+            return NULL;
+        }
+        it->x = bs->bs[it->w];
+    }
+    int idx = (it->w << BITSET_W_SHIFT) | __builtin_ctzll(it->x);
+    it->x &= it->x - 1;
+    return PyLong_FromLong(idx);
+}
+
+static void
+bitset_iter_dealloc(BitSetIterObject *it) {
+    Py_DECREF(it->bitset);
+    PyObject_Del(it);
+}
+
+PyTypeObject BitSetIterType = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "atcoder.BitSetIterator",                   /* tp_name */
+    sizeof(BitSetIterObject),                   /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)bitset_iter_dealloc,            /* tp_dealloc */
+    0,                                          /* tp_vectorcall_offset */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_as_async */
+    0,                                          /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    PyObject_GenericGetAttr,                    /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+    0,                                          /* tp_doc */
+    0,                                          /* tp_traverse */
+    0,                                          /* tp_clear */
+    0,                                          /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    PyObject_SelfIter,                          /* tp_iter */
+    (iternextfunc)bitset_iter_next,             /* tp_iternext */
+};
+
 
 PyTypeObject BitSetType = {
     PyVarObject_HEAD_INIT(&PyType_Type, 0)
     "atcoder.BitSet",                           /* tp_name */
     sizeof(BitSetObject),                       /* tp_basicsize */
     0,                                          /* tp_itemsize */
-    0,                                          /* tp_dealloc */
+    (destructor)bitset_dealloc,                 /* tp_dealloc */
     0,                                          /* tp_vectorcall_offset */
     0,                                          /* tp_getattr */
     0,                                          /* tp_setattr */
@@ -707,20 +1824,20 @@ PyTypeObject BitSetType = {
     bitset_repr,                                /* tp_repr */
     &bitset_as_number,                          /* tp_as_number */
     &bitset_as_sequence,                        /* tp_as_sequence */
-    0,                                          /* tp_as_mapping */
+    &bitset_as_mapping,                         /* tp_as_mapping */
     0,                                          /* tp_hash */
     0,                                          /* tp_call */
     0,                                          /* tp_str */
     PyObject_GenericGetAttr,                    /* tp_getattro */
     PyObject_GenericSetAttr,                    /* tp_setattro */
-    0,                                          /* tp_as_buffer */
+    &bitset_as_buffer,                          /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT,                         /* tp_flags */
     0,                                 /* tp_doc */
     0,                                          /* tp_traverse */
     0,                                          /* tp_clear */
     bitset_richcompare,                         /* tp_richcompare */
     0,                                          /* tp_weaklistoffset */
-    0,                                          /* tp_iter */
+    (getiterfunc)bitset_iter,                   /* tp_iter */
     0,                                          /* tp_iternext */
     bitset_methods,                             /* tp_methods */
     0,                                          /* tp_members */
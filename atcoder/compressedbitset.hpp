@@ -0,0 +1,635 @@
+#ifndef ACL_PYTHON_COMPRESSEDBITSET
+#define ACL_PYTHON_COMPRESSEDBITSET
+
+
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <structmember.h>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+#include "atcoder/utils"
+#include "atcoder/bitset"
+#include "atcoder/internal_roaring"
+
+namespace atcoder_python {
+
+/* compressed bitset object *****************************************/
+
+/* Set of integers in [0, 2^32) stored as a roaring bitmap: one container
+   per 2^16 values, kept as a sorted array, a bitmap or a list of runs.
+
+    >>> a = CompressedBitSet([1, 5, 1 << 20, 3_000_000_000])
+    >>> b = CompressedBitSet(range(1 << 20, 1 << 21))    # a single run
+    >>> list(a & b)
+    [1048576]
+    >>> len(a | b), (a | b).rank(1 << 20)
+    (1048579, 2)
+    >>> (a - b).select(2)
+    3000000000
+    >>> CompressedBitSet([1, 5]).to_bitset().tostring()   # bit 0 is the last character
+    '100010'
+
+*/
+
+
+extern PyTypeObject CompressedBitSetType;
+extern PyTypeObject CompressedBitSetIterType;
+
+#define CompressedBitSet_Check(v) PyObject_TypeCheck(v, &CompressedBitSetType)
+
+#define COMPRESSEDBITSET_LIMIT (1LL << 32)
+
+
+struct CompressedBitSetObject {
+    PyObject_HEAD
+    internal::roaring set;
+};
+
+
+static CompressedBitSetObject *
+compressedbitset_alloc(void) {
+    PyTypeObject *type = &CompressedBitSetType;
+    CompressedBitSetObject *self = (CompressedBitSetObject *)type->tp_alloc(type, 0);
+    if (self == NULL) return NULL;
+    new (&self->set) internal::roaring();
+    return self;
+}
+
+/* value argument checked against [0, 2^32) */
+static long long
+_compressedbitset_value(PyObject *o) {
+    long long x = PyLong_AsLongLong(o);
+    if (x == -1 && PyErr_Occurred()) return -1;
+    if (x < 0 || x >= COMPRESSEDBITSET_LIMIT) {
+        PyErr_Format(PyExc_ValueError, "[constraints] 0 <= x < 2^32 (x = %lld)", x);
+        return -1;
+    }
+    return x;
+}
+
+
+static Py_ssize_t
+compressedbitset_length(CompressedBitSetObject *self) {
+    return (Py_ssize_t)self->set.size();
+}
+
+static int
+compressedbitset_contains(CompressedBitSetObject *self, PyObject *arg) {
+    long long x = PyLong_AsLongLong(arg);
+    if (x == -1 && PyErr_Occurred()) return -1;
+    return x >= 0 && x < COMPRESSEDBITSET_LIMIT && self->set.contains((unsigned)x);
+}
+
+static PySequenceMethods compressedbitset_as_sequence = {
+    .sq_length = (lenfunc)compressedbitset_length,
+    .sq_contains = (objobjproc)compressedbitset_contains,
+};
+
+
+static PyObject *
+compressedbitset_add(CompressedBitSetObject *self, PyObject *arg) {
+    long long x = _compressedbitset_value(arg);
+    if (x < 0) return NULL;
+    self->set.add((unsigned)x);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(compressedbitset_add_doc,
+"add(x)\n"
+"--\n\n"
+"Insert x.\n\n"
+"Parameters\n"
+"----------\n"
+"x : int\n"
+"\n"
+"Returns\n"
+"-------\n"
+"Nothing\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= x < 2^32\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(4096) (into an array or a run chunk), \u039F(1) (into a bitmap chunk)"
+);
+
+#define ACL_PYTHON_COMPRESSEDBITSET_ADD_METHODDEF \
+    {"add", (PyCFunction)compressedbitset_add, METH_O, compressedbitset_add_doc},
+
+
+static PyObject *
+compressedbitset_discard(CompressedBitSetObject *self, PyObject *arg) {
+    long long x = _compressedbitset_value(arg);
+    if (x < 0) return NULL;
+    self->set.remove((unsigned)x);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(compressedbitset_discard_doc,
+"discard(x)\n"
+"--\n\n"
+"Delete x if it is present.\n\n"
+"Parameters\n"
+"----------\n"
+"x : int\n"
+"\n"
+"Returns\n"
+"-------\n"
+"Nothing\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= x < 2^32\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(4096)"
+);
+
+#define ACL_PYTHON_COMPRESSEDBITSET_DISCARD_METHODDEF \
+    {"discard", (PyCFunction)compressedbitset_discard, METH_O, compressedbitset_discard_doc},
+
+
+static PyObject *
+compressedbitset_rank(CompressedBitSetObject *self, PyObject *arg) {
+    long long x = PyLong_AsLongLong(arg);
+    CHECK_CONVERT(x);
+    if (x < 0 || x > COMPRESSEDBITSET_LIMIT) {
+        PyErr_Format(PyExc_IndexError, "index %lld is out of range", x);
+        return NULL;
+    }
+    return PyLong_FromLongLong(self->set.rank(x));
+}
+
+PyDoc_STRVAR(compressedbitset_rank_doc,
+"rank(x)\n"
+"--\n\n"
+"Number of elements less than x.\n\n"
+"Parameters\n"
+"----------\n"
+"x : int\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= x <= 2^32\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(log(k) + 1024), k: number of chunks (\u039F(k) after a change)"
+);
+
+#define ACL_PYTHON_COMPRESSEDBITSET_RANK_METHODDEF \
+    {"rank", (PyCFunction)compressedbitset_rank, METH_O, compressedbitset_rank_doc},
+
+
+static PyObject *
+compressedbitset_select(CompressedBitSetObject *self, PyObject *arg) {
+    long long k = PyLong_AsLongLong(arg);
+    CHECK_CONVERT(k);
+    if (k < 0 || k >= self->set.size()) {
+        PyErr_Format(PyExc_IndexError, "rank %lld is out of range", k);
+        return NULL;
+    }
+    return PyLong_FromLongLong(self->set.select(k));
+}
+
+PyDoc_STRVAR(compressedbitset_select_doc,
+"select(k)\n"
+"--\n\n"
+"The k-th smallest element (0-indexed).\n\n"
+"Parameters\n"
+"----------\n"
+"k : int\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= k < len(self)\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(log(k) + 1024), k: number of chunks (\u039F(k) after a change)"
+);
+
+#define ACL_PYTHON_COMPRESSEDBITSET_SELECT_METHODDEF \
+    {"select", (PyCFunction)compressedbitset_select, METH_O, compressedbitset_select_doc},
+
+
+static PyObject *
+compressedbitset_to_array(CompressedBitSetObject *self, PyObject *args) {
+    std::vector<unsigned int> res;
+    res.reserve(self->set.size());
+    self->set.for_each([&](unsigned x) { res.push_back(x); });
+    return _PyArray_FromVector(res, "I");
+}
+
+PyDoc_STRVAR(compressedbitset_to_array_doc,
+"to_array()\n"
+"--\n\n"
+"The elements in increasing order.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'I'\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(len(self))"
+);
+
+#define ACL_PYTHON_COMPRESSEDBITSET_TO_ARRAY_METHODDEF \
+    {"to_array", (PyCFunction)compressedbitset_to_array, METH_NOARGS, compressedbitset_to_array_doc},
+
+
+static PyObject *
+compressedbitset_to_bitset(CompressedBitSetObject *self, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"n", NULL};
+    PyObject *n_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwlist, &n_obj)) return NULL;
+    long long size = self->set.size();
+    long long need = size ? self->set.select(size - 1) + 1 : 0;
+    long long n = need;
+    if (n_obj != Py_None) {
+        n = PyLong_AsLongLong(n_obj);
+        CHECK_CONVERT(n);
+        if (n < need) {
+            PyErr_Format(PyExc_ValueError, "n must be at least max + 1 = %lld", need);
+            return NULL;
+        }
+    }
+    if (n > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "BitSet is too long");
+        return NULL;
+    }
+    BitSetObject *z = _bitset_zeros((int)n);
+    if (z == NULL) return NULL;
+    self->set.to_words(z->bs.data(), z->m);
+    return (PyObject *)z;
+}
+
+PyDoc_STRVAR(compressedbitset_to_bitset_doc,
+"to_bitset(n=None)\n"
+"--\n\n"
+"Conversion to a dense BitSet of length n.\n\n"
+"Parameters\n"
+"----------\n"
+"n : int | None\n"
+"    length (None: the largest element + 1)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : BitSet\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"max(self) < n < 2^31\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n / w)"
+);
+
+#define ACL_PYTHON_COMPRESSEDBITSET_TO_BITSET_METHODDEF \
+    {"to_bitset", (PyCFunction)compressedbitset_to_bitset, METH_VARARGS | METH_KEYWORDS, compressedbitset_to_bitset_doc},
+
+
+static PyObject *
+compressedbitset_optimize(CompressedBitSetObject *self, PyObject *args) {
+    self->set.optimize();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(compressedbitset_optimize_doc,
+"optimize()\n"
+"--\n\n"
+"Convert every chunk to the smallest of the array, bitmap and run forms.\n"
+"The results of the constructors and of the operators already are;\n"
+"add() and discard() only switch between arrays and bitmaps.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"Nothing\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(1024 k), k: number of chunks"
+);
+
+#define ACL_PYTHON_COMPRESSEDBITSET_OPTIMIZE_METHODDEF \
+    {"optimize", (PyCFunction)compressedbitset_optimize, METH_NOARGS, compressedbitset_optimize_doc},
+
+
+static PyObject *
+compressedbitset_size_in_bytes(CompressedBitSetObject *self, PyObject *args) {
+    return PyLong_FromSize_t(sizeof(CompressedBitSetObject) + self->set.bytes());
+}
+
+PyDoc_STRVAR(compressedbitset_size_in_bytes_doc,
+"size_in_bytes()\n"
+"--\n\n"
+"Memory used by the containers.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(k), k: number of chunks"
+);
+
+#define ACL_PYTHON_COMPRESSEDBITSET_SIZE_IN_BYTES_METHODDEF \
+    {"size_in_bytes", (PyCFunction)compressedbitset_size_in_bytes, METH_NOARGS, compressedbitset_size_in_bytes_doc},
+
+
+static PyMethodDef compressedbitset_methods[] = {
+    ACL_PYTHON_COMPRESSEDBITSET_ADD_METHODDEF
+    ACL_PYTHON_COMPRESSEDBITSET_DISCARD_METHODDEF
+    ACL_PYTHON_COMPRESSEDBITSET_RANK_METHODDEF
+    ACL_PYTHON_COMPRESSEDBITSET_SELECT_METHODDEF
+    ACL_PYTHON_COMPRESSEDBITSET_TO_ARRAY_METHODDEF
+    ACL_PYTHON_COMPRESSEDBITSET_TO_BITSET_METHODDEF
+    ACL_PYTHON_COMPRESSEDBITSET_OPTIMIZE_METHODDEF
+    ACL_PYTHON_COMPRESSEDBITSET_SIZE_IN_BYTES_METHODDEF
+    {NULL} /* Sentinel */
+};
+
+
+/* number protocol: &, |, ^, - ***************************/
+
+static PyObject *
+_compressedbitset_binop(PyObject *a, PyObject *b, internal::roaring_op op) {
+    if (!CompressedBitSet_Check(a) || !CompressedBitSet_Check(b)) Py_RETURN_NOTIMPLEMENTED;
+    CompressedBitSetObject *z = compressedbitset_alloc();
+    if (z == NULL) return NULL;
+    z->set = internal::roaring_combine(((CompressedBitSetObject *)a)->set, ((CompressedBitSetObject *)b)->set, op);
+    return (PyObject *)z;
+}
+
+static PyObject *
+compressedbitset_and(PyObject *a, PyObject *b) {
+    return _compressedbitset_binop(a, b, internal::ROARING_AND);
+}
+
+static PyObject *
+compressedbitset_or(PyObject *a, PyObject *b) {
+    return _compressedbitset_binop(a, b, internal::ROARING_OR);
+}
+
+static PyObject *
+compressedbitset_xor(PyObject *a, PyObject *b) {
+    return _compressedbitset_binop(a, b, internal::ROARING_XOR);
+}
+
+static PyObject *
+compressedbitset_sub(PyObject *a, PyObject *b) {
+    return _compressedbitset_binop(a, b, internal::ROARING_ANDNOT);
+}
+
+static PyNumberMethods compressedbitset_as_number = {
+    .nb_subtract = (binaryfunc)compressedbitset_sub,
+    .nb_and = (binaryfunc)compressedbitset_and,
+    .nb_xor = (binaryfunc)compressedbitset_xor,
+    .nb_or = (binaryfunc)compressedbitset_or,
+};
+
+
+static PyObject *
+compressedbitset_richcompare(PyObject *self, PyObject *other, int op) {
+    if (!CompressedBitSet_Check(self) || !CompressedBitSet_Check(other)) Py_RETURN_NOTIMPLEMENTED;
+    if (op != Py_EQ && op != Py_NE) Py_RETURN_NOTIMPLEMENTED;
+    bool eq = ((CompressedBitSetObject *)self)->set == ((CompressedBitSetObject *)other)->set;
+    if (eq == (op == Py_EQ)) Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+
+static PyObject *
+compressedbitset_repr(CompressedBitSetObject *self) {
+    PyObject *list = PyList_New(0);
+    if (list == NULL) return NULL;
+    int err = 0;
+    self->set.for_each([&](unsigned x) {
+        if (err) return;
+        PyObject *v = PyLong_FromUnsignedLong(x);
+        if (v == NULL || PyList_Append(list, v)) err = 1;
+        Py_XDECREF(v);
+    });
+    if (err) {
+        Py_DECREF(list);
+        return NULL;
+    }
+    PyObject *name = PyUnicode_FromString("CompressedBitSet");
+    PyObject *res = sequential_object_repr((PyListObject *)list, name);
+    Py_DECREF(name);
+    Py_DECREF(list);
+    return res;
+}
+
+
+/* iterator over the elements ***********************************/
+
+/* the next element is searched from the last one returned, so changes of
+   the set during the iteration are seen after the cursor */
+struct CompressedBitSetIterObject {
+    PyObject_HEAD
+    CompressedBitSetObject *set;
+    long long pos;
+};
+
+static PyObject *
+compressedbitset_iter(CompressedBitSetObject *self) {
+    CompressedBitSetIterObject *it = PyObject_New(CompressedBitSetIterObject, &CompressedBitSetIterType);
+    if (it == NULL) return NULL;
+    Py_INCREF(self);
+    it->set = self;
+    it->pos = 0;
+    return (PyObject *)it;
+}
+
+static PyObject *
+compressedbitset_iter_next(CompressedBitSetIterObject *it) {
+    long long x = it->set->set.next(it->pos);
+    if (x < 0) {
+        it->pos = COMPRESSEDBITSET_LIMIT;
+        return NULL;
+    }
+    it->pos = x + 1;
+    return PyLong_FromLongLong(x);
+}
+
+static void
+compressedbitset_iter_dealloc(CompressedBitSetIterObject *it) {
+    Py_DECREF(it->set);
+    PyObject_Del(it);
+}
+
+PyTypeObject CompressedBitSetIterType = {
+    .ob_base = {PyObject_HEAD_INIT(NULL) 0},
+    .tp_name = "atcoder.CompressedBitSetIterator",
+    .tp_basicsize = sizeof(CompressedBitSetIterObject),
+    .tp_itemsize = 0,
+    .tp_dealloc = (destructor)compressedbitset_iter_dealloc,
+    .tp_getattro = PyObject_GenericGetAttr,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_iter = PyObject_SelfIter,
+    .tp_iternext = (iternextfunc)compressedbitset_iter_next,
+};
+
+
+PyDoc_STRVAR(compressedbitset_doc,
+"Set of integers in [0, 2^32) split in chunks of 2^16 values; a chunk is\n"
+"a sorted array, a bitmap or a list of runs, whichever is the smallest.\n\n"
+"The following operations are supported:\n"
+"    '&', '|', '^', '-' (between CompressedBitSet)\n"
+"    len(s), x in s, iter(s) (increasing order)\n"
+"    '==', '!='\n\n"
+"CompressedBitSet(values=None)\n"
+"    Parameters\n"
+"    ----------\n"
+"    values : Iterable[int] | BitSet | None\n"
+"        initial elements, or the set bits of a BitSet\n"
+"    \n"
+"    Returns\n"
+"    -------\n"
+"    s : CompressedBitSet\n"
+"    \n"
+"    Constraints\n"
+"    -----------\n"
+"    0 <= values[i] < 2^32\n"
+"    \n"
+"    Complexity\n"
+"    ----------\n"
+"    \u039F(len(values) log(len(values))), \u039F(n / w) from a BitSet\n\n"
+"Operations ('&', '|', '^', '-')\n"
+"    Chunks of the same range are merged when both are arrays, and\n"
+"    combined word by word as bitmaps otherwise.\n"
+"    \n"
+"    Complexity\n"
+"    ----------\n"
+"    \u039F(min(len, 1024)) per pair of chunks"
+);
+
+
+static int
+compressedbitset_init(CompressedBitSetObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {(char*)"values", NULL};
+    PyObject *o = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &o)) return -1;
+    if (o == Py_None) {
+        self->set = internal::roaring();
+        return 0;
+    }
+    if (BitSet_Check(o)) {
+        BitSetObject *bs = (BitSetObject *)o;
+        self->set.assign_words(bs->bs.data(), bs->m);
+        return 0;
+    }
+    std::vector<long long> values;
+    if (PyList_Check(o) || PyObject_CheckBuffer(o)) {
+        int err = 0;
+        values = _PyObject_AsVector<long long>(o, &err);
+        if (err) return -1;
+    } else {
+        PyObject *it = PyObject_GetIter(o);
+        if (it == NULL) return -1;
+        PyObject *v;
+        while ((v = PyIter_Next(it)) != NULL) {
+            long long x = PyLong_AsLongLong(v);
+            Py_DECREF(v);
+            if (x == -1 && PyErr_Occurred()) break;
+            values.push_back(x);
+        }
+        Py_DECREF(it);
+        if (PyErr_Occurred()) return -1;
+    }
+    std::vector<unsigned int> a(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        if (values[i] < 0 || values[i] >= COMPRESSEDBITSET_LIMIT) {
+            PyErr_Format(PyExc_ValueError, "[constraints] 0 <= x < 2^32 (x = %lld)", values[i]);
+            return -1;
+        }
+        a[i] = (unsigned int)values[i];
+    }
+    if (!std::is_sorted(a.begin(), a.end())) std::sort(a.begin(), a.end());
+    a.erase(std::unique(a.begin(), a.end()), a.end());
+    self->set.assign_sorted(a);
+    return 0;
+}
+
+
+static PyObject *
+compressedbitset_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+    CompressedBitSetObject *self;
+    self = (CompressedBitSetObject *)type->tp_alloc(type, 0);
+    if (self == NULL) return NULL;
+    new (&self->set) internal::roaring();
+    return (PyObject *)self;
+}
+
+static void
+compressedbitset_dealloc(CompressedBitSetObject *self) {
+    self->set.~roaring();
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+PyTypeObject CompressedBitSetType = {
+    .ob_base = {PyObject_HEAD_INIT(NULL) 0},
+    .tp_name = "atcoder.CompressedBitSet",
+    .tp_basicsize = sizeof(CompressedBitSetObject),
+    .tp_itemsize = 0,
+    .tp_dealloc = (destructor)compressedbitset_dealloc,
+    .tp_repr = (reprfunc)compressedbitset_repr,
+    .tp_as_number = &compressedbitset_as_number,
+    .tp_as_sequence = &compressedbitset_as_sequence,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = compressedbitset_doc,
+    .tp_richcompare = compressedbitset_richcompare,
+    .tp_iter = (getiterfunc)compressedbitset_iter,
+    .tp_methods = compressedbitset_methods,
+    .tp_init = (initproc)compressedbitset_init,
+    .tp_new = compressedbitset_new,
+    .tp_free = PyObject_Del,
+};
+
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_COMPRESSEDBITSET
@@ -0,0 +1,952 @@
+#ifndef ACL_PYTHON_CONVOLUTION
+#define ACL_PYTHON_CONVOLUTION
+
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "atcoder/utils"
+#include "atcoder/internal_bit"
+#include "atcoder/internal_cpu"
+#include "atcoder/internal_math"
+#include "atcoder/internal_thread"
+
+
+// reference: https://github.com/atcoder/ac-library/blob/master/atcoder/convolution.hpp
+
+
+
+namespace atcoder_python {
+namespace internal {
+
+
+/* number theoretic transform ******************************/
+
+/* The transforms work on arrays of unsigned int in [0, mod).
+
+    Data stays in normal form and only the twiddle factors are stored in
+    Montgomery form (w * R mod p, R = 2^32), so that
+        mont_mul(x, w * R) = x * w  (mod p).
+    The forward transform is decimation-in-frequency (natural order in,
+    bit-reversed order out) and the inverse one is decimation-in-time
+    (bit-reversed order in, natural order out), hence no bit reversal
+    pass is needed between them.
+
+    The layers are provided by a kernel (scalar / AVX2 / AVX-512) which is
+    selected by ntt_select_kernel() at import time.
+*/
+
+
+/* precomputed values for a modulus ************************/
+
+struct ntt_info {
+    unsigned int mod;
+    unsigned int ninv;              // -mod^{-1} mod 2^32
+    unsigned int r2;                // R^2 mod mod
+    int rank2;                      // max k s.t. 2^k | mod - 1
+    int g;                          // primitive root
+    // w[h + j] = (zeta_{2h})^j * R  for h = 1, 2, 4, ... and 0 <= j < h
+    std::vector<unsigned int> w;
+    std::vector<unsigned int> iw;
+};
+
+
+static inline unsigned int
+ntt_mont_mul(unsigned int a, unsigned int b, unsigned int mod, unsigned int ninv) {
+    // a, b < mod < 2^31  ->  t + m * mod < 2^64
+    unsigned long long t = (unsigned long long)a * b;
+    unsigned int m = (unsigned int)t * ninv;
+    unsigned int u = (unsigned int)((t + (unsigned long long)m * mod) >> 32);
+    return u >= mod ? u - mod : u;
+}
+
+static std::shared_ptr<ntt_info>
+ntt_make_info(unsigned int mod, int n) {
+    auto f = std::make_shared<ntt_info>();
+    f->mod = mod;
+    unsigned int inv = mod;
+    for (int i = 0; i < 5; i++) inv *= 2 - mod * inv;
+    f->ninv = -inv;
+    unsigned long long r1 = (1ULL << 32) % mod;
+    f->r2 = (unsigned int)(r1 * r1 % mod);
+    f->rank2 = bsf(mod - 1);
+    f->g = primitive_root_constexpr((int)mod);
+
+    f->w.assign(std::max(n, 2), 0);
+    f->iw.assign(std::max(n, 2), 0);
+    for (int h = 1; h < n; h <<= 1) {
+        unsigned long long z = pow_mod_constexpr(f->g, (mod - 1) / (2 * h), mod);
+        unsigned long long iz = pow_mod_constexpr(z, mod - 2, mod);
+        unsigned long long cur = 1, icur = 1;
+        for (int j = 0; j < h; j++) {
+            f->w[h + j] = ntt_mont_mul((unsigned int)cur, f->r2, mod, f->ninv);
+            f->iw[h + j] = ntt_mont_mul((unsigned int)icur, f->r2, mod, f->ninv);
+            cur = cur * z % mod;
+            icur = icur * iz % mod;
+        }
+    }
+    return f;
+}
+
+/* The tables are cached per modulus and grown on demand. The returned
+   pointer keeps its tables alive even if the cache is replaced later.
+   The callers may run without the GIL, so the cache has its own lock. */
+static std::shared_ptr<ntt_info>
+ntt_get_info(unsigned int mod, int n) {
+    static std::mutex mtx;
+    static std::vector<std::shared_ptr<ntt_info>> cache;
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto &f : cache) {
+        if (f->mod != mod) continue;
+        if ((int)f->w.size() < n) f = ntt_make_info(mod, n);
+        return f;
+    }
+    if (cache.size() >= 8) cache.erase(cache.begin());
+    cache.push_back(ntt_make_info(mod, n));
+    return cache.back();
+}
+
+
+/* kernels *************************************************/
+
+struct ntt_kernel {
+    const char *name;
+    // (x[j], y[j]) <- DIF butterfly with twiddle w[j]  (0 <= j < len)
+    void (*dif_strip)(unsigned int *x, unsigned int *y, const unsigned int *w, int len,
+                      unsigned int mod, unsigned int ninv);
+    // (x[j], y[j]) <- DIT butterfly with twiddle w[j]  (0 <= j < len)
+    void (*dit_strip)(unsigned int *x, unsigned int *y, const unsigned int *w, int len,
+                      unsigned int mod, unsigned int ninv);
+    // one DIF layer of half width h over a[0, n)
+    void (*dif_layer)(unsigned int *a, int n, int h, const unsigned int *w,
+                      unsigned int mod, unsigned int ninv);
+    // one DIT layer of half width h over a[0, n)
+    void (*dit_layer)(unsigned int *a, int n, int h, const unsigned int *w,
+                      unsigned int mod, unsigned int ninv);
+    // a[i] = a[i] * b[i] * R^{-1}
+    void (*mul)(unsigned int *a, const unsigned int *b, int n,
+                unsigned int mod, unsigned int ninv);
+    // a[i] = a[i] * c * R^{-1}
+    void (*mul_const)(unsigned int *a, int n, unsigned int c,
+                      unsigned int mod, unsigned int ninv);
+};
+
+
+static void
+ntt_dif_strip_scalar(unsigned int *x, unsigned int *y, const unsigned int *w, int len,
+                     unsigned int mod, unsigned int ninv) {
+    for (int j = 0; j < len; j++) {
+        unsigned int u = x[j], v = y[j];
+        unsigned int p = u + v;
+        if (p >= mod) p -= mod;
+        unsigned int q = u + mod - v;
+        if (q >= mod) q -= mod;
+        x[j] = p;
+        y[j] = ntt_mont_mul(q, w[j], mod, ninv);
+    }
+}
+
+static void
+ntt_dit_strip_scalar(unsigned int *x, unsigned int *y, const unsigned int *w, int len,
+                     unsigned int mod, unsigned int ninv) {
+    for (int j = 0; j < len; j++) {
+        unsigned int u = x[j];
+        unsigned int v = ntt_mont_mul(y[j], w[j], mod, ninv);
+        unsigned int p = u + v;
+        if (p >= mod) p -= mod;
+        unsigned int q = u + mod - v;
+        if (q >= mod) q -= mod;
+        x[j] = p;
+        y[j] = q;
+    }
+}
+
+static void
+ntt_dif_layer_scalar(unsigned int *a, int n, int h, const unsigned int *w,
+                     unsigned int mod, unsigned int ninv) {
+    for (int s = 0; s < n; s += 2 * h) {
+        ntt_dif_strip_scalar(a + s, a + s + h, w + h, h, mod, ninv);
+    }
+}
+
+static void
+ntt_dit_layer_scalar(unsigned int *a, int n, int h, const unsigned int *w,
+                     unsigned int mod, unsigned int ninv) {
+    for (int s = 0; s < n; s += 2 * h) {
+        ntt_dit_strip_scalar(a + s, a + s + h, w + h, h, mod, ninv);
+    }
+}
+
+static void
+ntt_mul_scalar(unsigned int *a, const unsigned int *b, int n,
+               unsigned int mod, unsigned int ninv) {
+    for (int i = 0; i < n; i++) a[i] = ntt_mont_mul(a[i], b[i], mod, ninv);
+}
+
+static void
+ntt_mul_const_scalar(unsigned int *a, int n, unsigned int c,
+                     unsigned int mod, unsigned int ninv) {
+    for (int i = 0; i < n; i++) a[i] = ntt_mont_mul(a[i], c, mod, ninv);
+}
+
+static const ntt_kernel ntt_kernel_scalar = {
+    "scalar",
+    ntt_dif_strip_scalar,
+    ntt_dit_strip_scalar,
+    ntt_dif_layer_scalar,
+    ntt_dit_layer_scalar,
+    ntt_mul_scalar,
+    ntt_mul_const_scalar,
+};
+
+
+#ifdef ACL_PYTHON_X86_SIMD
+
+/* The vector kernels keep every lane in [0, mod) with the unsigned min
+   trick  min(x, x - mod), which requires 3 * mod < 2^32.
+   ntt_kernel_for() restricts them to mod < 2^30. */
+
+ACL_PYTHON_TARGET_AVX2 static inline __m256i
+ntt_mont_mul_avx2(__m256i a, __m256i b, __m256i mod, __m256i ninv) {
+    __m256i t0 = _mm256_mul_epu32(a, b);
+    __m256i t1 = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    __m256i m0 = _mm256_mul_epu32(t0, ninv);
+    __m256i m1 = _mm256_mul_epu32(t1, ninv);
+    t0 = _mm256_add_epi64(t0, _mm256_mul_epu32(m0, mod));
+    t1 = _mm256_add_epi64(t1, _mm256_mul_epu32(m1, mod));
+    __m256i r = _mm256_blend_epi32(_mm256_srli_epi64(t0, 32), t1, 0xAA);
+    return _mm256_min_epu32(r, _mm256_sub_epi32(r, mod));
+}
+
+ACL_PYTHON_TARGET_AVX2 static inline void
+ntt_dif_bfly_avx2(__m256i &u, __m256i &v, __m256i w, __m256i vm, __m256i vn) {
+    __m256i p = _mm256_add_epi32(u, v);
+    p = _mm256_min_epu32(p, _mm256_sub_epi32(p, vm));
+    __m256i q = _mm256_sub_epi32(_mm256_add_epi32(u, vm), v);
+    q = _mm256_min_epu32(q, _mm256_sub_epi32(q, vm));
+    u = p;
+    v = ntt_mont_mul_avx2(q, w, vm, vn);
+}
+
+ACL_PYTHON_TARGET_AVX2 static inline void
+ntt_dit_bfly_avx2(__m256i &u, __m256i &v, __m256i w, __m256i vm, __m256i vn) {
+    v = ntt_mont_mul_avx2(v, w, vm, vn);
+    __m256i p = _mm256_add_epi32(u, v);
+    p = _mm256_min_epu32(p, _mm256_sub_epi32(p, vm));
+    __m256i q = _mm256_sub_epi32(_mm256_add_epi32(u, vm), v);
+    q = _mm256_min_epu32(q, _mm256_sub_epi32(q, vm));
+    u = p;
+    v = q;
+}
+
+/* For h < 8 two consecutive vectors x, y hold 16 / (2h) butterflies.
+   This shuffle moves all the upper halves into x and the lower halves
+   into y (and back again: it is its own inverse). */
+ACL_PYTHON_TARGET_AVX2 static inline void
+ntt_shuffle_avx2(__m256i &x, __m256i &y, int h) {
+    __m256i s, t;
+    if (h == 4) {
+        s = _mm256_permute2x128_si256(x, y, 0x20);
+        t = _mm256_permute2x128_si256(x, y, 0x31);
+    } else if (h == 2) {
+        s = _mm256_unpacklo_epi64(x, y);
+        t = _mm256_unpackhi_epi64(x, y);
+    } else {
+        s = _mm256_blend_epi32(x, _mm256_slli_epi64(y, 32), 0xAA);
+        t = _mm256_blend_epi32(_mm256_srli_epi64(x, 32), y, 0xAA);
+    }
+    x = s;
+    y = t;
+}
+
+/* twiddle factors of a layer with h < 8, in the order of ntt_shuffle_avx2 */
+ACL_PYTHON_TARGET_AVX2 static inline __m256i
+ntt_small_twiddle_avx2(const unsigned int *w, int h) {
+    if (h == 4) return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(w + 4)));
+    if (h == 2) return _mm256_set_epi32(w[3], w[2], w[3], w[2], w[3], w[2], w[3], w[2]);
+    return _mm256_set1_epi32((int)w[1]);
+}
+
+ACL_PYTHON_TARGET_AVX2 static void
+ntt_dif_strip_avx2(unsigned int *x, unsigned int *y, const unsigned int *w, int len,
+                   unsigned int mod, unsigned int ninv) {
+    const __m256i vm = _mm256_set1_epi32((int)mod);
+    const __m256i vn = _mm256_set1_epi32((int)ninv);
+    int j = 0;
+    for (; j + 8 <= len; j += 8) {
+        __m256i u = _mm256_loadu_si256((const __m256i *)(x + j));
+        __m256i v = _mm256_loadu_si256((const __m256i *)(y + j));
+        __m256i z = _mm256_loadu_si256((const __m256i *)(w + j));
+        ntt_dif_bfly_avx2(u, v, z, vm, vn);
+        _mm256_storeu_si256((__m256i *)(x + j), u);
+        _mm256_storeu_si256((__m256i *)(y + j), v);
+    }
+    ntt_dif_strip_scalar(x + j, y + j, w + j, len - j, mod, ninv);
+}
+
+ACL_PYTHON_TARGET_AVX2 static void
+ntt_dit_strip_avx2(unsigned int *x, unsigned int *y, const unsigned int *w, int len,
+                   unsigned int mod, unsigned int ninv) {
+    const __m256i vm = _mm256_set1_epi32((int)mod);
+    const __m256i vn = _mm256_set1_epi32((int)ninv);
+    int j = 0;
+    for (; j + 8 <= len; j += 8) {
+        __m256i u = _mm256_loadu_si256((const __m256i *)(x + j));
+        __m256i v = _mm256_loadu_si256((const __m256i *)(y + j));
+        __m256i z = _mm256_loadu_si256((const __m256i *)(w + j));
+        ntt_dit_bfly_avx2(u, v, z, vm, vn);
+        _mm256_storeu_si256((__m256i *)(x + j), u);
+        _mm256_storeu_si256((__m256i *)(y + j), v);
+    }
+    ntt_dit_strip_scalar(x + j, y + j, w + j, len - j, mod, ninv);
+}
+
+ACL_PYTHON_TARGET_AVX2 static void
+ntt_dif_layer_avx2(unsigned int *a, int n, int h, const unsigned int *w,
+                   unsigned int mod, unsigned int ninv) {
+    if (n < 16) {
+        ntt_dif_layer_scalar(a, n, h, w, mod, ninv);
+        return;
+    }
+    if (h >= 8) {
+        for (int s = 0; s < n; s += 2 * h) {
+            ntt_dif_strip_avx2(a + s, a + s + h, w + h, h, mod, ninv);
+        }
+        return;
+    }
+    const __m256i vm = _mm256_set1_epi32((int)mod);
+    const __m256i vn = _mm256_set1_epi32((int)ninv);
+    const __m256i z = ntt_small_twiddle_avx2(w, h);
+    for (int s = 0; s < n; s += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + s));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(a + s + 8));
+        ntt_shuffle_avx2(x, y, h);
+        ntt_dif_bfly_avx2(x, y, z, vm, vn);
+        ntt_shuffle_avx2(x, y, h);
+        _mm256_storeu_si256((__m256i *)(a + s), x);
+        _mm256_storeu_si256((__m256i *)(a + s + 8), y);
+    }
+}
+
+ACL_PYTHON_TARGET_AVX2 static void
+ntt_dit_layer_avx2(unsigned int *a, int n, int h, const unsigned int *w,
+                   unsigned int mod, unsigned int ninv) {
+    if (n < 16) {
+        ntt_dit_layer_scalar(a, n, h, w, mod, ninv);
+        return;
+    }
+    if (h >= 8) {
+        for (int s = 0; s < n; s += 2 * h) {
+            ntt_dit_strip_avx2(a + s, a + s + h, w + h, h, mod, ninv);
+        }
+        return;
+    }
+    const __m256i vm = _mm256_set1_epi32((int)mod);
+    const __m256i vn = _mm256_set1_epi32((int)ninv);
+    const __m256i z = ntt_small_twiddle_avx2(w, h);
+    for (int s = 0; s < n; s += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + s));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(a + s + 8));
+        ntt_shuffle_avx2(x, y, h);
+        ntt_dit_bfly_avx2(x, y, z, vm, vn);
+        ntt_shuffle_avx2(x, y, h);
+        _mm256_storeu_si256((__m256i *)(a + s), x);
+        _mm256_storeu_si256((__m256i *)(a + s + 8), y);
+    }
+}
+
+ACL_PYTHON_TARGET_AVX2 static void
+ntt_mul_avx2(unsigned int *a, const unsigned int *b, int n,
+             unsigned int mod, unsigned int ninv) {
+    const __m256i vm = _mm256_set1_epi32((int)mod);
+    const __m256i vn = _mm256_set1_epi32((int)ninv);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        _mm256_storeu_si256((__m256i *)(a + i), ntt_mont_mul_avx2(x, y, vm, vn));
+    }
+    for (; i < n; i++) a[i] = ntt_mont_mul(a[i], b[i], mod, ninv);
+}
+
+ACL_PYTHON_TARGET_AVX2 static void
+ntt_mul_const_avx2(unsigned int *a, int n, unsigned int c,
+                   unsigned int mod, unsigned int ninv) {
+    const __m256i vm = _mm256_set1_epi32((int)mod);
+    const __m256i vn = _mm256_set1_epi32((int)ninv);
+    const __m256i vc = _mm256_set1_epi32((int)c);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        _mm256_storeu_si256((__m256i *)(a + i), ntt_mont_mul_avx2(x, vc, vm, vn));
+    }
+    for (; i < n; i++) a[i] = ntt_mont_mul(a[i], c, mod, ninv);
+}
+
+static const ntt_kernel ntt_kernel_avx2 = {
+    "avx2",
+    ntt_dif_strip_avx2,
+    ntt_dit_strip_avx2,
+    ntt_dif_layer_avx2,
+    ntt_dit_layer_avx2,
+    ntt_mul_avx2,
+    ntt_mul_const_avx2,
+};
+
+
+ACL_PYTHON_AVX512_BEGIN
+
+ACL_PYTHON_TARGET_AVX512 static inline __m512i
+ntt_mont_mul_avx512(__m512i a, __m512i b, __m512i mod, __m512i ninv) {
+    __m512i t0 = _mm512_mul_epu32(a, b);
+    __m512i t1 = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+    __m512i m0 = _mm512_mul_epu32(t0, ninv);
+    __m512i m1 = _mm512_mul_epu32(t1, ninv);
+    t0 = _mm512_add_epi64(t0, _mm512_mul_epu32(m0, mod));
+    t1 = _mm512_add_epi64(t1, _mm512_mul_epu32(m1, mod));
+    __m512i r = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(t0, 32), t1);
+    return _mm512_min_epu32(r, _mm512_sub_epi32(r, mod));
+}
+
+ACL_PYTHON_TARGET_AVX512 static void
+ntt_dif_strip_avx512(unsigned int *x, unsigned int *y, const unsigned int *w, int len,
+                     unsigned int mod, unsigned int ninv) {
+    const __m512i vm = _mm512_set1_epi32((int)mod);
+    const __m512i vn = _mm512_set1_epi32((int)ninv);
+    int j = 0;
+    for (; j + 16 <= len; j += 16) {
+        __m512i u = _mm512_loadu_si512((const void *)(x + j));
+        __m512i v = _mm512_loadu_si512((const void *)(y + j));
+        __m512i z = _mm512_loadu_si512((const void *)(w + j));
+        __m512i p = _mm512_add_epi32(u, v);
+        p = _mm512_min_epu32(p, _mm512_sub_epi32(p, vm));
+        __m512i q = _mm512_sub_epi32(_mm512_add_epi32(u, vm), v);
+        q = _mm512_min_epu32(q, _mm512_sub_epi32(q, vm));
+        _mm512_storeu_si512((void *)(x + j), p);
+        _mm512_storeu_si512((void *)(y + j), ntt_mont_mul_avx512(q, z, vm, vn));
+    }
+    ntt_dif_strip_avx2(x + j, y + j, w + j, len - j, mod, ninv);
+}
+
+ACL_PYTHON_TARGET_AVX512 static void
+ntt_dit_strip_avx512(unsigned int *x, unsigned int *y, const unsigned int *w, int len,
+                     unsigned int mod, unsigned int ninv) {
+    const __m512i vm = _mm512_set1_epi32((int)mod);
+    const __m512i vn = _mm512_set1_epi32((int)ninv);
+    int j = 0;
+    for (; j + 16 <= len; j += 16) {
+        __m512i u = _mm512_loadu_si512((const void *)(x + j));
+        __m512i z = _mm512_loadu_si512((const void *)(w + j));
+        __m512i v = ntt_mont_mul_avx512(_mm512_loadu_si512((const void *)(y + j)), z, vm, vn);
+        __m512i p = _mm512_add_epi32(u, v);
+        p = _mm512_min_epu32(p, _mm512_sub_epi32(p, vm));
+        __m512i q = _mm512_sub_epi32(_mm512_add_epi32(u, vm), v);
+        q = _mm512_min_epu32(q, _mm512_sub_epi32(q, vm));
+        _mm512_storeu_si512((void *)(x + j), p);
+        _mm512_storeu_si512((void *)(y + j), q);
+    }
+    ntt_dit_strip_avx2(x + j, y + j, w + j, len - j, mod, ninv);
+}
+
+/* the layers with h < 16 are left to the AVX2 kernel */
+ACL_PYTHON_TARGET_AVX512 static void
+ntt_dif_layer_avx512(unsigned int *a, int n, int h, const unsigned int *w,
+                     unsigned int mod, unsigned int ninv) {
+    if (h < 16) {
+        ntt_dif_layer_avx2(a, n, h, w, mod, ninv);
+        return;
+    }
+    for (int s = 0; s < n; s += 2 * h) {
+        ntt_dif_strip_avx512(a + s, a + s + h, w + h, h, mod, ninv);
+    }
+}
+
+ACL_PYTHON_TARGET_AVX512 static void
+ntt_dit_layer_avx512(unsigned int *a, int n, int h, const unsigned int *w,
+                     unsigned int mod, unsigned int ninv) {
+    if (h < 16) {
+        ntt_dit_layer_avx2(a, n, h, w, mod, ninv);
+        return;
+    }
+    for (int s = 0; s < n; s += 2 * h) {
+        ntt_dit_strip_avx512(a + s, a + s + h, w + h, h, mod, ninv);
+    }
+}
+
+ACL_PYTHON_TARGET_AVX512 static void
+ntt_mul_avx512(unsigned int *a, const unsigned int *b, int n,
+               unsigned int mod, unsigned int ninv) {
+    const __m512i vm = _mm512_set1_epi32((int)mod);
+    const __m512i vn = _mm512_set1_epi32((int)ninv);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i x = _mm512_loadu_si512((const void *)(a + i));
+        __m512i y = _mm512_loadu_si512((const void *)(b + i));
+        _mm512_storeu_si512((void *)(a + i), ntt_mont_mul_avx512(x, y, vm, vn));
+    }
+    for (; i < n; i++) a[i] = ntt_mont_mul(a[i], b[i], mod, ninv);
+}
+
+ACL_PYTHON_TARGET_AVX512 static void
+ntt_mul_const_avx512(unsigned int *a, int n, unsigned int c,
+                     unsigned int mod, unsigned int ninv) {
+    const __m512i vm = _mm512_set1_epi32((int)mod);
+    const __m512i vn = _mm512_set1_epi32((int)ninv);
+    const __m512i vc = _mm512_set1_epi32((int)c);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i x = _mm512_loadu_si512((const void *)(a + i));
+        _mm512_storeu_si512((void *)(a + i), ntt_mont_mul_avx512(x, vc, vm, vn));
+    }
+    for (; i < n; i++) a[i] = ntt_mont_mul(a[i], c, mod, ninv);
+}
+
+static const ntt_kernel ntt_kernel_avx512 = {
+    "avx512",
+    ntt_dif_strip_avx512,
+    ntt_dit_strip_avx512,
+    ntt_dif_layer_avx512,
+    ntt_dit_layer_avx512,
+    ntt_mul_avx512,
+    ntt_mul_const_avx512,
+};
+
+ACL_PYTHON_AVX512_END
+
+#endif  // ACL_PYTHON_X86_SIMD
+
+
+static const ntt_kernel *ntt_simd_kernel = &ntt_kernel_scalar;
+
+/* called once from PyInit_atcoder, after cpu_detect() */
+static void
+ntt_select_kernel() {
+    ntt_simd_kernel = &ntt_kernel_scalar;
+#ifdef ACL_PYTHON_X86_SIMD
+    if (cpu.avx2) ntt_simd_kernel = &ntt_kernel_avx2;
+    if (cpu.avx2 && cpu.avx512f && cpu.avx512bw) ntt_simd_kernel = &ntt_kernel_avx512;
+#endif
+}
+
+static const ntt_kernel &
+ntt_kernel_for(unsigned int mod) {
+    if (mod < (1U << 30)) return *ntt_simd_kernel;
+    return ntt_kernel_scalar;
+}
+
+
+/* The first layers (and the last ones for the inverse) run over the whole
+   array; once a butterfly fits in NTT_BLOCK elements the remaining layers
+   are done block by block while the block is still in cache.
+
+   With threads > 1 the blocks are spread over the worker pool, and each
+   of the large layers is cut into strips of at least NTT_STRIP pairs.
+   Every strip writes its own elements only, so the result does not
+   depend on the number of threads. */
+#define NTT_BLOCK (1 << 14)
+#define NTT_STRIP (1 << 12)
+
+/* transforms of this length and above use the worker pool */
+#define CONVOLUTION_PARALLEL_THRESHOLD (1 << 22)
+
+
+static void
+ntt_parallel_layer(bool dif, const ntt_kernel &k, unsigned int *a, int n, int h,
+                   const unsigned int *w, const ntt_info &f, int threads) {
+    int blocks = n / (2 * h);
+    int parts = 1;
+    while (blocks * parts < 4 * threads && h / parts > NTT_STRIP) parts <<= 1;
+    int len = h / parts;
+    auto strip = dif ? k.dif_strip : k.dit_strip;
+    parallel_for(blocks * parts, threads, [&](int t) {
+        int s = (t / parts) * 2 * h, j = (t % parts) * len;
+        strip(a + s + j, a + s + h + j, w + h + j, len, f.mod, f.ninv);
+    });
+}
+
+static void
+butterfly(unsigned int *a, int n, const ntt_info &f, int threads = 1) {
+    const ntt_kernel &k = ntt_kernel_for(f.mod);
+    const unsigned int *w = f.w.data();
+    int h = n >> 1;
+    for (; h >= 1 && 2 * h > NTT_BLOCK; h >>= 1) {
+        if (threads > 1) {
+            ntt_parallel_layer(true, k, a, n, h, w, f, threads);
+        } else {
+            k.dif_layer(a, n, h, w, f.mod, f.ninv);
+        }
+    }
+    int b = std::min(n, NTT_BLOCK);
+    parallel_for(n / b, threads, [&](int i) {
+        for (int hh = h; hh >= 1; hh >>= 1) {
+            k.dif_layer(a + i * b, b, hh, w, f.mod, f.ninv);
+        }
+    });
+}
+
+static void
+butterfly_inv(unsigned int *a, int n, const ntt_info &f, int threads = 1) {
+    const ntt_kernel &k = ntt_kernel_for(f.mod);
+    const unsigned int *w = f.iw.data();
+    int b = std::min(n, NTT_BLOCK);
+    parallel_for(n / b, threads, [&](int i) {
+        for (int h = 1; h < b; h <<= 1) {
+            k.dit_layer(a + i * b, b, h, w, f.mod, f.ninv);
+        }
+    });
+    for (int h = b; h < n; h <<= 1) {
+        if (threads > 1) {
+            ntt_parallel_layer(false, k, a, n, h, w, f, threads);
+        } else {
+            k.dit_layer(a, n, h, w, f.mod, f.ninv);
+        }
+    }
+}
+
+
+static std::vector<unsigned int>
+convolution_naive(const std::vector<unsigned int> &a,
+                  const std::vector<unsigned int> &b,
+                  unsigned int mod) {
+    int n = int(a.size()), m = int(b.size());
+    std::vector<unsigned int> ans(n + m - 1);
+    if (n < m) {
+        for (int j = 0; j < m; j++) {
+            for (int i = 0; i < n; i++) {
+                ans[i + j] = (unsigned int)((ans[i + j] + (unsigned long long)a[i] * b[j]) % mod);
+            }
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < m; j++) {
+                ans[i + j] = (unsigned int)((ans[i + j] + (unsigned long long)a[i] * b[j]) % mod);
+            }
+        }
+    }
+    return ans;
+}
+
+/* requires: (mod - 1) is divisible by bit_ceil(|a| + |b| - 1) */
+static std::vector<unsigned int>
+convolution_fft(std::vector<unsigned int> a, std::vector<unsigned int> b,
+                unsigned int mod, int threads = 1) {
+    int n = int(a.size()), m = int(b.size());
+    int z = 1 << ceil_pow2(n + m - 1);
+    if (z < CONVOLUTION_PARALLEL_THRESHOLD) threads = 1;
+    auto f = ntt_get_info(mod, z);
+    const ntt_kernel &k = ntt_kernel_for(mod);
+    a.resize(z);
+    butterfly(a.data(), z, *f, threads);
+    b.resize(z);
+    butterfly(b.data(), z, *f, threads);
+    int b_len = std::min(z, NTT_BLOCK);
+    parallel_for(z / b_len, threads, [&](int i) {
+        k.mul(a.data() + i * b_len, b.data() + i * b_len, b_len, f->mod, f->ninv);
+    });
+    butterfly_inv(a.data(), z, *f, threads);
+    // the pointwise product left a factor R^{-1}; c = z^{-1} * R^2
+    unsigned int iz = (unsigned int)pow_mod_constexpr(z, mod - 2, mod);
+    unsigned int c = ntt_mont_mul(ntt_mont_mul(iz, f->r2, mod, f->ninv), f->r2, mod, f->ninv);
+    parallel_for(z / b_len, threads, [&](int i) {
+        k.mul_const(a.data() + i * b_len, b_len, c, f->mod, f->ninv);
+    });
+    a.resize(n + m - 1);
+    return a;
+}
+
+/* a[i], b[i] in [0, mod), mod is prime */
+static std::vector<unsigned int>
+convolution_mod(const std::vector<unsigned int> &a,
+                const std::vector<unsigned int> &b,
+                unsigned int mod, int threads = 1) {
+    int n = int(a.size()), m = int(b.size());
+    if (!n || !m) return {};
+    if (std::min(n, m) <= 60) return convolution_naive(a, b, mod);
+    return convolution_fft(a, b, mod, threads);
+}
+
+
+/* Transforms for the callers that stay in the frequency domain across
+   several products (fps.hpp). n = |a| is a power of 2 and f.w has to be
+   at least that long.
+   ntt_mul leaves a factor R^{-1} on the product and ntt_inverse takes
+   exactly one such factor off (together with the 1/n), so every
+   ntt_inverse must follow exactly one ntt_mul. */
+static void
+ntt_forward(unsigned int *a, int n, const ntt_info &f) {
+    butterfly(a, n, f);
+}
+
+/* a[i] *= b[i]  for i < n */
+static void
+ntt_mul(unsigned int *a, const unsigned int *b, int n, const ntt_info &f) {
+    ntt_kernel_for(f.mod).mul(a, b, n, f.mod, f.ninv);
+}
+
+static void
+ntt_inverse(unsigned int *a, int n, const ntt_info &f) {
+    butterfly_inv(a, n, f);
+    unsigned int iz = (unsigned int)pow_mod_constexpr(n, f.mod - 2, f.mod);
+    unsigned int c = ntt_mont_mul(ntt_mont_mul(iz, f.r2, f.mod, f.ninv), f.r2, f.mod, f.ninv);
+    ntt_kernel_for(f.mod).mul_const(a, n, c, f.mod, f.ninv);
+}
+
+static void
+ntt_forward(std::vector<unsigned int> &a, const ntt_info &f) {
+    ntt_forward(a.data(), (int)a.size(), f);
+}
+
+/* |b| >= |a| */
+static void
+ntt_mul(std::vector<unsigned int> &a, const std::vector<unsigned int> &b, const ntt_info &f) {
+    ntt_mul(a.data(), b.data(), (int)a.size(), f);
+}
+
+static void
+ntt_inverse(std::vector<unsigned int> &a, const ntt_info &f) {
+    ntt_inverse(a.data(), (int)a.size(), f);
+}
+
+
+/* The three transforms are independent: with threads > 1 they run
+   concurrently, each one with its share of the threads. */
+static std::vector<long long>
+convolution_ll(const std::vector<long long> &a,
+               const std::vector<long long> &b,
+               int threads = 1) {
+    int n = int(a.size()), m = int(b.size());
+    if (!n || !m) return {};
+
+    static constexpr unsigned long long MOD1 = 754974721;  // 2^24
+    static constexpr unsigned long long MOD2 = 167772161;  // 2^25
+    static constexpr unsigned long long MOD3 = 469762049;  // 2^26
+    static constexpr unsigned long long M2M3 = MOD2 * MOD3;
+    static constexpr unsigned long long M1M3 = MOD1 * MOD3;
+    static constexpr unsigned long long M1M2 = MOD1 * MOD2;
+    static constexpr unsigned long long M1M2M3 = MOD1 * MOD2 * MOD3;
+
+    static constexpr unsigned long long i1 = inv_gcd(MOD2 * MOD3, MOD1).second;
+    static constexpr unsigned long long i2 = inv_gcd(MOD1 * MOD3, MOD2).second;
+    static constexpr unsigned long long i3 = inv_gcd(MOD1 * MOD2, MOD3).second;
+
+    if ((1 << ceil_pow2(n + m - 1)) < CONVOLUTION_PARALLEL_THRESHOLD) threads = 1;
+    int inner = std::max(threads / 3, 1);
+
+    static constexpr unsigned long long mods[3] = {MOD1, MOD2, MOD3};
+    std::vector<unsigned int> c[3];
+    parallel_for(3, threads, [&](int t) {
+        std::vector<unsigned int> a2(n), b2(m);
+        for (int i = 0; i < n; i++) a2[i] = (unsigned int)safe_mod(a[i], mods[t]);
+        for (int i = 0; i < m; i++) b2[i] = (unsigned int)safe_mod(b[i], mods[t]);
+        c[t] = convolution_mod(a2, b2, (unsigned int)mods[t], inner);
+    });
+
+    std::vector<long long> ans(n + m - 1);
+    int chunk = std::max((n + m - 1) / (4 * threads), 1);
+    parallel_for((n + m - 1 + chunk - 1) / chunk, threads, [&](int t) {
+        int r = std::min(n + m - 1, (t + 1) * chunk);
+        for (int i = t * chunk; i < r; i++) {
+            unsigned long long x = 0;
+            x += (c[0][i] * i1) % MOD1 * M2M3;
+            x += (c[1][i] * i2) % MOD2 * M1M3;
+            x += (c[2][i] * i3) % MOD3 * M1M2;
+            // B = 2^63, -B <= x, r(real value) < B
+            // (x, x - M, x - 2M, or x - 3M) = r (mod 2B)
+            // result = (c[0], c[1], c[2]) - x
+            long long diff = c[0][i] - safe_mod((long long)(x), (long long)(MOD1));
+            if (diff < 0) diff += MOD1;
+            static constexpr unsigned long long offset[5] = {
+                0, 0, M1M2M3, 2 * M1M2M3, 3 * M1M2M3};
+            x -= offset[diff % 5];
+            ans[i] = x;
+        }
+    });
+    return ans;
+}
+
+
+} // namespace internal
+
+
+
+/* convolution  *******************************************/
+
+/*
+    >>> convolution([1, 2, 3], [4, 5])
+    [4, 13, 22, 15]
+    >>> convolution([1, 2, 3], [4, 5], 7)
+    [4, 6, 1, 1]
+    >>> convolution_ll([10**9, -1], [10**9, 1])
+    [1000000000000000000, 0, -1]
+
+*/
+
+
+static PyObject *
+convolution(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"b", (char *)"mod", (char *)"threads", NULL};
+    PyObject *a_obj, *b_obj;
+    long long mod = 998244353;
+    int threads = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|L$i", kwlist,
+                                     &a_obj, &b_obj, &mod, &threads)) return NULL;
+    if (!PyList_Check(a_obj) || !PyList_Check(b_obj)) {
+        PyErr_SetString(PyExc_TypeError, "required : list[int], list[int]");
+        return NULL;
+    }
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must be non-negative");
+        return NULL;
+    }
+    if (mod < 2 || mod >= (1LL << 31) || !is_prime_constexpr((int)mod)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] mod is a prime less than 2^31");
+        return NULL;
+    }
+    int err = 0;
+    auto a = _PyList_AsVectorLongLong(a_obj, &err);
+    if (err) return NULL;
+    auto b = _PyList_AsVectorLongLong(b_obj, &err);
+    if (err) return NULL;
+    int n = (int)a.size(), m = (int)b.size();
+    if (n && m && std::min(n, m) > 60) {
+        int z = 1 << internal::ceil_pow2(n + m - 1);
+        if ((mod - 1) % z) {
+            PyErr_Format(PyExc_ValueError,
+                         "(mod - 1) must be divisible by %d (= bit_ceil(len(a) + len(b) - 1))", z);
+            return NULL;
+        }
+    }
+    std::vector<unsigned int> a2(n), b2(m);
+    for (int i = 0; i < n; i++) a2[i] = (unsigned int)safe_mod(a[i], mod);
+    for (int i = 0; i < m; i++) b2[i] = (unsigned int)safe_mod(b[i], mod);
+    std::vector<unsigned int> c;
+    threads = internal::resolve_threads(threads);
+    Py_BEGIN_ALLOW_THREADS
+    c = internal::convolution_mod(a2, b2, (unsigned int)mod, threads);
+    Py_END_ALLOW_THREADS
+    return _PyList_FromVector(c);
+}
+
+PyDoc_STRVAR(convolution_doc,
+"convolution($module, a, b, mod=998244353, *, threads=0)\n"
+"--\n\n"
+"It calculates the convolution in mod `mod`.\n"
+"c[i] = sum(a[j] * b[i - j] for j in range(i + 1)) % mod\n"
+"(out-of-range terms are 0). If a or b is empty, it returns [].\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int]\n"
+"    array of integers\n"
+"b : list[int]\n"
+"    array of integers\n"
+"mod : int\n"
+"    prime modulus\n"
+"threads : int\n"
+"    number of threads used for transforms of length >= 2^22\n"
+"    (0: all the cores). The result does not depend on it.\n"
+"\n"
+"Returns\n"
+"-------\n"
+"c : list[int]\n"
+"    array of length len(a) + len(b) - 1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"2 <= mod < 2^31, mod is prime\n"
+"-2^63 <= a[i], b[i] < 2^63\n"
+"There is an integer c with 2^c | (mod - 1) and\n"
+"len(a) + len(b) - 1 <= 2^c\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F((n + m)log(n + m) + log(mod))  (n = len(a), m = len(b))"
+);
+
+#define ACL_PYTHON_CONVOLUTION_METHODDEF \
+    {"convolution", (PyCFunction)convolution, METH_VARARGS | METH_KEYWORDS, convolution_doc},
+
+
+static PyObject *
+convolution_ll(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"b", (char *)"threads", NULL};
+    PyObject *a_obj, *b_obj;
+    int threads = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|$i", kwlist,
+                                     &a_obj, &b_obj, &threads)) return NULL;
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must be non-negative");
+        return NULL;
+    }
+    if (!PyList_Check(a_obj) || !PyList_Check(b_obj)) {
+        PyErr_SetString(PyExc_TypeError, "required : list[int], list[int]");
+        return NULL;
+    }
+    int err = 0;
+    auto a = _PyList_AsVectorLongLong(a_obj, &err);
+    if (err) return NULL;
+    auto b = _PyList_AsVectorLongLong(b_obj, &err);
+    if (err) return NULL;
+    if (a.size() && b.size() && a.size() + b.size() - 1 > (1U << 24)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] len(a) + len(b) - 1 <= 2^24");
+        return NULL;
+    }
+    std::vector<long long> c;
+    threads = internal::resolve_threads(threads);
+    Py_BEGIN_ALLOW_THREADS
+    c = internal::convolution_ll(a, b, threads);
+    Py_END_ALLOW_THREADS
+    return _PyList_FromVector(c);
+}
+
+PyDoc_STRVAR(convolution_ll_doc,
+"convolution_ll($module, a, b, *, threads=0)\n"
+"--\n\n"
+"It calculates the convolution without taking mod.\n"
+"c[i] = sum(a[j] * b[i - j] for j in range(i + 1))\n"
+"If a or b is empty, it returns [].\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int]\n"
+"    array of integers\n"
+"b : list[int]\n"
+"    array of integers\n"
+"threads : int\n"
+"    number of threads used for transforms of length >= 2^22\n"
+"    (0: all the cores). The result does not depend on it.\n"
+"\n"
+"Returns\n"
+"-------\n"
+"c : list[int]\n"
+"    array of length len(a) + len(b) - 1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"len(a) + len(b) - 1 <= 2^24\n"
+"All the elements of c fit into long long\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F((n + m)log(n + m))  (n = len(a), m = len(b))"
+);
+
+#define ACL_PYTHON_CONVOLUTION_LL_METHODDEF \
+    {"convolution_ll", (PyCFunction)convolution_ll, METH_VARARGS | METH_KEYWORDS, convolution_ll_doc},
+
+
+PyMethodDef convolutionfunctions[] = {
+    ACL_PYTHON_CONVOLUTION_METHODDEF
+    ACL_PYTHON_CONVOLUTION_LL_METHODDEF
+    {NULL} /* Sentinel */
+};
+
+
+} // namespace atcoder_python
+
+#endif  // ACL_PYTHON_CONVOLUTION
@@ -0,0 +1,1019 @@
+#ifndef ACL_PYTHON_FPS
+#define ACL_PYTHON_FPS
+
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "atcoder/utils"
+#include "atcoder/internal_bit"
+#include "atcoder/internal_math"
+#include "atcoder/convolution"
+
+
+// reference: https://github.com/NyaanNyaan/library/blob/master/fps/ntt-friendly-fps.hpp
+
+
+
+namespace atcoder_python {
+namespace internal {
+
+
+/* formal power series ************************************/
+
+/* Operations on formal power series  f = a[0] + a[1] x + a[2] x^2 + ...
+   over Z/pZ for an NTT-friendly prime p, truncated to the first n terms.
+
+    The Newton iterations double the precision m each step and stay in the
+    frequency domain of the NTT (ntt_forward / ntt_mul / ntt_inverse) as
+    long as they can: a transform of length 2m computed in one step is
+    reused for the products of that step, and exp also keeps the
+    transform of its running inverse between steps.
+    All of them are O(nlogn).
+*/
+
+
+static inline unsigned int
+fps_mul_mod(unsigned int a, unsigned int b, unsigned int mod) {
+    return (unsigned int)((unsigned long long)a * b % mod);
+}
+
+static inline unsigned int
+fps_inv_mod(unsigned int a, unsigned int mod) {
+    return (unsigned int)pow_mod_constexpr(a, mod - 2, mod);
+}
+
+static std::vector<unsigned int>
+fps_multiply(const std::vector<unsigned int> &a, const std::vector<unsigned int> &b,
+             unsigned int mod) {
+    return convolution_mod(a, b, mod);
+}
+
+/* a[0] != 0 */
+static std::vector<unsigned int>
+fps_inv_impl(const std::vector<unsigned int> &a, int n, unsigned int mod) {
+    if (n == 0) return {};
+    auto f = ntt_get_info(mod, 2 << ceil_pow2(n));
+    std::vector<unsigned int> g = {fps_inv_mod(a[0], mod)};
+    g.reserve(2 << ceil_pow2(n));
+    for (int m = 1; m < n; m *= 2) {
+        // (a g - 1) vanishes below x^m;  g <- g - (a g - 1) g
+        std::vector<unsigned int> x(a.begin(), a.begin() + std::min((int)a.size(), 2 * m));
+        x.resize(2 * m);
+        std::vector<unsigned int> y = g;
+        y.resize(2 * m);
+        ntt_forward(x, *f);
+        ntt_forward(y, *f);
+        ntt_mul(x, y, *f);
+        ntt_inverse(x, *f);
+        std::fill(x.begin(), x.begin() + m, 0);
+        ntt_forward(x, *f);
+        ntt_mul(x, y, *f);
+        ntt_inverse(x, *f);
+        g.resize(2 * m);
+        for (int i = m; i < 2 * m; i++) g[i] = x[i] ? mod - x[i] : 0;
+    }
+    g.resize(n);
+    return g;
+}
+
+/* inv[i] = i^{-1} for i < n */
+static std::vector<unsigned int>
+fps_inverses(int n, unsigned int mod) {
+    std::vector<unsigned int> inv(std::max(n, 2));
+    inv[1] = 1;
+    for (int i = 2; i < n; i++) {
+        inv[i] = fps_mul_mod(mod - mod / i, inv[mod % i], mod);
+    }
+    return inv;
+}
+
+static void
+fps_diff_inplace(std::vector<unsigned int> &a, unsigned int mod) {
+    if (a.empty()) return;
+    for (int i = 1; i < (int)a.size(); i++) a[i - 1] = fps_mul_mod(a[i], i, mod);
+    a.pop_back();
+}
+
+static void
+fps_integral_inplace(std::vector<unsigned int> &a, const std::vector<unsigned int> &inv,
+                     unsigned int mod) {
+    a.insert(a.begin(), 0);
+    for (int i = 1; i < (int)a.size(); i++) a[i] = fps_mul_mod(a[i], inv[i], mod);
+}
+
+/* a[0] == 1 */
+static std::vector<unsigned int>
+fps_log_impl(const std::vector<unsigned int> &a, int n, unsigned int mod) {
+    if (n == 0) return {};
+    std::vector<unsigned int> da(a.begin(), a.begin() + std::min((int)a.size(), n));
+    fps_diff_inplace(da, mod);
+    std::vector<unsigned int> r = fps_multiply(da, fps_inv_impl(a, n, mod), mod);
+    r.resize(n - 1);
+    fps_integral_inplace(r, fps_inverses(n, mod), mod);
+    return r;
+}
+
+/* a[0] == 0
+
+   b = exp(a) and c = 1 / b are grown together; z2 keeps the transform of c
+   between the steps. */
+static std::vector<unsigned int>
+fps_exp_impl(std::vector<unsigned int> a, int n, unsigned int mod) {
+    if (n == 0) return {};
+    a.resize(n);
+    if (n == 1) return {1};
+    auto f = ntt_get_info(mod, 2 << ceil_pow2(n));
+    auto inv = fps_inverses(2 << ceil_pow2(n), mod);
+
+    std::vector<unsigned int> b = {1, a[1]}, c = {1}, z1, z2 = {1, 1};
+    for (int m = 2; m < n; m *= 2) {
+        std::vector<unsigned int> y = b;
+        y.resize(2 * m);
+        ntt_forward(y, *f);
+
+        // c <- c - (b c - 1) c  (mod x^m)
+        z1 = z2;
+        std::vector<unsigned int> z(y.begin(), y.begin() + m);
+        ntt_mul(z, z1, *f);
+        ntt_inverse(z, *f);
+        std::fill(z.begin(), z.begin() + m / 2, 0);
+        ntt_forward(z, *f);
+        ntt_mul(z, z1, *f);
+        for (auto &v : z) v = v ? mod - v : 0;
+        ntt_inverse(z, *f);
+        c.insert(c.end(), z.begin() + m / 2, z.end());
+        z2 = c;
+        z2.resize(2 * m);
+        ntt_forward(z2, *f);
+
+        // x = a' b - b'  (mod x^m - 1)
+        std::vector<unsigned int> x(a.begin(), a.begin() + m);
+        fps_diff_inplace(x, mod);
+        x.push_back(0);
+        ntt_forward(x, *f);
+        ntt_mul(x, y, *f);
+        ntt_inverse(x, *f);
+        std::vector<unsigned int> db = b;
+        fps_diff_inplace(db, mod);
+        for (int i = 0; i < m - 1; i++) {
+            x[i] = x[i] >= db[i] ? x[i] - db[i] : x[i] + mod - db[i];
+        }
+        x.resize(2 * m);
+        for (int i = 0; i < m - 1; i++) {
+            x[m + i] = x[i];
+            x[i] = 0;
+        }
+
+        // b <- b + b (a - log b)
+        ntt_forward(x, *f);
+        ntt_mul(x, z2, *f);
+        ntt_inverse(x, *f);
+        x.pop_back();
+        fps_integral_inplace(x, inv, mod);
+        for (int i = m; i < std::min(n, 2 * m); i++) {
+            x[i] += a[i];
+            if (x[i] >= mod) x[i] -= mod;
+        }
+        std::fill(x.begin(), x.begin() + m, 0);
+        ntt_forward(x, *f);
+        ntt_mul(x, y, *f);
+        ntt_inverse(x, *f);
+        b.insert(b.end(), x.begin() + m, x.end());
+    }
+    b.resize(n);
+    return b;
+}
+
+/* returns false if a has no square root */
+static bool
+fps_sqrt_impl(const std::vector<unsigned int> &a, int n, unsigned int mod,
+              std::vector<unsigned int> &res) {
+    res.assign(n, 0);
+    int l = std::min((int)a.size(), n);
+    int i = 0;
+    while (i < l && a[i] == 0) i++;
+    if (i == l) return true;
+    if (i % 2) return false;
+    long long s = sqrt_mod_constexpr(a[i], (int)mod);
+    if (s < 0) return false;
+    int len = n - i / 2;
+    std::vector<unsigned int> b(a.begin() + i, a.begin() + l);
+    std::vector<unsigned int> g = {(unsigned int)s};
+    unsigned int inv2 = (mod + 1) / 2;
+    // g <- (g + b / g) / 2
+    for (int m = 1; m < len; m *= 2) {
+        std::vector<unsigned int> x(b.begin(), b.begin() + std::min((int)b.size(), 2 * m));
+        x = fps_multiply(x, fps_inv_impl(g, 2 * m, mod), mod);
+        g.resize(2 * m);
+        for (int j = 0; j < 2 * m; j++) {
+            unsigned int v = g[j] + (j < (int)x.size() ? x[j] : 0);
+            if (v >= mod) v -= mod;
+            g[j] = fps_mul_mod(v, inv2, mod);
+        }
+    }
+    std::copy(g.begin(), g.begin() + len, res.begin() + i / 2);
+    return true;
+}
+
+/* a^k, 0 <= k < 2^63 */
+static std::vector<unsigned int>
+fps_pow_impl(const std::vector<unsigned int> &a, long long k, int n, unsigned int mod) {
+    std::vector<unsigned int> res(n, 0);
+    if (n == 0) return res;
+    if (k == 0) {
+        res[0] = 1;
+        return res;
+    }
+    int l = std::min((int)a.size(), n);
+    int i = 0;
+    while (i < l && a[i] == 0) i++;
+    if (i == l || (i && k >= (n + i - 1) / i)) return res;
+    int shift = (int)(i * k);
+    int len = n - shift;
+    unsigned int c = a[i], ic = fps_inv_mod(c, mod);
+    std::vector<unsigned int> b(len);
+    for (int j = 0; j < len && i + j < l; j++) b[j] = fps_mul_mod(a[i + j], ic, mod);
+    b = fps_log_impl(b, len, mod);
+    unsigned int km = (unsigned int)(k % mod);
+    for (auto &v : b) v = fps_mul_mod(v, km, mod);
+    b = fps_exp_impl(b, len, mod);
+    unsigned int ck = (unsigned int)pow_mod_constexpr(c, k, mod);
+    for (int j = 0; j < len; j++) res[shift + j] = fps_mul_mod(b[j], ck, mod);
+    return res;
+}
+
+static void
+fps_shrink(std::vector<unsigned int> &a) {
+    while (!a.empty() && a.back() == 0) a.pop_back();
+}
+
+/* a = b q + r, deg r < deg b;  b is non-zero */
+static void
+fps_divmod_impl(std::vector<unsigned int> a, std::vector<unsigned int> b, unsigned int mod,
+                std::vector<unsigned int> &q, std::vector<unsigned int> &r) {
+    fps_shrink(a);
+    fps_shrink(b);
+    int n = (int)a.size(), m = (int)b.size();
+    if (n < m) {
+        q.clear();
+        r = a;
+        return;
+    }
+    int d = n - m + 1;
+    std::vector<unsigned int> ra(a.rbegin(), a.rbegin() + d);
+    std::vector<unsigned int> rb(b.rbegin(), b.rend());
+    q = fps_multiply(ra, fps_inv_impl(rb, d, mod), mod);
+    q.resize(d);
+    std::reverse(q.begin(), q.end());
+    std::vector<unsigned int> bq = fps_multiply(b, q, mod);
+    r.assign(a.begin(), a.begin() + (m - 1));
+    for (int i = 0; i < m - 1; i++) {
+        r[i] = r[i] >= bq[i] ? r[i] - bq[i] : r[i] + mod - bq[i];
+    }
+    fps_shrink(r);
+}
+
+
+/* subproduct tree ****************************************/
+
+/* The tree is built over the points padded with zeros to s = bit_ceil(n)
+   and keeps the reversed products  Q_v(y) = prod_{i in v} (1 - x_i y),
+   so a padding point contributes the factor 1 and a node of level d has
+   degree <= 2^d and Q_v[0] = 1.
+
+   All the nodes live in one arena: level d starts at d * 2s and its j-th
+   node takes the 2^(d+1) words from there + j * 2^(d+1). The nodes of
+   width below SUBPRODUCT_NAIVE_SIZE keep their coefficients and the wider
+   ones keep their NTT of length 2^(d+1), which is what the parent needs
+   both for its own product and for the transposed products going down.
+
+   The evaluation is the transposed algorithm (Bostan, Lecerf and Schost):
+   with  W_v[k] = sum_t a[t + k] [y^t] 1 / Q_v,  the children get
+   W_L[k] = sum_j W_v[j + k] Q_R[j]  (and symmetrically for R), and a leaf
+   ends up with W[0] = a(x_i). That is one forward and two inverse
+   transforms per node and no polynomial division. */
+
+#define SUBPRODUCT_NAIVE_SIZE 64
+
+struct subproduct_tree {
+    int n, s, log;
+    unsigned int mod;
+    std::shared_ptr<ntt_info> f;
+    std::vector<unsigned int> arena;
+    std::vector<unsigned int> root;  // coefficients of Q_root
+
+    unsigned int *node(int d, int j) {
+        return arena.data() + (size_t)d * 2 * s + ((size_t)j << (d + 1));
+    }
+    bool transformed(int d) const {
+        return (2 << d) >= SUBPRODUCT_NAIVE_SIZE;
+    }
+};
+
+/* n >= 1 */
+static void
+subproduct_build(subproduct_tree &t, const std::vector<unsigned int> &x, unsigned int mod) {
+    t.n = (int)x.size();
+    t.log = ceil_pow2(t.n);
+    t.s = 1 << t.log;
+    t.mod = mod;
+    t.f = ntt_get_info(mod, 2 * t.s);
+    t.arena.assign((size_t)(t.log + 1) * 2 * t.s, 0);
+    const ntt_info &f = *t.f;
+
+    for (int i = 0; i < t.s; i++) {
+        unsigned int *q = t.node(0, i);
+        q[0] = 1;
+        q[1] = i < t.n && x[i] ? mod - x[i] : 0;
+    }
+    for (int d = 0; d < t.log; d++) {
+        int h = 1 << d;
+        for (int j = 0; j < (t.s >> (d + 1)); j++) {
+            unsigned int *l = t.node(d, 2 * j), *r = t.node(d, 2 * j + 1), *p = t.node(d + 1, j);
+            if (t.transformed(d)) {
+                std::copy(l, l + 2 * h, p);
+                ntt_mul(p, r, 2 * h, f);
+                ntt_inverse(p, 2 * h, f);
+                // the coefficient of y^{2h} has wrapped around onto y^0
+                p[2 * h] = p[0] ? p[0] - 1 : mod - 1;
+                p[0] = 1;
+            } else {
+                for (int a = 0; a <= h; a++) {
+                    for (int b = 0; b <= h; b++) {
+                        p[a + b] = (unsigned int)((p[a + b] + (unsigned long long)l[a] * r[b]) % mod);
+                    }
+                }
+            }
+            if (d + 1 == t.log) {
+                t.root.assign(p, p + 2 * h + 1);
+            } else if (t.transformed(d + 1)) {
+                ntt_forward(p, 4 * h, f);
+            }
+        }
+    }
+    if (t.log == 0) t.root.assign(t.node(0, 0), t.node(0, 0) + 2);
+}
+
+/* a(x_i) for every point */
+static std::vector<unsigned int>
+subproduct_evaluate(subproduct_tree &t, const std::vector<unsigned int> &a) {
+    unsigned int mod = t.mod;
+    const ntt_info &f = *t.f;
+    int s = t.s, m = (int)a.size();
+    std::vector<unsigned int> res(t.n, 0);
+    if (m == 0) return res;
+
+    std::vector<unsigned int> ra(a.rbegin(), a.rend());
+    std::vector<unsigned int> c = fps_multiply(ra, fps_inv_impl(t.root, m, mod), mod);
+    std::vector<unsigned int> w(s, 0), nw(s), x(s), y(s);
+    for (int k = 0; k < std::min(m, s); k++) w[k] = c[m - 1 - k];
+
+    for (int d = t.log - 1; d >= 0; d--) {
+        int h = 1 << d;
+        for (int j = 0; j < (s >> (d + 1)); j++) {
+            const unsigned int *wv = w.data() + 2 * j * h;
+            const unsigned int *l = t.node(d, 2 * j), *r = t.node(d, 2 * j + 1);
+            unsigned int *wl = nw.data() + 2 * j * h, *wr = wl + h;
+            if (t.transformed(d)) {
+                std::reverse_copy(wv, wv + 2 * h, x.data());
+                ntt_forward(x.data(), 2 * h, f);
+                std::copy(x.begin(), x.begin() + 2 * h, y.begin());
+                ntt_mul(x.data(), r, 2 * h, f);
+                ntt_inverse(x.data(), 2 * h, f);
+                ntt_mul(y.data(), l, 2 * h, f);
+                ntt_inverse(y.data(), 2 * h, f);
+                for (int k = 0; k < h; k++) {
+                    wl[k] = x[2 * h - 1 - k];
+                    wr[k] = y[2 * h - 1 - k];
+                }
+            } else {
+                for (int k = 0; k < h; k++) {
+                    unsigned long long sl = 0, sr = 0;
+                    for (int i = 0; i <= h && i + k < 2 * h; i++) {
+                        sl = (sl + (unsigned long long)wv[i + k] * r[i]) % mod;
+                        sr = (sr + (unsigned long long)wv[i + k] * l[i]) % mod;
+                    }
+                    wl[k] = (unsigned int)sl;
+                    wr[k] = (unsigned int)sr;
+                }
+            }
+        }
+        std::swap(w, nw);
+    }
+    std::copy(w.begin(), w.begin() + t.n, res.begin());
+    return res;
+}
+
+/* The polynomial of degree < n through (x_i, y_i). With P = prod (x - x_i)
+   and w_i = y_i / P'(x_i), it is  sum_i w_i prod_{j != i} (x - x_j), which
+   is merged up the tree in the reversed form as
+   M_v = M_L Q_R + M_R Q_L.  Returns false if the points are not distinct. */
+static bool
+subproduct_interpolate(subproduct_tree &t, const std::vector<unsigned int> &ys,
+                       std::vector<unsigned int> &res) {
+    unsigned int mod = t.mod;
+    const ntt_info &f = *t.f;
+    int n = t.n, s = t.s;
+
+    // P[k] = Q_root[n - k]
+    std::vector<unsigned int> dp(n);
+    for (int k = 1; k <= n; k++) {
+        dp[k - 1] = fps_mul_mod(n - k < (int)t.root.size() ? t.root[n - k] : 0, k, mod);
+    }
+    std::vector<unsigned int> v = subproduct_evaluate(t, dp);
+
+    // batch inversion of v
+    std::vector<unsigned int> pre(n + 1);
+    pre[0] = 1;
+    for (int i = 0; i < n; i++) {
+        if (v[i] == 0) return false;
+        pre[i + 1] = fps_mul_mod(pre[i], v[i], mod);
+    }
+    std::vector<unsigned int> m(s, 0), nm(s), x(s), y(s);
+    unsigned int iv = fps_inv_mod(pre[n], mod);
+    for (int i = n - 1; i >= 0; i--) {
+        m[i] = fps_mul_mod(ys[i], fps_mul_mod(iv, pre[i], mod), mod);
+        iv = fps_mul_mod(iv, v[i], mod);
+    }
+
+    for (int d = 0; d < t.log; d++) {
+        int h = 1 << d;
+        for (int j = 0; j < (s >> (d + 1)); j++) {
+            const unsigned int *ml = m.data() + 2 * j * h, *mr = ml + h;
+            const unsigned int *l = t.node(d, 2 * j), *r = t.node(d, 2 * j + 1);
+            unsigned int *p = nm.data() + 2 * j * h;
+            if (t.transformed(d)) {
+                std::copy(ml, ml + h, x.begin());
+                std::fill(x.begin() + h, x.begin() + 2 * h, 0);
+                std::copy(mr, mr + h, y.begin());
+                std::fill(y.begin() + h, y.begin() + 2 * h, 0);
+                ntt_forward(x.data(), 2 * h, f);
+                ntt_forward(y.data(), 2 * h, f);
+                ntt_mul(x.data(), r, 2 * h, f);
+                ntt_mul(y.data(), l, 2 * h, f);
+                for (int k = 0; k < 2 * h; k++) {
+                    x[k] += y[k];
+                    if (x[k] >= mod) x[k] -= mod;
+                }
+                ntt_inverse(x.data(), 2 * h, f);
+                std::copy(x.begin(), x.begin() + 2 * h, p);
+            } else {
+                std::fill(p, p + 2 * h, 0);
+                for (int a = 0; a < h; a++) {
+                    for (int b = 0; b <= h && a + b < 2 * h; b++) {
+                        p[a + b] = (unsigned int)((p[a + b] + (unsigned long long)ml[a] * r[b]
+                                                   + (unsigned long long)mr[a] * l[b]) % mod);
+                    }
+                }
+            }
+        }
+        std::swap(m, nm);
+    }
+    res.resize(n);
+    for (int k = 0; k < n; k++) res[k] = m[n - 1 - k];
+    return true;
+}
+
+
+} // namespace internal
+
+
+
+/* fps  ***************************************************/
+
+/*
+    >>> fps_inv([1, 1], 5)
+    [1, 998244352, 1, 998244352, 1]     # 1 / (1 + x) = 1 - x + x^2 - ...
+    >>> fps_exp([0, 1], 4)
+    [1, 1, 499122177, 166374059]        # 1 + x + x^2/2 + x^3/6
+    >>> fps_log(fps_exp([0, 1], 4))
+    [0, 1, 0, 0]
+    >>> fps_pow([1, 1], 3, 5)
+    [1, 3, 3, 1, 0]                     # (1 + x)^3
+    >>> fps_divmod([1, 2, 3, 4], [1, 1])
+    ([3, 998244352, 4], [998244351])
+    >>> multipoint_eval([1, 2, 3], [0, 1, 2])
+    [1, 6, 17]
+    >>> interpolate([0, 1, 2], [1, 6, 17])
+    [1, 2, 3]
+
+*/
+
+
+/* parses (a, n, mod); a is reduced in mod and n defaults to len(a).
+   `len` is the length whose transforms of size 2 * bit_ceil(len) must
+   be supported by mod. */
+static int
+fps_parse_args(PyObject *a_obj, PyObject *n_obj, long long mod,
+               std::vector<unsigned int> &a, int &n) {
+    if (mod < 2 || mod >= (1LL << 31) || !is_prime_constexpr((int)mod)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] mod is a prime less than 2^31");
+        return -1;
+    }
+    int err = 0;
+    auto v = _PyObject_AsVectorLongLong(a_obj, &err);
+    if (err) return -1;
+    a.resize(v.size());
+    for (size_t i = 0; i < v.size(); i++) a[i] = (unsigned int)safe_mod(v[i], mod);
+    if (n_obj == NULL || n_obj == Py_None) {
+        n = (int)a.size();
+    } else {
+        long long x = PyLong_AsLongLong(n_obj);
+        if (x == -1 && PyErr_Occurred()) return -1;
+        if (x < 0 || x >= (1LL << 30)) {
+            PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n < 2^30");
+            return -1;
+        }
+        n = (int)x;
+    }
+    return 0;
+}
+
+static int
+fps_check_length(long long mod, int len) {
+    long long z = 2LL << internal::ceil_pow2(std::max(len, 1));
+    if ((mod - 1) % z) {
+        PyErr_Format(PyExc_ValueError,
+                     "(mod - 1) must be divisible by %lld for length %d", z, len);
+        return -1;
+    }
+    return 0;
+}
+
+
+static PyObject *
+fps_inv(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"n", (char *)"mod", NULL};
+    PyObject *a_obj, *n_obj = NULL;
+    long long mod = 998244353;
+    std::vector<unsigned int> a, r;
+    int n;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OL", kwlist, &a_obj, &n_obj, &mod)) return NULL;
+    if (fps_parse_args(a_obj, n_obj, mod, a, n)) return NULL;
+    if (fps_check_length(mod, n)) return NULL;
+    if (n && (a.empty() || a[0] == 0)) {
+        PyErr_SetString(PyExc_ValueError, "a[0] must be non-zero");
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::fps_inv_impl(a, n, (unsigned int)mod);
+    Py_END_ALLOW_THREADS
+    return _PyList_FromVector(r);
+}
+
+PyDoc_STRVAR(fps_inv_doc,
+"fps_inv($module, a, n=None, mod=998244353)\n"
+"--\n\n"
+"It returns the first n terms of 1 / f, where\n"
+"f = a[0] + a[1] x + a[2] x^2 + ... is a formal power series in mod `mod`.\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int] | buffer of integers\n"
+"    coefficients of f\n"
+"n : int\n"
+"    number of terms (default: len(a))\n"
+"mod : int\n"
+"    prime modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"g : list[int]\n"
+"    g[0] + g[1] x + ... + g[n-1] x^(n-1) == 1 / f  (mod x^n)\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"a[0] != 0 (mod `mod`)\n"
+"mod is prime and (mod - 1) is divisible by 2 * bit_ceil(n)\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nlogn)"
+);
+
+#define ACL_PYTHON_FPS_INV_METHODDEF \
+    {"fps_inv", (PyCFunction)fps_inv, METH_VARARGS | METH_KEYWORDS, fps_inv_doc},
+
+
+static PyObject *
+fps_log(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"n", (char *)"mod", NULL};
+    PyObject *a_obj, *n_obj = NULL;
+    long long mod = 998244353;
+    std::vector<unsigned int> a, r;
+    int n;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OL", kwlist, &a_obj, &n_obj, &mod)) return NULL;
+    if (fps_parse_args(a_obj, n_obj, mod, a, n)) return NULL;
+    if (fps_check_length(mod, n)) return NULL;
+    if (n && (a.empty() || a[0] != 1)) {
+        PyErr_SetString(PyExc_ValueError, "a[0] must be 1");
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::fps_log_impl(a, n, (unsigned int)mod);
+    Py_END_ALLOW_THREADS
+    return _PyList_FromVector(r);
+}
+
+PyDoc_STRVAR(fps_log_doc,
+"fps_log($module, a, n=None, mod=998244353)\n"
+"--\n\n"
+"It returns the first n terms of log(f), where\n"
+"f = a[0] + a[1] x + a[2] x^2 + ... is a formal power series in mod `mod`.\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int] | buffer of integers\n"
+"    coefficients of f\n"
+"n : int\n"
+"    number of terms (default: len(a))\n"
+"mod : int\n"
+"    prime modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"g : list[int]\n"
+"    coefficients of log(f)  (mod x^n)\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"a[0] == 1\n"
+"mod is prime and (mod - 1) is divisible by 2 * bit_ceil(n)\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nlogn)"
+);
+
+#define ACL_PYTHON_FPS_LOG_METHODDEF \
+    {"fps_log", (PyCFunction)fps_log, METH_VARARGS | METH_KEYWORDS, fps_log_doc},
+
+
+static PyObject *
+fps_exp(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"n", (char *)"mod", NULL};
+    PyObject *a_obj, *n_obj = NULL;
+    long long mod = 998244353;
+    std::vector<unsigned int> a, r;
+    int n;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OL", kwlist, &a_obj, &n_obj, &mod)) return NULL;
+    if (fps_parse_args(a_obj, n_obj, mod, a, n)) return NULL;
+    if (fps_check_length(mod, n)) return NULL;
+    if (!a.empty() && a[0] != 0) {
+        PyErr_SetString(PyExc_ValueError, "a[0] must be 0");
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::fps_exp_impl(a, n, (unsigned int)mod);
+    Py_END_ALLOW_THREADS
+    return _PyList_FromVector(r);
+}
+
+PyDoc_STRVAR(fps_exp_doc,
+"fps_exp($module, a, n=None, mod=998244353)\n"
+"--\n\n"
+"It returns the first n terms of exp(f), where\n"
+"f = a[0] + a[1] x + a[2] x^2 + ... is a formal power series in mod `mod`.\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int] | buffer of integers\n"
+"    coefficients of f\n"
+"n : int\n"
+"    number of terms (default: len(a))\n"
+"mod : int\n"
+"    prime modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"g : list[int]\n"
+"    coefficients of exp(f)  (mod x^n)\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"a[0] == 0\n"
+"mod is prime and (mod - 1) is divisible by 2 * bit_ceil(n)\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nlogn)"
+);
+
+#define ACL_PYTHON_FPS_EXP_METHODDEF \
+    {"fps_exp", (PyCFunction)fps_exp, METH_VARARGS | METH_KEYWORDS, fps_exp_doc},
+
+
+static PyObject *
+fps_sqrt(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"n", (char *)"mod", NULL};
+    PyObject *a_obj, *n_obj = NULL;
+    long long mod = 998244353;
+    std::vector<unsigned int> a, r;
+    int n;
+    bool ok;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OL", kwlist, &a_obj, &n_obj, &mod)) return NULL;
+    if (fps_parse_args(a_obj, n_obj, mod, a, n)) return NULL;
+    if (fps_check_length(mod, n)) return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    ok = internal::fps_sqrt_impl(a, n, (unsigned int)mod, r);
+    Py_END_ALLOW_THREADS
+    if (!ok) {
+        PyErr_SetString(PyExc_ValueError, "there is no square root");
+        return NULL;
+    }
+    return _PyList_FromVector(r);
+}
+
+PyDoc_STRVAR(fps_sqrt_doc,
+"fps_sqrt($module, a, n=None, mod=998244353)\n"
+"--\n\n"
+"It returns the first n terms of a square root g of f (g * g == f), where\n"
+"f = a[0] + a[1] x + a[2] x^2 + ... is a formal power series in mod `mod`.\n"
+"If there is no square root, it raises ValueError.\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int] | buffer of integers\n"
+"    coefficients of f\n"
+"n : int\n"
+"    number of terms (default: len(a))\n"
+"mod : int\n"
+"    prime modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"g : list[int]\n"
+"    coefficients of a square root of f  (mod x^n)\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"mod is prime and (mod - 1) is divisible by 2 * bit_ceil(n)\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nlogn + log(mod)^2)"
+);
+
+#define ACL_PYTHON_FPS_SQRT_METHODDEF \
+    {"fps_sqrt", (PyCFunction)fps_sqrt, METH_VARARGS | METH_KEYWORDS, fps_sqrt_doc},
+
+
+static PyObject *
+fps_pow(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"k", (char *)"n", (char *)"mod", NULL};
+    PyObject *a_obj, *n_obj = NULL;
+    long long k;
+    long long mod = 998244353;
+    std::vector<unsigned int> a, r;
+    int n;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OL|OL", kwlist, &a_obj, &k, &n_obj, &mod)) return NULL;
+    if (k < 0) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= k < 2^63");
+        return NULL;
+    }
+    if (fps_parse_args(a_obj, n_obj, mod, a, n)) return NULL;
+    if (fps_check_length(mod, n)) return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::fps_pow_impl(a, k, n, (unsigned int)mod);
+    Py_END_ALLOW_THREADS
+    return _PyList_FromVector(r);
+}
+
+PyDoc_STRVAR(fps_pow_doc,
+"fps_pow($module, a, k, n=None, mod=998244353)\n"
+"--\n\n"
+"It returns the first n terms of f^k, where\n"
+"f = a[0] + a[1] x + a[2] x^2 + ... is a formal power series in mod `mod`.\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int] | buffer of integers\n"
+"    coefficients of f\n"
+"k : int\n"
+"    exponent\n"
+"n : int\n"
+"    number of terms (default: len(a))\n"
+"mod : int\n"
+"    prime modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"g : list[int]\n"
+"    coefficients of f^k  (mod x^n)\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= k < 2^63\n"
+"mod is prime and (mod - 1) is divisible by 2 * bit_ceil(n)\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nlogn + log(k))"
+);
+
+#define ACL_PYTHON_FPS_POW_METHODDEF \
+    {"fps_pow", (PyCFunction)fps_pow, METH_VARARGS | METH_KEYWORDS, fps_pow_doc},
+
+
+static PyObject *
+fps_divmod(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"b", (char *)"mod", NULL};
+    PyObject *a_obj, *b_obj;
+    long long mod = 998244353;
+    std::vector<unsigned int> a, b, q, r;
+    int n, m;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|L", kwlist, &a_obj, &b_obj, &mod)) return NULL;
+    if (fps_parse_args(a_obj, NULL, mod, a, n)) return NULL;
+    if (fps_parse_args(b_obj, NULL, mod, b, m)) return NULL;
+    if (fps_check_length(mod, n + m)) return NULL;
+    if (std::all_of(b.begin(), b.end(), [](unsigned int v) { return v == 0; })) {
+        PyErr_SetString(PyExc_ZeroDivisionError, "polynomial division by zero");
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    internal::fps_divmod_impl(a, b, (unsigned int)mod, q, r);
+    Py_END_ALLOW_THREADS
+    PyObject *q_obj = _PyList_FromVector(q);
+    if (!q_obj) return NULL;
+    PyObject *r_obj = _PyList_FromVector(r);
+    if (!r_obj) {
+        Py_DECREF(q_obj);
+        return NULL;
+    }
+    return Py_BuildValue("(NN)", q_obj, r_obj);
+}
+
+PyDoc_STRVAR(fps_divmod_doc,
+"fps_divmod($module, a, b, mod=998244353)\n"
+"--\n\n"
+"Polynomial division with remainder in mod `mod`.\n"
+"It returns (q, r) s.t. A = B * Q + R and deg(R) < deg(B), where\n"
+"A = a[0] + a[1] x + ... and so on.\n"
+"q and r have no trailing zeros (the zero polynomial is []).\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int] | buffer of integers\n"
+"    coefficients of the dividend\n"
+"b : list[int] | buffer of integers\n"
+"    coefficients of the divisor\n"
+"mod : int\n"
+"    prime modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : tuple[list[int], list[int]]\n"
+"    quotient and remainder\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"B != 0\n"
+"mod is prime and (mod - 1) is divisible by 2 * bit_ceil(len(a) + len(b))\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F((n + m)log(n + m))  (n = len(a), m = len(b))"
+);
+
+#define ACL_PYTHON_FPS_DIVMOD_METHODDEF \
+    {"fps_divmod", (PyCFunction)fps_divmod, METH_VARARGS | METH_KEYWORDS, fps_divmod_doc},
+
+
+static PyObject *
+multipoint_eval(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"xs", (char *)"mod", NULL};
+    PyObject *a_obj, *x_obj;
+    long long mod = 998244353;
+    std::vector<unsigned int> a, x, r;
+    int m, n;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|L", kwlist, &a_obj, &x_obj, &mod)) return NULL;
+    if (fps_parse_args(a_obj, NULL, mod, a, m)) return NULL;
+    if (fps_parse_args(x_obj, NULL, mod, x, n)) return NULL;
+    if (fps_check_length(mod, std::max(m, n))) return NULL;
+    if (n == 0) return PyList_New(0);
+    Py_BEGIN_ALLOW_THREADS
+    internal::subproduct_tree t;
+    internal::subproduct_build(t, x, (unsigned int)mod);
+    r = internal::subproduct_evaluate(t, a);
+    Py_END_ALLOW_THREADS
+    return _PyList_FromVector(r);
+}
+
+PyDoc_STRVAR(multipoint_eval_doc,
+"multipoint_eval($module, a, xs, mod=998244353)\n"
+"--\n\n"
+"It returns [f(x) for x in xs] in mod `mod`, where\n"
+"f = a[0] + a[1] x + ... + a[m-1] x^(m-1).\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int] | buffer of integers\n"
+"    coefficients of f\n"
+"xs : list[int] | buffer of integers\n"
+"    points\n"
+"mod : int\n"
+"    prime modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"ys : list[int]\n"
+"    ys[i] = f(xs[i])\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"mod is prime and (mod - 1) is divisible by 2 * bit_ceil(max(m, n))\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(mlogm + n(logn)^2)  (m = len(a), n = len(xs))"
+);
+
+#define ACL_PYTHON_MULTIPOINT_EVAL_METHODDEF \
+    {"multipoint_eval", (PyCFunction)multipoint_eval, METH_VARARGS | METH_KEYWORDS, multipoint_eval_doc},
+
+
+static PyObject *
+interpolate(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"xs", (char *)"ys", (char *)"mod", NULL};
+    PyObject *x_obj, *y_obj;
+    long long mod = 998244353;
+    std::vector<unsigned int> x, y, r;
+    int n, n2;
+    bool ok;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|L", kwlist, &x_obj, &y_obj, &mod)) return NULL;
+    if (fps_parse_args(x_obj, NULL, mod, x, n)) return NULL;
+    if (fps_parse_args(y_obj, NULL, mod, y, n2)) return NULL;
+    if (n != n2) {
+        PyErr_SetString(PyExc_ValueError, "xs and ys must have the same length");
+        return NULL;
+    }
+    if (fps_check_length(mod, n)) return NULL;
+    if (n == 0) return PyList_New(0);
+    Py_BEGIN_ALLOW_THREADS
+    internal::subproduct_tree t;
+    internal::subproduct_build(t, x, (unsigned int)mod);
+    ok = internal::subproduct_interpolate(t, y, r);
+    Py_END_ALLOW_THREADS
+    if (!ok) {
+        PyErr_SetString(PyExc_ValueError, "xs must be pairwise distinct");
+        return NULL;
+    }
+    return _PyList_FromVector(r);
+}
+
+PyDoc_STRVAR(interpolate_doc,
+"interpolate($module, xs, ys, mod=998244353)\n"
+"--\n\n"
+"It returns the coefficients of the unique polynomial f of degree < n\n"
+"with f(xs[i]) = ys[i] in mod `mod`.\n\n"
+"Parameters\n"
+"----------\n"
+"xs : list[int] | buffer of integers\n"
+"    points\n"
+"ys : list[int] | buffer of integers\n"
+"    values\n"
+"mod : int\n"
+"    prime modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"a : list[int]\n"
+"    f = a[0] + a[1] x + ... + a[n-1] x^(n-1)\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"len(xs) == len(ys)\n"
+"xs are pairwise distinct in mod `mod`\n"
+"mod is prime and (mod - 1) is divisible by 2 * bit_ceil(n)\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n(logn)^2)"
+);
+
+#define ACL_PYTHON_INTERPOLATE_METHODDEF \
+    {"interpolate", (PyCFunction)interpolate, METH_VARARGS | METH_KEYWORDS, interpolate_doc},
+
+
+PyMethodDef fpsfunctions[] = {
+    ACL_PYTHON_FPS_INV_METHODDEF
+    ACL_PYTHON_FPS_LOG_METHODDEF
+    ACL_PYTHON_FPS_EXP_METHODDEF
+    ACL_PYTHON_FPS_SQRT_METHODDEF
+    ACL_PYTHON_FPS_POW_METHODDEF
+    ACL_PYTHON_FPS_DIVMOD_METHODDEF
+    ACL_PYTHON_MULTIPOINT_EVAL_METHODDEF
+    ACL_PYTHON_INTERPOLATE_METHODDEF
+    {NULL} /* Sentinel */
+};
+
+
+} // namespace atcoder_python
+
+#endif  // ACL_PYTHON_FPS
@@ -0,0 +1,34 @@
+#ifndef ACL_PYTHON_INTERNAL_BIT
+#define ACL_PYTHON_INTERNAL_BIT
+
+
+// reference: https://github.com/atcoder/ac-library/blob/master/atcoder/internal_bit.hpp
+
+
+
+namespace atcoder_python {
+namespace internal {
+
+
+// @param n `0 <= n`
+// @return minimum non-negative `x` s.t. `n <= 2**x`
+static int
+ceil_pow2(int n) {
+    int x = 0;
+    while ((1U << x) < (unsigned int)(n)) x++;
+    return x;
+}
+
+// @param n `1 <= n`
+// @return minimum non-negative `x` s.t. `(n & (1 << x)) != 0`
+static int
+bsf(unsigned int n) {
+    return __builtin_ctz(n);
+}
+
+
+} // namespace internal
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_INTERNAL_BIT
@@ -0,0 +1,411 @@
+#ifndef ACL_PYTHON_INTERNAL_BITSET
+#define ACL_PYTHON_INTERNAL_BITSET
+
+#include <algorithm>
+#include <cstring>
+
+#include "atcoder/internal_cpu"
+
+
+
+namespace atcoder_python {
+namespace internal {
+
+
+/* Word kernels for the packed bit containers.
+
+    Every kernel works on arrays of m 64-bit words and comes in a scalar
+    version and vector versions for AVX2 and AVX-512. bitset_select_kernel()
+    fills bitset_kernels with the best ones for the CPU.
+
+    and_/or_/xor_/andnot_  dst[i] op= src[i]
+    popcount               number of set bits
+    shl                    dst[i] = src[i - rot] << sft | src[i - rot - 1] >> (64 - sft)
+                           for rot <= i < m (missing words read as 0)
+    shr                    dst[i] = src[i + rot] >> sft | src[i + rot + 1] << (64 - sft)
+                           for 0 <= i < m - rot (missing words read as 0)
+    shl_or/shl_and ...     the same with dst[i] |= ... / dst[i] &= ... (the
+                           fused `bs |= bs << k` of the subset-sum DP)
+
+    The left shifts walk down and the right shifts walk up, so a word of
+    src is read before it is written when dst == src: they all work in
+    place in one pass. The words they do not write are left to the caller.
+*/
+
+
+typedef void (*bitset_binop_t)(unsigned long long *dst, const unsigned long long *src, int m);
+typedef long long (*bitset_popcount_t)(const unsigned long long *src, int m);
+typedef void (*bitset_shift_t)(unsigned long long *dst, const unsigned long long *src, int m,
+                               int rot, int sft);
+
+struct bitset_kernel_table {
+    bitset_binop_t and_;
+    bitset_binop_t or_;
+    bitset_binop_t xor_;
+    bitset_binop_t andnot_;
+    bitset_popcount_t popcount;
+    bitset_shift_t shl;
+    bitset_shift_t shr;
+    bitset_shift_t shl_or;
+    bitset_shift_t shr_or;
+    bitset_shift_t shl_and;
+    bitset_shift_t shr_and;
+};
+
+
+/* scalar  *************************************************/
+
+#define BITSET_SCALAR_BINOP(name, op)                                                   \
+    static void                                                                       \
+    bitset_##name##_scalar(unsigned long long *dst, const unsigned long long *src, int m) { \
+        for (int i = 0; i < m; i++) dst[i] = dst[i] op src[i];                         \
+    }
+
+BITSET_SCALAR_BINOP(and, &)
+BITSET_SCALAR_BINOP(or, |)
+BITSET_SCALAR_BINOP(xor, ^)
+BITSET_SCALAR_BINOP(andnot, & ~)
+
+static long long
+bitset_popcount_scalar(const unsigned long long *src, int m) {
+    long long cnt = 0;
+    for (int i = 0; i < m; i++) cnt += __builtin_popcountll(src[i]);
+    return cnt;
+}
+
+#define BITSET_SCALAR_SHIFTS(suffix, combine)                                           \
+    static void                                                                       \
+    bitset_shl##suffix##_scalar(unsigned long long *dst, const unsigned long long *src, int m, \
+                                int rot, int sft) {                                   \
+        if (rot >= m) return;                                                         \
+        if (sft == 0) {                                                               \
+            for (int i = m - 1; i >= rot; i--) dst[i] = combine(dst[i], src[i - rot]); \
+            return;                                                                   \
+        }                                                                             \
+        for (int i = m - 1; i > rot; i--) {                                           \
+            dst[i] = combine(dst[i], src[i - rot] << sft | src[i - rot - 1] >> (64 - sft)); \
+        }                                                                             \
+        dst[rot] = combine(dst[rot], src[0] << sft);                                  \
+    }                                                                                 \
+    static void                                                                       \
+    bitset_shr##suffix##_scalar(unsigned long long *dst, const unsigned long long *src, int m, \
+                                int rot, int sft) {                                   \
+        if (rot >= m) return;                                                         \
+        if (sft == 0) {                                                               \
+            for (int i = 0; i < m - rot; i++) dst[i] = combine(dst[i], src[i + rot]);  \
+            return;                                                                   \
+        }                                                                             \
+        for (int i = 0; i < m - rot - 1; i++) {                                       \
+            dst[i] = combine(dst[i], src[i + rot] >> sft | src[i + rot + 1] << (64 - sft)); \
+        }                                                                             \
+        dst[m - rot - 1] = combine(dst[m - rot - 1], src[m - 1] >> sft);              \
+    }
+
+#define BITSET_COMBINE_SET(d, v) (v)
+#define BITSET_COMBINE_OR(d, v) ((d) | (v))
+#define BITSET_COMBINE_AND(d, v) ((d) & (v))
+
+BITSET_SCALAR_SHIFTS(, BITSET_COMBINE_SET)
+BITSET_SCALAR_SHIFTS(_or, BITSET_COMBINE_OR)
+BITSET_SCALAR_SHIFTS(_and, BITSET_COMBINE_AND)
+
+
+#ifdef ACL_PYTHON_X86_SIMD
+
+/* the same loop with the popcnt instruction instead of the libgcc call */
+ACL_PYTHON_TARGET_POPCNT static long long
+bitset_popcount_popcnt(const unsigned long long *src, int m) {
+    long long cnt = 0;
+    for (int i = 0; i < m; i++) cnt += __builtin_popcountll(src[i]);
+    return cnt;
+}
+
+
+/* AVX2  ***************************************************/
+
+#define BITSET_AVX2_BINOP(name, expr)                                                   \
+    ACL_PYTHON_TARGET_AVX2 static void                                                \
+    bitset_##name##_avx2(unsigned long long *dst, const unsigned long long *src, int m) { \
+        int i = 0;                                                                    \
+        for (; i + 8 <= m; i += 8) {                                                  \
+            __m256i a0 = _mm256_loadu_si256((const __m256i *)(dst + i));              \
+            __m256i a1 = _mm256_loadu_si256((const __m256i *)(dst + i + 4));          \
+            __m256i b0 = _mm256_loadu_si256((const __m256i *)(src + i));              \
+            __m256i b1 = _mm256_loadu_si256((const __m256i *)(src + i + 4));          \
+            _mm256_storeu_si256((__m256i *)(dst + i), expr(a0, b0));                  \
+            _mm256_storeu_si256((__m256i *)(dst + i + 4), expr(a1, b1));              \
+        }                                                                             \
+        bitset_##name##_scalar(dst + i, src + i, m - i);                              \
+    }
+
+#define BITSET_AVX2_ANDNOT(a, b) _mm256_andnot_si256(b, a)
+
+BITSET_AVX2_BINOP(and, _mm256_and_si256)
+BITSET_AVX2_BINOP(or, _mm256_or_si256)
+BITSET_AVX2_BINOP(xor, _mm256_xor_si256)
+BITSET_AVX2_BINOP(andnot, BITSET_AVX2_ANDNOT)
+
+/* per-64-bit-lane popcount by the nibble lookup (Mula) */
+ACL_PYTHON_TARGET_AVX2 static inline __m256i
+bitset_popcount256(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, low);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+    __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(c, _mm256_setzero_si256());
+}
+
+/* carry-save adder: (h, l) = a + b + c */
+ACL_PYTHON_TARGET_AVX2 static inline void
+bitset_csa256(__m256i &h, __m256i &l, __m256i a, __m256i b, __m256i c) {
+    __m256i u = _mm256_xor_si256(a, b);
+    h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+    l = _mm256_xor_si256(u, c);
+}
+
+/* Harley-Seal: 16 vectors are folded by carry-save adders into
+   ones/twos/fours/eights, and only the sixteens are counted */
+ACL_PYTHON_TARGET_AVX2 static long long
+bitset_popcount_avx2(const unsigned long long *src, int m) {
+    const __m256i *d = (const __m256i *)src;
+    int v = m / 4;
+    __m256i total = _mm256_setzero_si256();
+    __m256i ones = _mm256_setzero_si256(), twos = ones, fours = ones, eights = ones, sixteens;
+    __m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+    int i = 0;
+    for (; i + 16 <= v; i += 16) {
+        bitset_csa256(twos_a, ones, ones, _mm256_loadu_si256(d + i), _mm256_loadu_si256(d + i + 1));
+        bitset_csa256(twos_b, ones, ones, _mm256_loadu_si256(d + i + 2), _mm256_loadu_si256(d + i + 3));
+        bitset_csa256(fours_a, twos, twos, twos_a, twos_b);
+        bitset_csa256(twos_a, ones, ones, _mm256_loadu_si256(d + i + 4), _mm256_loadu_si256(d + i + 5));
+        bitset_csa256(twos_b, ones, ones, _mm256_loadu_si256(d + i + 6), _mm256_loadu_si256(d + i + 7));
+        bitset_csa256(fours_b, twos, twos, twos_a, twos_b);
+        bitset_csa256(eights_a, fours, fours, fours_a, fours_b);
+        bitset_csa256(twos_a, ones, ones, _mm256_loadu_si256(d + i + 8), _mm256_loadu_si256(d + i + 9));
+        bitset_csa256(twos_b, ones, ones, _mm256_loadu_si256(d + i + 10), _mm256_loadu_si256(d + i + 11));
+        bitset_csa256(fours_a, twos, twos, twos_a, twos_b);
+        bitset_csa256(twos_a, ones, ones, _mm256_loadu_si256(d + i + 12), _mm256_loadu_si256(d + i + 13));
+        bitset_csa256(twos_b, ones, ones, _mm256_loadu_si256(d + i + 14), _mm256_loadu_si256(d + i + 15));
+        bitset_csa256(fours_b, twos, twos, twos_a, twos_b);
+        bitset_csa256(eights_b, fours, fours, fours_a, fours_b);
+        bitset_csa256(sixteens, eights, eights, eights_a, eights_b);
+        total = _mm256_add_epi64(total, bitset_popcount256(sixteens));
+    }
+    total = _mm256_slli_epi64(total, 4);
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(bitset_popcount256(eights), 3));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(bitset_popcount256(fours), 2));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(bitset_popcount256(twos), 1));
+    total = _mm256_add_epi64(total, bitset_popcount256(ones));
+    for (; i < v; i++) total = _mm256_add_epi64(total, bitset_popcount256(_mm256_loadu_si256(d + i)));
+    unsigned long long lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    long long cnt = (long long)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    for (int j = 4 * v; j < m; j++) cnt += __builtin_popcountll(src[j]);
+    return cnt;
+}
+
+/* vector shifts by 64 give 0, so sft == 0 needs no special case */
+#define BITSET_AVX2_SHIFTS(suffix, combine)                                             \
+    ACL_PYTHON_TARGET_AVX2 static void                                                \
+    bitset_shl##suffix##_avx2(unsigned long long *dst, const unsigned long long *src, int m, \
+                              int rot, int sft) {                                     \
+        __m128i cl = _mm_cvtsi32_si128(sft), cr = _mm_cvtsi32_si128(64 - sft);        \
+        int i = m - 4;                                                                \
+        /* the block [i, i + 4) reads src[i - rot - 1, i - rot + 4) */                \
+        for (; i - rot - 1 >= 0; i -= 4) {                                            \
+            __m256i a = _mm256_loadu_si256((const __m256i *)(src + i - rot));         \
+            __m256i b = _mm256_loadu_si256((const __m256i *)(src + i - rot - 1));     \
+            __m256i v = _mm256_or_si256(_mm256_sll_epi64(a, cl), _mm256_srl_epi64(b, cr)); \
+            _mm256_storeu_si256((__m256i *)(dst + i),                                 \
+                                combine(_mm256_loadu_si256((const __m256i *)(dst + i)), v)); \
+        }                                                                             \
+        bitset_shl##suffix##_scalar(dst, src, std::min(m, i + 4), rot, sft);          \
+    }                                                                                 \
+    ACL_PYTHON_TARGET_AVX2 static void                                                \
+    bitset_shr##suffix##_avx2(unsigned long long *dst, const unsigned long long *src, int m, \
+                              int rot, int sft) {                                     \
+        __m128i cl = _mm_cvtsi32_si128(64 - sft), cr = _mm_cvtsi32_si128(sft);        \
+        int i = 0;                                                                    \
+        /* the block [i, i + 4) reads src[i + rot, i + rot + 5) */                    \
+        for (; i + rot + 5 <= m; i += 4) {                                            \
+            __m256i a = _mm256_loadu_si256((const __m256i *)(src + i + rot));         \
+            __m256i b = _mm256_loadu_si256((const __m256i *)(src + i + rot + 1));     \
+            __m256i v = _mm256_or_si256(_mm256_srl_epi64(a, cr), _mm256_sll_epi64(b, cl)); \
+            _mm256_storeu_si256((__m256i *)(dst + i),                                 \
+                                combine(_mm256_loadu_si256((const __m256i *)(dst + i)), v)); \
+        }                                                                             \
+        bitset_shr##suffix##_scalar(dst + i, src + i, m - i, rot, sft);               \
+    }
+
+BITSET_AVX2_SHIFTS(, BITSET_COMBINE_SET)
+BITSET_AVX2_SHIFTS(_or, _mm256_or_si256)
+BITSET_AVX2_SHIFTS(_and, _mm256_and_si256)
+
+
+/* AVX-512  ************************************************/
+
+ACL_PYTHON_AVX512_BEGIN
+
+#define BITSET_AVX512_BINOP(name, expr)                                                 \
+    ACL_PYTHON_TARGET_AVX512 static void                                              \
+    bitset_##name##_avx512(unsigned long long *dst, const unsigned long long *src, int m) { \
+        int i = 0;                                                                    \
+        for (; i + 16 <= m; i += 16) {                                                \
+            __m512i a0 = _mm512_loadu_si512((const void *)(dst + i));                 \
+            __m512i a1 = _mm512_loadu_si512((const void *)(dst + i + 8));             \
+            __m512i b0 = _mm512_loadu_si512((const void *)(src + i));                 \
+            __m512i b1 = _mm512_loadu_si512((const void *)(src + i + 8));             \
+            _mm512_storeu_si512((void *)(dst + i), expr(a0, b0));                     \
+            _mm512_storeu_si512((void *)(dst + i + 8), expr(a1, b1));                 \
+        }                                                                             \
+        bitset_##name##_scalar(dst + i, src + i, m - i);                              \
+    }
+
+#define BITSET_AVX512_ANDNOT(a, b) _mm512_andnot_si512(b, a)
+
+BITSET_AVX512_BINOP(and, _mm512_and_si512)
+BITSET_AVX512_BINOP(or, _mm512_or_si512)
+BITSET_AVX512_BINOP(xor, _mm512_xor_si512)
+BITSET_AVX512_BINOP(andnot, BITSET_AVX512_ANDNOT)
+
+ACL_PYTHON_TARGET_AVX512_VPOPCNT static long long
+bitset_popcount_avx512(const unsigned long long *src, int m) {
+    __m512i t0 = _mm512_setzero_si512(), t1 = _mm512_setzero_si512();
+    int i = 0;
+    for (; i + 16 <= m; i += 16) {
+        t0 = _mm512_add_epi64(t0, _mm512_popcnt_epi64(_mm512_loadu_si512((const void *)(src + i))));
+        t1 = _mm512_add_epi64(t1, _mm512_popcnt_epi64(_mm512_loadu_si512((const void *)(src + i + 8))));
+    }
+    if (i < m) {
+        __mmask8 k = (__mmask8)((1u << std::min(8, m - i)) - 1);
+        t0 = _mm512_add_epi64(t0, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(k, src + i)));
+        i += 8;
+    }
+    if (i < m) {
+        __mmask8 k = (__mmask8)((1u << (m - i)) - 1);
+        t1 = _mm512_add_epi64(t1, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(k, src + i)));
+    }
+    unsigned long long lanes[8];
+    _mm512_storeu_si512((void *)lanes, _mm512_add_epi64(t0, t1));
+    long long cnt = 0;
+    for (int j = 0; j < 8; j++) cnt += (long long)lanes[j];
+    return cnt;
+}
+
+#define BITSET_AVX512_SHIFTS(suffix, combine)                                           \
+    ACL_PYTHON_TARGET_AVX512 static void                                              \
+    bitset_shl##suffix##_avx512(unsigned long long *dst, const unsigned long long *src, int m, \
+                                int rot, int sft) {                                   \
+        __m128i cl = _mm_cvtsi32_si128(sft), cr = _mm_cvtsi32_si128(64 - sft);        \
+        int i = m - 8;                                                                \
+        for (; i - rot - 1 >= 0; i -= 8) {                                            \
+            __m512i a = _mm512_loadu_si512((const void *)(src + i - rot));            \
+            __m512i b = _mm512_loadu_si512((const void *)(src + i - rot - 1));        \
+            __m512i v = _mm512_or_si512(_mm512_sll_epi64(a, cl), _mm512_srl_epi64(b, cr)); \
+            _mm512_storeu_si512((void *)(dst + i),                                    \
+                                combine(_mm512_loadu_si512((const void *)(dst + i)), v)); \
+        }                                                                             \
+        bitset_shl##suffix##_scalar(dst, src, std::min(m, i + 8), rot, sft);          \
+    }                                                                                 \
+    ACL_PYTHON_TARGET_AVX512 static void                                              \
+    bitset_shr##suffix##_avx512(unsigned long long *dst, const unsigned long long *src, int m, \
+                                int rot, int sft) {                                   \
+        __m128i cl = _mm_cvtsi32_si128(64 - sft), cr = _mm_cvtsi32_si128(sft);        \
+        int i = 0;                                                                    \
+        for (; i + rot + 9 <= m; i += 8) {                                            \
+            __m512i a = _mm512_loadu_si512((const void *)(src + i + rot));            \
+            __m512i b = _mm512_loadu_si512((const void *)(src + i + rot + 1));        \
+            __m512i v = _mm512_or_si512(_mm512_srl_epi64(a, cr), _mm512_sll_epi64(b, cl)); \
+            _mm512_storeu_si512((void *)(dst + i),                                    \
+                                combine(_mm512_loadu_si512((const void *)(dst + i)), v)); \
+        }                                                                             \
+        bitset_shr##suffix##_scalar(dst + i, src + i, m - i, rot, sft);               \
+    }
+
+BITSET_AVX512_SHIFTS(, BITSET_COMBINE_SET)
+BITSET_AVX512_SHIFTS(_or, _mm512_or_si512)
+BITSET_AVX512_SHIFTS(_and, _mm512_and_si512)
+
+ACL_PYTHON_AVX512_END
+
+#endif
+
+
+static bitset_kernel_table bitset_kernels = {
+    bitset_and_scalar, bitset_or_scalar, bitset_xor_scalar, bitset_andnot_scalar,
+    bitset_popcount_scalar, bitset_shl_scalar, bitset_shr_scalar,
+    bitset_shl_or_scalar, bitset_shr_or_scalar, bitset_shl_and_scalar, bitset_shr_and_scalar,
+};
+
+/* called once from PyInit_atcoder, after cpu_detect() */
+static void
+bitset_select_kernel() {
+    bitset_kernels = {
+        bitset_and_scalar, bitset_or_scalar, bitset_xor_scalar, bitset_andnot_scalar,
+        bitset_popcount_scalar, bitset_shl_scalar, bitset_shr_scalar,
+        bitset_shl_or_scalar, bitset_shr_or_scalar, bitset_shl_and_scalar, bitset_shr_and_scalar,
+    };
+#ifdef ACL_PYTHON_X86_SIMD
+    if (cpu.popcnt) bitset_kernels.popcount = bitset_popcount_popcnt;
+    if (cpu.avx2) {
+        bitset_kernels = {
+            bitset_and_avx2, bitset_or_avx2, bitset_xor_avx2, bitset_andnot_avx2,
+            bitset_popcount_avx2, bitset_shl_avx2, bitset_shr_avx2,
+            bitset_shl_or_avx2, bitset_shr_or_avx2, bitset_shl_and_avx2, bitset_shr_and_avx2,
+        };
+    }
+    if (cpu.avx2 && cpu.avx512f && cpu.avx512bw) {
+        bitset_kernels.and_ = bitset_and_avx512;
+        bitset_kernels.or_ = bitset_or_avx512;
+        bitset_kernels.xor_ = bitset_xor_avx512;
+        bitset_kernels.andnot_ = bitset_andnot_avx512;
+        bitset_kernels.shl = bitset_shl_avx512;
+        bitset_kernels.shr = bitset_shr_avx512;
+        bitset_kernels.shl_or = bitset_shl_or_avx512;
+        bitset_kernels.shr_or = bitset_shr_or_avx512;
+        bitset_kernels.shl_and = bitset_shl_and_avx512;
+        bitset_kernels.shr_and = bitset_shr_and_avx512;
+    }
+    if (cpu.avx512f && cpu.avx512vpopcntdq) bitset_kernels.popcount = bitset_popcount_avx512;
+#endif
+}
+
+
+/* The words [l, r) of a full shift (the words the kernel does not write
+   set to 0), dst != src. Disjoint ranges only read src, so they can run
+   concurrently: the kernel runs on the range alone and the one source
+   word across its boundary is added afterwards. */
+
+static void
+bitset_shl_range(unsigned long long *dst, const unsigned long long *src, int m, int rot, int sft,
+                 int l, int r) {
+    if (l < rot) {
+        std::fill(dst + l, dst + std::min(r, rot), 0);
+        l = rot;
+    }
+    if (l >= r) return;
+    int b = l - rot;
+    bitset_kernels.shl(dst + b, src + b, r - b, rot, sft);
+    if (b && sft) dst[l] |= src[b - 1] >> (64 - sft);
+}
+
+static void
+bitset_shr_range(unsigned long long *dst, const unsigned long long *src, int m, int rot, int sft,
+                 int l, int r) {
+    int e = std::min(r, m - rot);
+    if (l < e) {
+        bitset_kernels.shr(dst + l, src + l, e + rot - l, rot, sft);
+        if (e + rot < m && sft) dst[e - 1] |= src[e + rot] << (64 - sft);
+    }
+    l = std::max(l, m - rot);
+    if (l < r) std::fill(dst + l, dst + r, 0);
+}
+
+
+} // namespace internal
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_INTERNAL_BITSET
@@ -0,0 +1,72 @@
+#ifndef ACL_PYTHON_INTERNAL_CPU
+#define ACL_PYTHON_INTERNAL_CPU
+
+
+/* Runtime CPU feature detection for the SIMD kernels.
+
+    The extension is built for baseline x86-64. Every vector kernel is
+    compiled for its own instruction set with a per-function target
+    attribute (ACL_PYTHON_TARGET_*), and the module picks one of them when
+    it is imported, after cpu_detect() has read cpuid.
+
+    Define ACL_PYTHON_NO_SIMD to build the scalar kernels only.
+*/
+
+#if !defined(ACL_PYTHON_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__GNUC__) || defined(__clang__))
+#define ACL_PYTHON_X86_SIMD 1
+#include <immintrin.h>
+#define ACL_PYTHON_TARGET_AVX2 __attribute__((target("avx2")))
+#define ACL_PYTHON_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#define ACL_PYTHON_TARGET_POPCNT __attribute__((target("popcnt")))
+#define ACL_PYTHON_TARGET_AVX512_VPOPCNT __attribute__((target("avx512f,avx512vpopcntdq")))
+
+/* GCC 12 reports the _mm512_undefined_* vectors the AVX-512 intrinsics
+   start from as -Wmaybe-uninitialized once they are inlined; the AVX-512
+   kernels are put between these two to silence that false positive. */
+#if defined(__GNUC__) && !defined(__clang__)
+#define ACL_PYTHON_AVX512_BEGIN \
+    _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define ACL_PYTHON_AVX512_END _Pragma("GCC diagnostic pop")
+#else
+#define ACL_PYTHON_AVX512_BEGIN
+#define ACL_PYTHON_AVX512_END
+#endif
+#endif
+
+
+
+namespace atcoder_python {
+namespace internal {
+
+
+struct cpu_features {
+    bool avx2;
+    bool avx512f;
+    bool avx512bw;
+    bool popcnt;
+    bool avx512vpopcntdq;
+};
+
+[[maybe_unused]] static cpu_features cpu = {false, false, false, false, false};
+
+
+/* called once from PyInit_atcoder */
+static void
+cpu_detect() {
+#ifdef ACL_PYTHON_X86_SIMD
+    __builtin_cpu_init();
+    cpu.avx2 = __builtin_cpu_supports("avx2");
+    cpu.avx512f = __builtin_cpu_supports("avx512f");
+    cpu.avx512bw = __builtin_cpu_supports("avx512bw");
+    cpu.popcnt = __builtin_cpu_supports("popcnt");
+    cpu.avx512vpopcntdq = __builtin_cpu_supports("avx512vpopcntdq");
+#endif
+}
+
+
+} // namespace internal
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_INTERNAL_CPU
@@ -130,6 +130,259 @@ is_prime_constexpr(int n) {
 }
 
 
+// Compile time primitive root
+// @param m must be prime
+// @return primitive root (and minimum in now)
+constexpr int
+primitive_root_constexpr(int m) {
+    if (m == 2) return 1;
+    if (m == 167772161) return 3;
+    if (m == 469762049) return 3;
+    if (m == 754974721) return 11;
+    if (m == 998244353) return 3;
+    int divs[20] = {};
+    divs[0] = 2;
+    int cnt = 1;
+    int x = (m - 1) / 2;
+    while (x % 2 == 0) x /= 2;
+    for (int i = 3; (long long)(i)*i <= x; i += 2) {
+        if (x % i == 0) {
+            divs[cnt++] = i;
+            while (x % i == 0) {
+                x /= i;
+            }
+        }
+    }
+    if (x > 1) {
+        divs[cnt++] = x;
+    }
+    for (int g = 2;; g++) {
+        bool ok = true;
+        for (int i = 0; i < cnt; i++) {
+            if (pow_mod_constexpr(g, (m - 1) / divs[i], m) == 1) {
+                ok = false;
+                break;
+            }
+        }
+        if (ok) return g;
+    }
+}
+
+
+
+// Tonelli-Shanks
+// @param p must be prime
+// @return x s.t. 0 <= x < p and x * x == a (mod p), or -1 if there is none
+constexpr long long
+sqrt_mod_constexpr(long long a, int p) {
+    a = safe_mod(a, p);
+    if (a == 0 || p == 2) return a;
+    if (pow_mod_constexpr(a, (p - 1) / 2, p) != 1) return -1;
+    long long q = p - 1;
+    int s = 0;
+    while (q % 2 == 0) {
+        q /= 2;
+        s++;
+    }
+    long long z = 2;
+    while (pow_mod_constexpr(z, (p - 1) / 2, p) == 1) z++;
+    long long c = pow_mod_constexpr(z, q, p);
+    long long t = pow_mod_constexpr(a, q, p);
+    long long x = pow_mod_constexpr(a, (q + 1) / 2, p);
+    while (t != 1) {
+        // the least i with t^(2^i) == 1
+        int i = 0;
+        long long u = t;
+        while (u != 1) {
+            u = u * u % p;
+            i++;
+        }
+        long long b = c;
+        for (int j = 0; j < s - i - 1; j++) b = b * b % p;
+        x = x * b % p;
+        c = b * b % p;
+        t = t * c % p;
+        s = i;
+    }
+    return x;
+}
+
+
+// Montgomery multiplication for an odd modulus m < 2^64, R = 2^64.
+// The values in Montgomery form are kept in [0, m).
+struct montgomery64 {
+    unsigned long long m, inv, r2;  // inv = m^{-1} mod R, r2 = R^2 mod m
+
+    explicit montgomery64(unsigned long long m) : m(m) {
+        inv = m;
+        for (int i = 0; i < 5; i++) inv *= 2 - m * inv;
+        unsigned long long r1 = (0 - m) % m;
+        r2 = (unsigned long long)((unsigned __int128)r1 * r1 % m);
+    }
+
+    // t < m R  ->  t / R mod m
+    unsigned long long reduce(unsigned __int128 t) const {
+        unsigned long long q = (unsigned long long)t * inv;
+        unsigned long long h = (unsigned long long)(t >> 64);
+        unsigned long long mq = (unsigned long long)(((unsigned __int128)q * m) >> 64);
+        return h >= mq ? h - mq : h - mq + m;
+    }
+    unsigned long long mul(unsigned long long a, unsigned long long b) const {
+        return reduce((unsigned __int128)a * b);
+    }
+    unsigned long long to(unsigned long long a) const {
+        return mul(a % m, r2);
+    }
+    unsigned long long from(unsigned long long a) const {
+        return reduce(a);
+    }
+    unsigned long long pow(unsigned long long a, unsigned long long n) const {
+        unsigned long long r = to(1);
+        while (n) {
+            if (n & 1) r = mul(r, a);
+            a = mul(a, a);
+            n >>= 1;
+        }
+        return r;
+    }
+};
+
+
+// Deterministic Miller-Rabin for n < 2^64
+// (the 7 bases found by Jim Sinclair)
+inline bool
+is_prime_u64(unsigned long long n) {
+    if (n < 2) return false;
+    for (unsigned long long p : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+        if (n % p == 0) return n == p;
+    }
+    if (n < 37 * 37) return true;
+    montgomery64 mg(n);
+    unsigned long long d = n - 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+    unsigned long long one = mg.to(1), minus_one = mg.to(n - 1);
+    for (unsigned long long a : {2ULL, 325ULL, 9375ULL, 28178ULL, 450775ULL,
+                                 9780504ULL, 1795265022ULL}) {
+        if (a % n == 0) continue;
+        unsigned long long x = mg.pow(mg.to(a), d);
+        if (x == one || x == minus_one) continue;
+        int i = 1;
+        for (; i < s; i++) {
+            x = mg.mul(x, x);
+            if (x == minus_one) break;
+        }
+        if (i == s) return false;
+    }
+    return true;
+}
+
+
+// binary gcd, gcd(0, b) = b
+inline unsigned long long
+gcd_u64(unsigned long long a, unsigned long long b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    int k = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b) {
+        b >>= __builtin_ctzll(b);
+        if (a > b) std::swap(a, b);
+        b -= a;
+    }
+    return a << k;
+}
+
+
+// The odd primes below 2^10 with p^{-1} mod 2^64 and floor((2^64 - 1) / p):
+// p | n iff n * p^{-1} mod 2^64 <= floor((2^64 - 1) / p).
+struct small_prime {
+    unsigned long long p, inv, lim;
+};
+
+inline const std::vector<small_prime> &
+small_primes() {
+    static const std::vector<small_prime> table = [] {
+        std::vector<small_prime> t;
+        for (unsigned long long p = 3; p < (1 << 10); p += 2) {
+            bool prime = true;
+            for (unsigned long long d = 3; d * d <= p; d += 2) {
+                if (p % d == 0) prime = false;
+            }
+            if (!prime) continue;
+            unsigned long long inv = p;
+            for (int i = 0; i < 5; i++) inv *= 2 - p * inv;
+            t.push_back({p, inv, ~0ULL / p});
+        }
+        return t;
+    }();
+    return table;
+}
+
+
+// Pollard's rho with Brent's cycle detection in Montgomery form.
+// The differences are multiplied together and the gcd is taken once per
+// 128 steps; on overshoot the last batch is replayed one step at a time.
+// @param n must be an odd composite number
+// @return a non-trivial factor of n
+inline unsigned long long
+pollard_brent(unsigned long long n) {
+    const unsigned long long batch = 128;
+    montgomery64 mg(n);
+    for (unsigned long long c0 = 1;; c0++) {
+        unsigned long long c = mg.to(c0), nc = n - c;
+        auto f = [&](unsigned long long x) {
+            x = mg.mul(x, x);
+            return x >= nc ? x - nc : x + c;
+        };
+        unsigned long long x = 0, y = mg.to(2), ys = y, q = mg.to(1), g = 1;
+        for (unsigned long long r = 1; g == 1; r <<= 1) {
+            x = y;
+            for (unsigned long long i = 0; i < r; i++) y = f(y);
+            for (unsigned long long k = 0; k < r && g == 1; k += batch) {
+                ys = y;
+                for (unsigned long long i = 0; i < std::min(batch, r - k); i++) {
+                    y = f(y);
+                    q = mg.mul(q, x > y ? x - y : y - x);
+                }
+                g = gcd_u64(q, n);
+            }
+        }
+        if (g == n) {
+            do {
+                ys = f(ys);
+                g = gcd_u64(x > ys ? x - ys : ys - x, n);
+            } while (g == 1);
+        }
+        if (g != n) return g;
+    }
+}
+
+
+// prime factors of n (with multiplicity, in no particular order)
+inline void
+factorize_u64(unsigned long long n, std::vector<unsigned long long> &res) {
+    if (n <= 1) return;
+    int t = __builtin_ctzll(n);
+    res.insert(res.end(), t, 2);
+    n >>= t;
+    for (const small_prime &sp : small_primes()) {
+        if (sp.p * sp.p > n) break;
+        while (n * sp.inv <= sp.lim) {
+            res.push_back(sp.p);
+            n *= sp.inv;
+        }
+    }
+    if (n == 1) return;
+    if (n < (1ULL << 20) || is_prime_u64(n)) {
+        res.push_back(n);
+        return;
+    }
+    unsigned long long d = pollard_brent(n);
+    factorize_u64(d, res);
+    factorize_u64(n / d, res);
+}
+
 
 unsigned long long
 floor_sum_unsigned(unsigned long long n,
@@ -158,6 +411,96 @@ floor_sum_unsigned(unsigned long long n,
     return ans;
 }
 
+// floor_sum for any a, b (mod 2^64)
+// @param n `0 <= n`
+// @param m `1 <= m`
+unsigned long long
+floor_sum_signed(long long n, long long m, long long a, long long b) {
+    unsigned long long ans = 0;
+    if (a < 0) {
+        unsigned long long a2 = safe_mod(a, m);
+        ans -= 1ULL * n * (n - 1) / 2 * ((a2 - a) / m);
+        a = a2;
+    }
+    if (b < 0) {
+        unsigned long long b2 = safe_mod(b, m);
+        ans -= 1ULL * n * ((b2 - b) / m);
+        b = b2;
+    }
+    return ans + floor_sum_unsigned(n, m, a, b);
+}
+
+
+// "Universal" Euclidean algorithm: the path of the line y = (px + r) / q
+// for x = 1, ..., l is the word over {U, R} with an R at every x and a U
+// every time y crosses an integer. Folding the word in a monoid gives the
+// sums below without any division, so they are exact mod 2^64.
+struct floor_sum_node {
+    // #R, #U, sum(x), sum(y), sum(x * y), sum(y^2) over the R steps
+    unsigned long long x = 0, y = 0, sx = 0, sy = 0, sxy = 0, syy = 0;
+
+    friend floor_sum_node operator*(const floor_sum_node &a, const floor_sum_node &b) {
+        floor_sum_node c;
+        c.x = a.x + b.x;
+        c.y = a.y + b.y;
+        c.sx = a.sx + b.sx + a.x * b.x;
+        c.sy = a.sy + b.sy + a.y * b.x;
+        c.sxy = a.sxy + b.sxy + a.x * b.sy + a.y * b.sx + a.x * a.y * b.x;
+        c.syy = a.syy + b.syy + 2 * a.y * b.sy + a.y * a.y * b.x;
+        return c;
+    }
+};
+
+floor_sum_node
+floor_sum_node_pow(floor_sum_node a, unsigned long long k) {
+    floor_sum_node res;
+    while (k) {
+        if (k & 1) res = res * a;
+        a = a * a;
+        k >>= 1;
+    }
+    return res;
+}
+
+// @param 0 <= r < q
+floor_sum_node
+universal_euclid(unsigned long long p, unsigned long long q, unsigned long long r,
+                 unsigned long long l, floor_sum_node u, floor_sum_node rr) {
+    if (l == 0) return floor_sum_node();
+    if (p >= q) return universal_euclid(p % q, q, r, l, u, floor_sum_node_pow(u, p / q) * rr);
+    unsigned long long m = (unsigned long long)(((unsigned __int128)l * p + r) / q);
+    if (m == 0) return floor_sum_node_pow(rr, l);
+    unsigned long long cnt = l - (unsigned long long)(((unsigned __int128)q * m - r - 1) / p);
+    return floor_sum_node_pow(rr, (q - r - 1) / p) * u *
+           universal_euclid(q, p, (q - r - 1) % p, m - 1, rr, u) * floor_sum_node_pow(rr, cnt);
+}
+
+// sum(f(i)), sum(i * f(i)) and sum(f(i)^2) for f(i) = floor((a * i + b) / m),
+// 0 <= i < n (mod 2^64)
+// @param n `0 <= n < 2^32`
+// @param m `1 <= m < 2^32`
+std::tuple<unsigned long long, unsigned long long, unsigned long long>
+floor_sum_ex_signed(long long n, long long m, long long a, long long b) {
+    if (n == 0) return {0, 0, 0};
+    // f(i) = g(i) + qa * i + qb with g(i) = floor((ra * i + rb) / m)
+    unsigned long long ra = safe_mod(a, m), rb = safe_mod(b, m);
+    unsigned long long qa = (unsigned long long)(a / m - (a % m < 0));
+    unsigned long long qb = (unsigned long long)(b / m - (b % m < 0));
+    // g(0) = 0, so the path over x = 1, ..., n - 1 gives the sums of g
+    floor_sum_node u, r;
+    u.y = 1;
+    r.x = r.sx = 1;
+    floor_sum_node g = universal_euclid(ra, m, rb, n - 1, u, r);
+    unsigned long long un = n;
+    unsigned long long s1 = (unsigned long long)((unsigned __int128)un * (un - 1) / 2);
+    unsigned long long s2 = (unsigned long long)((unsigned __int128)un * (un - 1) * (2 * un - 1) / 6);
+    unsigned long long f = g.sy + qa * s1 + qb * un;
+    unsigned long long fi = g.sxy + qa * s2 + qb * s1;
+    unsigned long long ff = g.syy + qa * qa * s2 + qb * qb * un + 2 * qa * g.sxy + 2 * qb * g.sy +
+                            2 * qa * qb * s1;
+    return {f, fi, ff};
+}
+
 
 } // namespace atcoder_python
 
@@ -0,0 +1,168 @@
+#ifndef ACL_PYTHON_INTERNAL_RANKSELECT
+#define ACL_PYTHON_INTERNAL_RANKSELECT
+
+#include <algorithm>
+#include <vector>
+
+
+
+namespace atcoder_python {
+namespace internal {
+
+
+/* Rank/select directory over a packed bit vector (bit i in word i >> 6 at
+    position i & 63). The words are not copied: the index keeps a pointer
+    to them, and the caller keeps them alive and unmoved.
+
+    Rank is two-level: one 64-bit count of the ones before every
+    superblock of 2^16 bits, and one 16-bit count from the superblock
+    start to every block of 8 words (512 bits). rank1(i) reads both and
+    adds the ones of at most 8 words of the block, which share a cache
+    line and are summed bytewise with a single final multiply. The
+    directory costs 16 bits per 512 plus 64 per 2^16, about 3.2% of n, and
+    the select samples at most another 32 bits per RANK_SELECT_SAMPLE bits.
+    This is a constant fraction rather than o(n): the o(n) constructions
+    only win for much larger n and pay for it with more indirections per
+    query, while rank9 (one more 64-bit word per block, so one popcount per
+    rank) costs 25%.
+
+    Select keeps the block of every RANK_SELECT_SAMPLE-th one (and zero),
+    binary searches the blocks between two samples, scans the words of the
+    block and finds the bit inside the word from byte prefix counts.
+
+    If the words change after build, the answers are unspecified but every
+    read stays within the m words and every query terminates.
+*/
+
+#define RANK_SELECT_SAMPLE 4096
+#define RANK_SELECT_SUPER_SHIFT 7   // blocks per superblock: 2^7 x 512 = 2^16 bits
+
+/* byte j: number of ones in byte j of x (at most 8, so the byte vectors
+   of up to 31 words can be added before the bytes overflow) */
+static inline unsigned long long
+popcount_bytes(unsigned long long x) {
+    x = x - (x >> 1 & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + (x >> 2 & 0x3333333333333333ULL);
+    return (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+}
+
+/* the sum of the bytes of s, through 16-bit lanes so that it may exceed 255 */
+static inline int
+sum_bytes(unsigned long long s) {
+    s = (s & 0x00ff00ff00ff00ffULL) + (s >> 8 & 0x00ff00ff00ff00ffULL);
+    return (int)(s * 0x0001000100010001ULL >> 48);
+}
+
+/* position of the k-th (0-indexed) set bit of x; k < popcount(x)
+   (otherwise some position in [0, 64)) */
+static inline int
+select_in_word(unsigned long long x, int k) {
+    unsigned long long s = popcount_bytes(x) * 0x0101010101010101ULL;  // byte j: ones in bytes 0..j
+    int byte = 0;
+    while (byte < 7 && (int)(s >> (8 * byte) & 255) <= k) byte++;
+    if (byte) k -= (int)(s >> (8 * byte - 8) & 255);
+    unsigned int b = (unsigned int)(x >> (8 * byte) & 255);
+    for (; k > 0 && b; k--) b &= b - 1;
+    return 8 * byte + (b ? __builtin_ctz(b) : 0);
+}
+
+struct rank_select_index {
+    long long n = 0;
+    long long ones = 0;
+    long long m = 0;                          // number of words
+    const unsigned long long *words = nullptr;
+    std::vector<unsigned long long> super;    // ones before every superblock
+    std::vector<unsigned short> rel;          // ones from the superblock start to every block
+    std::vector<int> sample1, sample0;        // block of the k * RANK_SELECT_SAMPLE-th one / zero
+
+    /* word i, 0 past the end (the last block may be partial) */
+    inline unsigned long long word(long long i) const {
+        return i < m ? words[i] : 0;
+    }
+
+    void build(const unsigned long long *src, long long n_) {
+        n = n_;
+        m = (n + 63) >> 6;
+        words = src;
+        long long blocks = (m + 7) >> 3;
+        super.assign((blocks >> RANK_SELECT_SUPER_SHIFT) + 1, 0);
+        rel.assign(blocks + 1, 0);
+        sample1.clear();
+        sample0.clear();
+        long long cnt = 0;
+        for (long long b = 0; b <= blocks; b++) {
+            if (!(b & ((1 << RANK_SELECT_SUPER_SHIFT) - 1))) super[b >> RANK_SELECT_SUPER_SHIFT] = cnt;
+            rel[b] = (unsigned short)(cnt - (long long)super[b >> RANK_SELECT_SUPER_SHIFT]);
+            unsigned long long s = 0;
+            for (int j = 0; j < 8 && b < blocks; j++) s += popcount_bytes(word(8 * b + j));
+            cnt += sum_bytes(s);
+        }
+        ones = cnt;
+        for (long long b = 0, next1 = 0, next0 = 0; b < blocks; b++) {
+            long long c1 = block_rank(b + 1), c0 = std::min(512 * (b + 1), n) - c1;
+            for (; next1 < c1; next1 += RANK_SELECT_SAMPLE) sample1.push_back((int)b);
+            for (; next0 < c0; next0 += RANK_SELECT_SAMPLE) sample0.push_back((int)b);
+        }
+        sample1.push_back((int)blocks);
+        sample0.push_back((int)blocks);
+    }
+
+    /* number of ones before block b, 0 <= b <= blocks */
+    inline long long block_rank(long long b) const {
+        return (long long)super[b >> RANK_SELECT_SUPER_SHIFT] + rel[b];
+    }
+
+    /* number of ones in [0, i), 0 <= i <= n */
+    inline long long rank1(long long i) const {
+        long long wi = i >> 6;
+        unsigned long long s = 0;
+        for (long long j = wi & ~7LL; j < wi; j++) s += popcount_bytes(words[j]);
+        if (i & 63) s += popcount_bytes(words[wi] & ((1ULL << (i & 63)) - 1));
+        return block_rank(wi >> 3) + sum_bytes(s);
+    }
+
+    /* position of the k-th one (0-indexed), 0 <= k < ones */
+    long long select1(long long k) const {
+        long long lo = sample1[k / RANK_SELECT_SAMPLE], hi = sample1[k / RANK_SELECT_SAMPLE + 1] + 1;
+        // the last block b in [lo, hi) with block_rank(b) <= k
+        while (hi - lo > 1) {
+            long long mid = (lo + hi) >> 1;
+            if (block_rank(mid) <= k) lo = mid;
+            else hi = mid;
+        }
+        k -= block_rank(lo);
+        int w = 0;
+        for (; w < 7; w++) {
+            int c = sum_bytes(popcount_bytes(word(8 * lo + w)));
+            if (c > k) break;
+            k -= c;
+        }
+        return 512 * lo + 64 * w + select_in_word(word(8 * lo + w), (int)k);
+    }
+
+    /* position of the k-th zero (0-indexed), 0 <= k < n - ones */
+    long long select0(long long k) const {
+        long long lo = sample0[k / RANK_SELECT_SAMPLE], hi = sample0[k / RANK_SELECT_SAMPLE + 1] + 1;
+        while (hi - lo > 1) {
+            long long mid = (lo + hi) >> 1;
+            if (512 * mid - block_rank(mid) <= k) lo = mid;
+            else hi = mid;
+        }
+        k -= 512 * lo - block_rank(lo);
+        // the padding bits past n are 0 in words but never reached: k < n - ones
+        int w = 0;
+        for (; w < 7; w++) {
+            int c = 64 - sum_bytes(popcount_bytes(word(8 * lo + w)));
+            if (c > k) break;
+            k -= c;
+        }
+        return 512 * lo + 64 * w + select_in_word(~word(8 * lo + w), (int)k);
+    }
+};
+
+
+} // namespace internal
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_INTERNAL_RANKSELECT
@@ -0,0 +1,532 @@
+#ifndef ACL_PYTHON_INTERNAL_ROARING
+#define ACL_PYTHON_INTERNAL_ROARING
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "atcoder/internal_rankselect"
+
+
+
+namespace atcoder_python {
+namespace internal {
+
+
+/* Roaring bitmap over the 32-bit unsigned integers.
+
+    A value x goes to the container of key x >> 16 and is stored there as
+    the 16-bit x & 65535. The containers are kept sorted by key, and each
+    one is in one of three forms:
+
+        ARRAY   sorted values (at most ROARING_ARRAY_MAX of them)
+        BITMAP  ROARING_WORDS words, bit y in word y >> 6 as in BitSet
+        RUN     sorted disjoint runs as (first, last) pairs
+
+    Results of the set operations, of the bulk constructors and of
+    optimize() take the smallest of the three forms (2 bytes per value,
+    8 KiB, 4 bytes per run). Single insertions and deletions only move
+    between ARRAY and BITMAP at the ROARING_ARRAY_MAX boundary; a RUN
+    container that is changed is rebuilt.
+
+    Operations pair containers of equal keys. ARRAY with ARRAY is a merge,
+    AND / ANDNOT of an ARRAY with anything filters the array, and the
+    other pairs are done word by word on two expanded bitmaps.
+*/
+
+#define ROARING_ARRAY_MAX 4096
+#define ROARING_WORDS 1024
+
+enum roaring_op { ROARING_AND, ROARING_OR, ROARING_XOR, ROARING_ANDNOT };
+
+/* the first set (or clear, when flip = ~0) bit >= p of a container
+   bitmap, or 65536 */
+static inline int
+roaring_words_next(const unsigned long long *w, int p, unsigned long long flip = 0) {
+    if (p >= 65536) return 65536;
+    int i = p >> 6;
+    unsigned long long x = (w[i] ^ flip) & (~0ULL << (p & 63));
+    while (!x) {
+        if (++i == ROARING_WORDS) return 65536;
+        x = w[i] ^ flip;
+    }
+    return (i << 6) | __builtin_ctzll(x);
+}
+
+struct roaring_container {
+    enum : unsigned char { ARRAY, BITMAP, RUN };
+    unsigned char type = ARRAY;
+    int card = 0;
+    std::vector<unsigned short> v;         // ARRAY values, RUN (first, last) pairs
+    std::vector<unsigned long long> bits;  // BITMAP words
+
+    /* the container of the set bits of ROARING_WORDS words, in its
+       smallest form (card may be 0) */
+    static roaring_container from_words(const unsigned long long *w) {
+        roaring_container c;
+        int nruns = 0;
+        unsigned long long prev = 0;
+        for (int i = 0; i < ROARING_WORDS; i++) {
+            c.card += __builtin_popcountll(w[i]);
+            nruns += __builtin_popcountll(w[i] & ~(w[i] << 1 | prev));
+            prev = w[i] >> 63;
+        }
+        if (4 * nruns < std::min(2 * c.card, 8192)) {
+            c.type = RUN;
+            c.v.reserve(2 * nruns);
+            for (int p = roaring_words_next(w, 0); p < 65536;) {
+                int q = roaring_words_next(w, p, ~0ULL);
+                c.v.push_back((unsigned short)p);
+                c.v.push_back((unsigned short)(q - 1));
+                p = roaring_words_next(w, q);
+            }
+        } else if (c.card <= ROARING_ARRAY_MAX) {
+            c.type = ARRAY;
+            c.v.reserve(c.card);
+            for (int i = 0; i < ROARING_WORDS; i++) {
+                for (unsigned long long x = w[i]; x; x &= x - 1) {
+                    c.v.push_back((unsigned short)(i << 6 | __builtin_ctzll(x)));
+                }
+            }
+        } else {
+            c.type = BITMAP;
+            c.bits.assign(w, w + ROARING_WORDS);
+        }
+        return c;
+    }
+
+    /* the container of sorted distinct values, in its smallest form */
+    static roaring_container from_sorted(std::vector<unsigned short> &&a) {
+        roaring_container c;
+        c.card = (int)a.size();
+        int nruns = 0;
+        for (int i = 0; i < c.card; i++) nruns += !i || a[i] != a[i - 1] + 1;
+        if (4 * nruns < std::min(2 * c.card, 8192)) {
+            c.type = RUN;
+            c.v.reserve(2 * nruns);
+            for (int i = 0; i < c.card; i++) {
+                if (!i || a[i] != a[i - 1] + 1) {
+                    c.v.push_back(a[i]);
+                    c.v.push_back(a[i]);
+                } else {
+                    c.v.back() = a[i];
+                }
+            }
+        } else if (c.card <= ROARING_ARRAY_MAX) {
+            c.type = ARRAY;
+            c.v = std::move(a);
+        } else {
+            c.type = BITMAP;
+            c.bits.assign(ROARING_WORDS, 0);
+            for (unsigned short y : a) c.bits[y >> 6] |= 1ULL << (y & 63);
+        }
+        return c;
+    }
+
+    /* the values as a bitmap, written over w */
+    void to_words(unsigned long long *w) const {
+        if (type == BITMAP) {
+            std::copy(bits.begin(), bits.end(), w);
+            return;
+        }
+        std::fill(w, w + ROARING_WORDS, 0);
+        if (type == ARRAY) {
+            for (unsigned short y : v) w[y >> 6] |= 1ULL << (y & 63);
+            return;
+        }
+        for (size_t r = 0; r < v.size(); r += 2) {
+            int l = v[r], h = v[r + 1] + 1, lw = l >> 6, hw = (h - 1) >> 6;
+            unsigned long long lm = ~0ULL << (l & 63), hm = ~0ULL >> (63 - ((h - 1) & 63));
+            if (lw == hw) {
+                w[lw] |= lm & hm;
+            } else {
+                w[lw] |= lm;
+                std::fill(w + lw + 1, w + hw, ~0ULL);
+                w[hw] |= hm;
+            }
+        }
+    }
+
+    /* the run containing y or, if none, the first run after it */
+    size_t run_at(int y) const {
+        size_t lo = 0, hi = v.size() >> 1;
+        while (lo < hi) {
+            size_t mid = (lo + hi) >> 1;
+            if (v[2 * mid + 1] < y) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    bool contains(int y) const {
+        if (type == ARRAY) return std::binary_search(v.begin(), v.end(), (unsigned short)y);
+        if (type == BITMAP) return bits[y >> 6] >> (y & 63) & 1;
+        size_t r = run_at(y);
+        return r < v.size() >> 1 && v[2 * r] <= y;
+    }
+
+    /* the smallest value >= y, or -1 */
+    int next(int y) const {
+        if (type == ARRAY) {
+            auto it = std::lower_bound(v.begin(), v.end(), (unsigned short)y);
+            return it == v.end() ? -1 : *it;
+        }
+        if (type == BITMAP) {
+            int p = roaring_words_next(bits.data(), y);
+            return p == 65536 ? -1 : p;
+        }
+        size_t r = run_at(y);
+        if (r == v.size() >> 1) return -1;
+        return std::max<int>(v[2 * r], y);
+    }
+
+    /* number of values < y, 0 <= y <= 65536 */
+    int rank(int y) const {
+        if (type == ARRAY) return (int)(std::lower_bound(v.begin(), v.end(), y) - v.begin());
+        if (type == BITMAP) {
+            int res = 0;
+            for (int i = 0; i < (y >> 6); i++) res += __builtin_popcountll(bits[i]);
+            if (y & 63) res += __builtin_popcountll(bits[y >> 6] & ((1ULL << (y & 63)) - 1));
+            return res;
+        }
+        int res = 0;
+        for (size_t r = 0; r < v.size() && v[r] < y; r += 2) res += std::min<int>(v[r + 1] + 1, y) - v[r];
+        return res;
+    }
+
+    /* the k-th value (0-indexed), 0 <= k < card */
+    int select(int k) const {
+        if (type == ARRAY) return v[k];
+        if (type == BITMAP) {
+            for (int i = 0;; i++) {
+                int c = __builtin_popcountll(bits[i]);
+                if (k < c) return (i << 6) + select_in_word(bits[i], k);
+                k -= c;
+            }
+        }
+        for (size_t r = 0;; r += 2) {
+            int len = v[r + 1] - v[r] + 1;
+            if (k < len) return v[r] + k;
+            k -= len;
+        }
+    }
+
+    template <class F>
+    void for_each(F f) const {
+        if (type == ARRAY) {
+            for (unsigned short y : v) f(y);
+        } else if (type == BITMAP) {
+            for (int i = 0; i < ROARING_WORDS; i++) {
+                for (unsigned long long x = bits[i]; x; x &= x - 1) f(i << 6 | __builtin_ctzll(x));
+            }
+        } else {
+            for (size_t r = 0; r < v.size(); r += 2) {
+                for (int y = v[r]; y <= v[r + 1]; y++) f(y);
+            }
+        }
+    }
+
+    /* insert y; false if it was already there */
+    bool add(int y) {
+        if (type == ARRAY) {
+            auto it = std::lower_bound(v.begin(), v.end(), (unsigned short)y);
+            if (it != v.end() && *it == y) return false;
+            if (card < ROARING_ARRAY_MAX) {
+                v.insert(it, (unsigned short)y);
+                card++;
+                return true;
+            }
+        } else if (type == BITMAP) {
+            unsigned long long &x = bits[y >> 6], bit = 1ULL << (y & 63);
+            if (x & bit) return false;
+            x |= bit;
+            card++;
+            return true;
+        } else if (contains(y)) {
+            return false;
+        }
+        // a full ARRAY becomes a BITMAP, a RUN is rebuilt
+        std::vector<unsigned long long> w(ROARING_WORDS);
+        to_words(w.data());
+        w[y >> 6] |= 1ULL << (y & 63);
+        if (type == ARRAY) {
+            type = BITMAP;
+            std::vector<unsigned short>().swap(v);
+            bits = std::move(w);
+            card++;
+        } else {
+            *this = from_words(w.data());
+        }
+        return true;
+    }
+
+    /* delete y; false if it was not there */
+    bool remove(int y) {
+        if (type == ARRAY) {
+            auto it = std::lower_bound(v.begin(), v.end(), (unsigned short)y);
+            if (it == v.end() || *it != y) return false;
+            v.erase(it);
+            card--;
+            return true;
+        }
+        if (type == BITMAP) {
+            unsigned long long &x = bits[y >> 6], bit = 1ULL << (y & 63);
+            if (!(x & bit)) return false;
+            x &= ~bit;
+            if (--card <= ROARING_ARRAY_MAX) {
+                std::vector<unsigned short> a;
+                a.reserve(card);
+                for_each([&](int z) { a.push_back((unsigned short)z); });
+                type = ARRAY;
+                v = std::move(a);
+                std::vector<unsigned long long>().swap(bits);
+            }
+            return true;
+        }
+        if (!contains(y)) return false;
+        std::vector<unsigned long long> w(ROARING_WORDS);
+        to_words(w.data());
+        w[y >> 6] &= ~(1ULL << (y & 63));
+        *this = from_words(w.data());
+        return true;
+    }
+
+    /* the same container in its smallest form */
+    void optimize() {
+        std::vector<unsigned long long> w(ROARING_WORDS);
+        to_words(w.data());
+        *this = from_words(w.data());
+    }
+
+    bool operator==(const roaring_container &o) const {
+        if (card != o.card) return false;
+        if (type == o.type && type != BITMAP) return v == o.v;
+        std::vector<unsigned long long> a(ROARING_WORDS), b(ROARING_WORDS);
+        to_words(a.data());
+        o.to_words(b.data());
+        return a == b;
+    }
+
+    size_t bytes() const {
+        return sizeof(roaring_container) + v.size() * sizeof(unsigned short)
+               + bits.size() * sizeof(unsigned long long);
+    }
+};
+
+/* a op b for containers of the same key (the result may be empty) */
+static roaring_container
+roaring_container_op(const roaring_container &a, const roaring_container &b, roaring_op op) {
+    typedef roaring_container C;
+    if (a.type == C::ARRAY && b.type == C::ARRAY) {
+        std::vector<unsigned short> res;
+        res.reserve(op == ROARING_AND ? std::min(a.card, b.card)
+                    : op == ROARING_ANDNOT ? a.card : a.card + b.card);
+        auto out = std::back_inserter(res);
+        if (op == ROARING_AND) std::set_intersection(a.v.begin(), a.v.end(), b.v.begin(), b.v.end(), out);
+        else if (op == ROARING_OR) std::set_union(a.v.begin(), a.v.end(), b.v.begin(), b.v.end(), out);
+        else if (op == ROARING_XOR) std::set_symmetric_difference(a.v.begin(), a.v.end(), b.v.begin(), b.v.end(), out);
+        else std::set_difference(a.v.begin(), a.v.end(), b.v.begin(), b.v.end(), out);
+        return C::from_sorted(std::move(res));
+    }
+    if ((op == ROARING_AND || op == ROARING_ANDNOT) && a.type == C::ARRAY) {
+        std::vector<unsigned short> res;
+        for (unsigned short y : a.v) {
+            if (b.contains(y) == (op == ROARING_AND)) res.push_back(y);
+        }
+        return C::from_sorted(std::move(res));
+    }
+    if (op == ROARING_AND && b.type == C::ARRAY) return roaring_container_op(b, a, op);
+    unsigned long long x[ROARING_WORDS], y[ROARING_WORDS];
+    a.to_words(x);
+    b.to_words(y);
+    for (int i = 0; i < ROARING_WORDS; i++) {
+        if (op == ROARING_AND) x[i] &= y[i];
+        else if (op == ROARING_OR) x[i] |= y[i];
+        else if (op == ROARING_XOR) x[i] ^= y[i];
+        else x[i] &= ~y[i];
+    }
+    return C::from_words(x);
+}
+
+
+struct roaring {
+    std::vector<unsigned short> keys;
+    std::vector<roaring_container> cs;
+    mutable std::vector<long long> prefix;  // values in cs[0..i), rebuilt after changes
+    mutable bool dirty = true;
+
+    long long size() const {
+        build_prefix();
+        return prefix.back();
+    }
+
+    void build_prefix() const {
+        if (!dirty) return;
+        prefix.assign(cs.size() + 1, 0);
+        for (size_t i = 0; i < cs.size(); i++) prefix[i + 1] = prefix[i] + cs[i].card;
+        dirty = false;
+    }
+
+    /* the first container with key >= k */
+    size_t lower(unsigned k) const {
+        return std::lower_bound(keys.begin(), keys.end(), (unsigned short)k) - keys.begin();
+    }
+
+    /* from sorted distinct values */
+    void assign_sorted(const std::vector<unsigned int> &a) {
+        keys.clear();
+        cs.clear();
+        for (size_t i = 0, j; i < a.size(); i = j) {
+            unsigned k = a[i] >> 16;
+            std::vector<unsigned short> lo;
+            for (j = i; j < a.size() && (a[j] >> 16) == k; j++) lo.push_back((unsigned short)a[j]);
+            keys.push_back((unsigned short)k);
+            cs.push_back(roaring_container::from_sorted(std::move(lo)));
+        }
+        dirty = true;
+    }
+
+    /* from the set bits of m words */
+    void assign_words(const unsigned long long *w, long long m) {
+        keys.clear();
+        cs.clear();
+        std::vector<unsigned long long> buf(ROARING_WORDS);
+        for (long long k = 0; k * ROARING_WORDS < m; k++) {
+            long long len = std::min<long long>(ROARING_WORDS, m - k * ROARING_WORDS);
+            const unsigned long long *src = w + k * ROARING_WORDS;
+            if (std::all_of(src, src + len, [](unsigned long long x) { return !x; })) continue;
+            std::fill(std::copy(src, src + len, buf.begin()), buf.end(), 0);
+            keys.push_back((unsigned short)k);
+            cs.push_back(roaring_container::from_words(buf.data()));
+        }
+        dirty = true;
+    }
+
+    /* the set bits written over m words (values >= 64 m are dropped) */
+    void to_words(unsigned long long *w, long long m) const {
+        std::fill(w, w + m, 0);
+        std::vector<unsigned long long> buf(ROARING_WORDS);
+        for (size_t i = 0; i < cs.size() && (long long)keys[i] * ROARING_WORDS < m; i++) {
+            long long off = (long long)keys[i] * ROARING_WORDS;
+            cs[i].to_words(buf.data());
+            std::copy(buf.begin(), buf.begin() + std::min<long long>(ROARING_WORDS, m - off), w + off);
+        }
+    }
+
+    bool contains(unsigned x) const {
+        size_t i = lower(x >> 16);
+        return i < keys.size() && keys[i] == x >> 16 && cs[i].contains(x & 65535);
+    }
+
+    bool add(unsigned x) {
+        size_t i = lower(x >> 16);
+        if (i == keys.size() || keys[i] != x >> 16) {
+            keys.insert(keys.begin() + i, (unsigned short)(x >> 16));
+            cs.insert(cs.begin() + i, roaring_container());
+        }
+        bool res = cs[i].add(x & 65535);
+        dirty |= res;
+        return res;
+    }
+
+    bool remove(unsigned x) {
+        size_t i = lower(x >> 16);
+        if (i == keys.size() || keys[i] != x >> 16 || !cs[i].remove(x & 65535)) return false;
+        if (cs[i].card == 0) {
+            keys.erase(keys.begin() + i);
+            cs.erase(cs.begin() + i);
+        }
+        dirty = true;
+        return true;
+    }
+
+    /* the smallest value >= x, or -1 */
+    long long next(long long x) const {
+        if (x >= (1LL << 32)) return -1;
+        for (size_t i = lower((unsigned)(x >> 16)); i < keys.size(); i++) {
+            int y = keys[i] == x >> 16 ? cs[i].next((int)(x & 65535)) : cs[i].next(0);
+            if (y >= 0) return (long long)keys[i] << 16 | y;
+        }
+        return -1;
+    }
+
+    /* number of values < x, 0 <= x <= 2^32 */
+    long long rank(long long x) const {
+        build_prefix();
+        if (x >= (1LL << 32)) return prefix.back();
+        size_t i = lower((unsigned)(x >> 16));
+        long long res = prefix[i];
+        if (i < keys.size() && keys[i] == x >> 16) res += cs[i].rank((int)(x & 65535));
+        return res;
+    }
+
+    /* the k-th value (0-indexed), 0 <= k < size() */
+    long long select(long long k) const {
+        build_prefix();
+        size_t i = std::upper_bound(prefix.begin(), prefix.end(), k) - prefix.begin() - 1;
+        return (long long)keys[i] << 16 | cs[i].select((int)(k - prefix[i]));
+    }
+
+    template <class F>
+    void for_each(F f) const {
+        for (size_t i = 0; i < cs.size(); i++) {
+            unsigned hi = (unsigned)keys[i] << 16;
+            cs[i].for_each([&](int y) { f(hi | (unsigned)y); });
+        }
+    }
+
+    void optimize() {
+        for (roaring_container &c : cs) c.optimize();
+    }
+
+    bool operator==(const roaring &o) const {
+        return keys == o.keys && std::equal(cs.begin(), cs.end(), o.cs.begin(), o.cs.end());
+    }
+
+    size_t bytes() const {
+        size_t res = sizeof(roaring) + keys.size() * sizeof(unsigned short);
+        for (const roaring_container &c : cs) res += c.bytes();
+        return res;
+    }
+};
+
+/* a op b, merging the keys */
+static roaring
+roaring_combine(const roaring &a, const roaring &b, roaring_op op) {
+    roaring z;
+    size_t i = 0, j = 0;
+    bool keep_a = op != ROARING_AND, keep_b = op == ROARING_OR || op == ROARING_XOR;
+    while (i < a.keys.size() || j < b.keys.size()) {
+        if (j == b.keys.size() || (i < a.keys.size() && a.keys[i] < b.keys[j])) {
+            if (keep_a) {
+                z.keys.push_back(a.keys[i]);
+                z.cs.push_back(a.cs[i]);
+            }
+            i++;
+        } else if (i == a.keys.size() || b.keys[j] < a.keys[i]) {
+            if (keep_b) {
+                z.keys.push_back(b.keys[j]);
+                z.cs.push_back(b.cs[j]);
+            }
+            j++;
+        } else {
+            roaring_container c = roaring_container_op(a.cs[i], b.cs[j], op);
+            if (c.card) {
+                z.keys.push_back(a.keys[i]);
+                z.cs.push_back(std::move(c));
+            }
+            i++;
+            j++;
+        }
+    }
+    return z;
+}
+
+
+} // namespace internal
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_INTERNAL_ROARING
@@ -0,0 +1,218 @@
+#ifndef ACL_PYTHON_INTERNAL_SIEVE
+#define ACL_PYTHON_INTERNAL_SIEVE
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "atcoder/internal_thread"
+
+
+
+namespace atcoder_python {
+namespace internal {
+
+
+/* Segmented sieve of Eratosthenes.
+
+    Only the odd numbers are stored, one bit each: bit i of the segment
+    starting at odd index a stands for 2(a + i) + 1. A segment is SIEVE_SEGMENT_BYTES long so
+    that it stays in L1 while every base prime crosses it.
+
+    The multiples of 3, 5, 7, 11 and 13 are not crossed off one by one: the
+    odd numbers coprime to them repeat with period 15015, so a segment is
+    initialized by copying words of a precomputed 15015-word (= 64
+    periods) pattern, and the sieving starts at 17.
+
+    The segments are independent of each other (every one computes its own
+    first multiples), so they are spread over the worker pool in groups.
+*/
+
+#define SIEVE_SEGMENT_BYTES (1 << 15)
+#define SIEVE_WHEEL_WORDS 15015
+
+static const std::vector<unsigned long long> &
+sieve_wheel_pattern() {
+    static const std::vector<unsigned long long> pattern = [] {
+        std::vector<unsigned long long> w(SIEVE_WHEEL_WORDS, ~0ULL);
+        for (unsigned long long p : {3, 5, 7, 11, 13}) {
+            // odd index i stands for 2i + 1
+            for (unsigned long long i = (p - 1) / 2; i < 64ULL * SIEVE_WHEEL_WORDS; i += p) {
+                w[i >> 6] &= ~(1ULL << (i & 63));
+            }
+        }
+        return w;
+    }();
+    return pattern;
+}
+
+/* primes <= n by a plain sieve (n is small) */
+static std::vector<unsigned int>
+sieve_small(unsigned int n) {
+    std::vector<unsigned int> res;
+    if (n < 2) return res;
+    std::vector<bool> composite(n + 1, false);
+    for (unsigned long long i = 2; i <= n; i++) {
+        if (composite[i]) continue;
+        res.push_back((unsigned int)i);
+        for (unsigned long long j = i * i; j <= n; j += i) composite[j] = true;
+    }
+    return res;
+}
+
+/* primes in [lo, hi) in increasing order, written as T */
+template <class T>
+static std::vector<T>
+sieve_range(unsigned long long lo, unsigned long long hi, int threads) {
+    std::vector<T> res;
+    if (hi <= lo) return res;
+    if (lo <= 2 && 2 < hi) res.push_back(2);
+    // odd numbers 2i + 1 with i in [i0, i1); i0 is a multiple of 64
+    unsigned long long i0 = (lo / 2) & ~63ULL, i1 = hi / 2;
+    if (i1 <= i0) return res;
+    unsigned long long root = (unsigned long long)std::sqrt((double)(hi - 1));
+    while (root * root > hi - 1) root--;
+    while ((root + 1) * (root + 1) <= hi - 1) root++;
+    std::vector<unsigned int> base = sieve_small((unsigned int)root);
+    const std::vector<unsigned long long> &wheel = sieve_wheel_pattern();
+
+    const unsigned long long seg_bits = 8ULL * SIEVE_SEGMENT_BYTES;
+    unsigned long long segs = (i1 - i0 + seg_bits - 1) / seg_bits;
+    int tasks = (int)std::min<unsigned long long>(segs, 64ULL * std::max(threads, 1));
+    std::vector<std::vector<T>> out(tasks);
+
+    parallel_for(tasks, threads, [&](int t) {
+        std::vector<unsigned long long> bits(seg_bits / 64);
+        unsigned long long s_begin = segs * t / tasks, s_end = segs * (t + 1) / tasks;
+        for (unsigned long long s = s_begin; s < s_end; s++) {
+            unsigned long long a = i0 + s * seg_bits, b = std::min(i1, a + seg_bits);
+            unsigned long long words = (b - a + 63) / 64;
+            for (unsigned long long w = 0, k = (a / 64) % SIEVE_WHEEL_WORDS; w < words; w++) {
+                bits[w] = wheel[k];
+                if (++k == SIEVE_WHEEL_WORDS) k = 0;
+            }
+            // the pattern has crossed off 1, 3, 5, ..., 13 themselves
+            if (a == 0) bits[0] = (bits[0] & ~1ULL) | 0x6eULL;
+            for (unsigned int p : base) {
+                if (p < 17) continue;
+                unsigned long long pp = (unsigned long long)p * p;
+                if (pp >= 2 * b + 1) break;
+                // the first odd multiple of p that is >= max(p^2, 2a + 1)
+                unsigned long long m = std::max(pp, ((2 * a + 1 + p - 1) / p) * p);
+                if (!(m & 1)) m += p;
+                for (unsigned long long i = (m - 1) / 2 - a; i < b - a; i += p) {
+                    bits[i >> 6] &= ~(1ULL << (i & 63));
+                }
+            }
+            if ((b - a) & 63) bits[words - 1] &= (1ULL << ((b - a) & 63)) - 1;
+            std::vector<T> &o = out[t];
+            for (unsigned long long w = 0; w < words; w++) {
+                unsigned long long x = bits[w];
+                while (x) {
+                    unsigned long long v = 2 * (a + 64 * w + __builtin_ctzll(x)) + 1;
+                    if (v >= lo) o.push_back((T)v);
+                    x &= x - 1;
+                }
+            }
+        }
+    });
+    size_t total = res.size();
+    for (auto &o : out) total += o.size();
+    res.reserve(total);
+    for (auto &o : out) {
+        res.insert(res.end(), o.begin(), o.end());
+        std::vector<T>().swap(o);
+    }
+    return res;
+}
+
+/* smallest prime factor of 0..n (spf[0] = 0, spf[1] = 1) by the linear sieve */
+static std::vector<int>
+linear_sieve_spf(int n) {
+    std::vector<int> spf(n + 1, 0), primes;
+    if (n >= 1) spf[1] = 1;
+    for (int i = 2; i <= n; i++) {
+        if (spf[i] == 0) {
+            spf[i] = i;
+            primes.push_back(i);
+        }
+        for (int p : primes) {
+            if (p > spf[i] || (long long)p * i > n) break;
+            spf[p * i] = p;
+        }
+    }
+    return spf;
+}
+
+/* Arithmetic-function tables of 0..n filled in one pass of the linear
+    sieve; a table is skipped when its pointer is null.
+
+    Every j = i * p is reached once with p = lpf(j). When p divides i,
+    with i = m * p^e (p not dividing m), the multiplicativity gives
+        d(j) = d(i) + d(m)
+        sigma(j) = p * sigma(i) + sigma(m)
+    so the only extra state is pw[i] = p^e, the lpf power of i.
+*/
+struct arithmetic_tables {
+    std::vector<int> *totient = nullptr;
+    std::vector<signed char> *mobius = nullptr;
+    std::vector<int> *divisor_count = nullptr;
+    std::vector<long long> *divisor_sum = nullptr;
+};
+
+static void
+arithmetic_sieve(int n, const arithmetic_tables &t) {
+    std::vector<int> lpf(n + 1, 0), primes;
+    std::vector<int> pw((t.divisor_count || t.divisor_sum) ? n + 1 : 0);
+    if (t.totient) t.totient->assign(n + 1, 0);
+    if (t.mobius) t.mobius->assign(n + 1, 0);
+    if (t.divisor_count) t.divisor_count->assign(n + 1, 0);
+    if (t.divisor_sum) t.divisor_sum->assign(n + 1, 0);
+    if (n < 1) return;
+    int *phi = t.totient ? t.totient->data() : nullptr;
+    signed char *mu = t.mobius ? t.mobius->data() : nullptr;
+    int *d = t.divisor_count ? t.divisor_count->data() : nullptr;
+    long long *sigma = t.divisor_sum ? t.divisor_sum->data() : nullptr;
+    if (phi) phi[1] = 1;
+    if (mu) mu[1] = 1;
+    if (d) d[1] = 1;
+    if (sigma) sigma[1] = 1;
+    for (int i = 2; i <= n; i++) {
+        if (lpf[i] == 0) {
+            lpf[i] = i;
+            primes.push_back(i);
+            if (phi) phi[i] = i - 1;
+            if (mu) mu[i] = -1;
+            if (d) d[i] = 2;
+            if (sigma) sigma[i] = i + 1LL;
+            if (!pw.empty()) pw[i] = i;
+        }
+        for (int p : primes) {
+            if (p > lpf[i] || (long long)p * i > n) break;
+            int j = p * i;
+            lpf[j] = p;
+            if (p == lpf[i]) {
+                int m = pw.empty() ? 0 : i / pw[i];
+                if (phi) phi[j] = phi[i] * p;
+                if (mu) mu[j] = 0;
+                if (d) d[j] = d[i] + d[m];
+                if (sigma) sigma[j] = sigma[i] * p + sigma[m];
+                if (!pw.empty()) pw[j] = pw[i] * p;
+            } else {
+                if (phi) phi[j] = phi[i] * (p - 1);
+                if (mu) mu[j] = -mu[i];
+                if (d) d[j] = d[i] * 2;
+                if (sigma) sigma[j] = sigma[i] * (p + 1);
+                if (!pw.empty()) pw[j] = p;
+            }
+        }
+    }
+}
+
+
+} // namespace internal
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_INTERNAL_SIEVE
@@ -0,0 +1,145 @@
+#ifndef ACL_PYTHON_INTERNAL_THREAD
+#define ACL_PYTHON_INTERNAL_THREAD
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+namespace atcoder_python {
+namespace internal {
+
+
+/* Shared worker pool for the bulk kernels.
+
+    parallel_for(tasks, threads, f) runs f(0), ..., f(tasks - 1) on up to
+    `threads` threads (the calling one included) and returns when all of
+    them have finished. The calling thread keeps taking tasks until none
+    are left, so nested calls (and a pool whose workers are gone, e.g.
+    in a forked child) can not deadlock.
+
+    f must not touch Python objects: the callers release the GIL around
+    the parallel section.
+*/
+
+
+struct parallel_job {
+    std::function<void(int)> f;
+    int tasks = 0;
+    std::atomic<int> next{0};
+    std::atomic<int> done{0};
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    void run() {
+        int i;
+        while ((i = next.fetch_add(1)) < tasks) {
+            f(i);
+            if (done.fetch_add(1) + 1 == tasks) {
+                std::lock_guard<std::mutex> lock(mtx);
+                cv.notify_all();
+            }
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return done.load() == tasks; });
+    }
+};
+
+
+class thread_pool {
+  public:
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto &t : workers) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    // hand `copies` references of the job to idle workers
+    void submit(const std::shared_ptr<parallel_job> &job, int copies) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            while ((int)workers.size() < copies) {
+                workers.emplace_back([this] { loop(); });
+            }
+            for (int i = 0; i < copies; i++) queue.push_back(job);
+        }
+        cv.notify_all();
+    }
+
+  private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<parallel_job>> queue;
+    std::vector<std::thread> workers;
+    bool stop = false;
+
+    void loop() {
+        while (true) {
+            std::shared_ptr<parallel_job> job;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stop || !queue.empty(); });
+                if (stop) return;
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            job->run();
+        }
+    }
+};
+
+
+static thread_pool &
+shared_pool() {
+    static thread_pool pool;
+    return pool;
+}
+
+static int
+hardware_threads() {
+    unsigned int t = std::thread::hardware_concurrency();
+    return t ? (int)t : 1;
+}
+
+/* `threads` argument of the Python API: 0 means all the cores */
+static int
+resolve_threads(int threads) {
+    return threads <= 0 ? hardware_threads() : threads;
+}
+
+template <class F>
+static void
+parallel_for(int tasks, int threads, F f) {
+    if (threads > tasks) threads = tasks;
+    if (threads <= 1) {
+        for (int i = 0; i < tasks; i++) f(i);
+        return;
+    }
+    auto job = std::make_shared<parallel_job>();
+    job->f = f;
+    job->tasks = tasks;
+    shared_pool().submit(job, threads - 1);
+    job->run();
+    job->wait();
+}
+
+
+} // namespace internal
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_INTERNAL_THREAD
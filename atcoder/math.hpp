@@ -4,11 +4,18 @@
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include "atcoder/utils"
 #include "atcoder/internal_math"
+#include "atcoder/internal_bit"
+#include "atcoder/internal_thread"
+#include "atcoder/internal_sieve"
+#include "atcoder/convolution"
 
 
 // reference: https://github.com/atcoder/ac-library/blob/master/atcoder/math.hpp
@@ -181,6 +188,270 @@ PyDoc_STRVAR(crt_doc,
     {"crt", (PyCFunction)crt, METH_VARARGS | METH_KEYWORDS, crt_doc},
 
 
+/* big crt  ************************************************/
+
+/*
+    >>> garner([2, 3, 2], [3, 5, 7])
+    23
+    >>> m = [(1 << 61) - 1, (1 << 31) - 1, 998244353]
+    >>> garner([1, 2, 3], m)
+    557047941705589692440948578828192091
+    >>> garner([1, 2, 3], m, out_mod=10**9 + 7)
+    248004303
+    >>> crt_big([1, 3], [4, 6])       # moduli need not be coprime
+    (9, 12)
+
+    The mixed-radix digits x[i] of Garner's algorithm are computed with
+    word arithmetic (every modulus and out_mod is below 2^63), and the
+    exact value x[0] + m[0] (x[1] + m[1] (x[2] + ...)) is built in 64-bit
+    limbs, so no Python int arithmetic is done per step.
+
+*/
+
+namespace internal {
+
+static unsigned long long
+mul_mod_u64(unsigned long long a, unsigned long long b, unsigned long long m) {
+    return (unsigned long long)((unsigned __int128)a * b % m);
+}
+
+/* the mixed-radix digits of the solution for pairwise coprime m, and the
+   solution mod out_mod in *out (out_mod = 0: none); false if some m[i] is
+   not coprime with the product of the previous ones */
+static bool
+garner_digits(const std::vector<unsigned long long> &r, const std::vector<unsigned long long> &m,
+              unsigned long long out_mod, std::vector<unsigned long long> &x,
+              unsigned long long *out) {
+    int n = (int)m.size();
+    // slot n is out_mod; constants[k] = x[0] + x[1] m[0] + ... (mod mods[k]),
+    // coeffs[k] = m[0] m[1] ... (mod mods[k])
+    std::vector<unsigned long long> mods(m), constants(n + 1, 0), coeffs(n + 1);
+    mods.push_back(out_mod ? out_mod : 1);
+    for (int k = 0; k <= n; k++) coeffs[k] = 1 % mods[k];
+    x.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        auto [g, inv] = inv_gcd((long long)coeffs[i], (long long)m[i]);
+        if (g != 1) return false;
+        unsigned long long t = (r[i] + m[i] - constants[i]) % m[i];
+        t = mul_mod_u64(t, (unsigned long long)inv, m[i]);
+        x[i] = t;
+        for (int k = i + 1; k <= n; k++) {
+            constants[k] = (constants[k] + mul_mod_u64(t % mods[k], coeffs[k], mods[k])) % mods[k];
+            coeffs[k] = mul_mod_u64(coeffs[k], m[i] % mods[k], mods[k]);
+        }
+    }
+    if (out) *out = constants[n];
+    return true;
+}
+
+/* v = v * a + b on little-endian limbs */
+static void
+limbs_mul_add(std::vector<unsigned long long> &v, unsigned long long a, unsigned long long b) {
+    unsigned long long carry = b;
+    for (auto &w : v) {
+        unsigned __int128 t = (unsigned __int128)w * a + carry;
+        w = (unsigned long long)t;
+        carry = (unsigned long long)(t >> 64);
+    }
+    if (carry) v.push_back(carry);
+    while (!v.empty() && v.back() == 0) v.pop_back();
+}
+
+/* x[0] + m[0] (x[1] + m[1] (x[2] + ...)) as limbs */
+static std::vector<unsigned long long>
+garner_value(const std::vector<unsigned long long> &x, const std::vector<unsigned long long> &m) {
+    std::vector<unsigned long long> v;
+    for (int i = (int)x.size() - 1; i >= 0; i--) limbs_mul_add(v, m[i], x[i]);
+    return v;
+}
+
+} // namespace internal
+
+
+/* r, m from Python: 0 <= r[i] < m[i] < 2^63 after the reduction */
+static int
+garner_parse_args(PyObject *r_obj, PyObject *m_obj, std::vector<unsigned long long> &r,
+                  std::vector<unsigned long long> &m) {
+    int err = 0;
+    auto r0 = _PyObject_AsVectorLongLong(r_obj, &err);
+    if (err) return -1;
+    auto m0 = _PyObject_AsVectorLongLong(m_obj, &err);
+    if (err) return -1;
+    if (r0.size() != m0.size()) {
+        PyErr_SetString(PyExc_ValueError, "both arrays need to have same length");
+        return -1;
+    }
+    r.resize(r0.size());
+    m.resize(m0.size());
+    for (size_t i = 0; i < m0.size(); i++) {
+        if (m0[i] < 1) {
+            PyErr_SetString(PyExc_ValueError, "m[i] >= 1 is required");
+            return -1;
+        }
+        m[i] = m0[i];
+        r[i] = safe_mod(r0[i], m0[i]);
+    }
+    return 0;
+}
+
+
+static PyObject *
+garner(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"r", (char *)"m", (char *)"out_mod", NULL};
+    PyObject *r_obj, *m_obj, *out_obj = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O", kwlist, &r_obj, &m_obj, &out_obj)) return NULL;
+    unsigned long long out_mod = 0;
+    if (out_obj != Py_None) {
+        long long v = PyLong_AsLongLong(out_obj);
+        if (v == -1 && PyErr_Occurred()) return NULL;
+        if (v < 1) {
+            PyErr_SetString(PyExc_ValueError, "[constraints] 1 <= out_mod < 2^63");
+            return NULL;
+        }
+        out_mod = v;
+    }
+    std::vector<unsigned long long> r, m, x;
+    if (garner_parse_args(r_obj, m_obj, r, m)) return NULL;
+    unsigned long long res;
+    if (!internal::garner_digits(r, m, out_mod, x, &res)) {
+        PyErr_SetString(PyExc_ValueError, "m must be pairwise coprime (use crt_big)");
+        return NULL;
+    }
+    if (out_mod) return PyLong_FromUnsignedLongLong(res);
+    return _PyLong_FromLimbs(internal::garner_value(x, m));
+}
+
+PyDoc_STRVAR(garner_doc,
+"garner($module, r, m, out_mod=None)\n"
+"--\n\n"
+"The unique y in [0, m[0] m[1] ... m[n-1]) with y = r[i] (mod m[i]),\n"
+"for pairwise coprime m (Garner's algorithm)\n\n"
+"Parameters\n"
+"----------\n"
+"r : list[int] | buffer of integers\n"
+"    remainders\n"
+"m : list[int] | buffer of integers\n"
+"    pairwise coprime moduli\n"
+"out_mod : int | None\n"
+"    if given, y % out_mod is returned instead of y\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    y (an exact int of any size), or y % out_mod\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"len(r) == len(m)\n"
+"1 <= m[i] < 2^63\n"
+"-2^63 <= r[i] < 2^63\n"
+"1 <= out_mod < 2^63\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n^2)"
+);
+
+#define ACL_PYTHON_GARNER_METHODDEF \
+    {"garner", (PyCFunction)garner, METH_VARARGS | METH_KEYWORDS, garner_doc},
+
+
+static PyObject *
+crt_big(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"r", (char *)"m", NULL};
+    PyObject *r_obj, *m_obj;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", kwlist, &r_obj, &m_obj)) return NULL;
+    std::vector<unsigned long long> r, m;
+    if (garner_parse_args(r_obj, m_obj, r, m)) return NULL;
+
+    // split every congruence into prime powers, keeping the highest power
+    // of each prime; the others have to agree with it
+    std::vector<std::pair<unsigned long long, int>> pe;   // (prime, exponent)
+    std::vector<unsigned long long> pq, pr;               // (p^e, r mod p^e)
+    bool ok = true;
+    Py_BEGIN_ALLOW_THREADS
+    std::vector<unsigned long long> f;
+    for (size_t i = 0; i < m.size(); i++) {
+        f.clear();
+        if (m[i] > 1) factorize_u64(m[i], f);
+        std::sort(f.begin(), f.end());
+        for (size_t a = 0; a < f.size();) {
+            size_t b = a;
+            unsigned long long q = 1;
+            while (b < f.size() && f[b] == f[a]) q *= f[b++];
+            pe.push_back({f[a], (int)(b - a)});
+            pq.push_back(q);
+            pr.push_back(r[i] % q);
+            a = b;
+        }
+    }
+    // group by prime; the first entry of each group is the highest power
+    std::vector<size_t> order(pe.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (pe[a].first != pe[b].first) return pe[a].first < pe[b].first;
+        return pe[a].second > pe[b].second;
+    });
+    std::vector<unsigned long long> gm, gr;
+    for (size_t a = 0; a < order.size();) {
+        size_t b = a, top = order[a];
+        for (; b < order.size() && pe[order[b]].first == pe[top].first; b++) {
+            if (pr[top] % pq[order[b]] != pr[order[b]]) ok = false;
+        }
+        gm.push_back(pq[top]);
+        gr.push_back(pr[top]);
+        a = b;
+    }
+    r.swap(gr);
+    m.swap(gm);
+    Py_END_ALLOW_THREADS
+    if (!ok) return Py_BuildValue("(ii)", 0, 0);
+
+    std::vector<unsigned long long> x;
+    internal::garner_digits(r, m, 0, x, NULL);
+    std::vector<unsigned long long> lcm(1, 1);
+    for (auto q : m) internal::limbs_mul_add(lcm, q, 0);
+    PyObject *y_obj = _PyLong_FromLimbs(internal::garner_value(x, m));
+    if (y_obj == NULL) return NULL;
+    return Py_BuildValue("(NN)", y_obj, _PyLong_FromLimbs(lcm));
+}
+
+PyDoc_STRVAR(crt_big_doc,
+"crt_big($module, r, m)\n"
+"--\n\n"
+"crt() without the limit on lcm(m): the moduli are split into prime\n"
+"powers (with Pollard's rho), checked for consistency and combined by\n"
+"Garner's algorithm\n\n"
+"Parameters\n"
+"----------\n"
+"r : list[int] | buffer of integers\n"
+"    remainders\n"
+"m : list[int] | buffer of integers\n"
+"    moduli\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : tuple[int, int]\n"
+"    (y, z) where z = lcm(m) and y in [0, z) is the solution;\n"
+"    (0, 0) if there is none, (0, 1) if n == 0\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"len(r) == len(m)\n"
+"1 <= m[i] < 2^63\n"
+"-2^63 <= r[i] < 2^63\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(sum(m[i]^(1/4)) + k^2), k: the number of distinct prime factors"
+);
+
+#define ACL_PYTHON_CRT_BIG_METHODDEF \
+    {"crt_big", (PyCFunction)crt_big, METH_VARARGS | METH_KEYWORDS, crt_big_doc},
+
+
 
 static PyObject *
 floor_sum(PyObject *module, PyObject *const *args, Py_ssize_t nargs) {
@@ -202,19 +473,7 @@ floor_sum(PyObject *module, PyObject *const *args, Py_ssize_t nargs) {
         PyErr_SetString(PyExc_ValueError, "[constraints] 1 <= m < 2^32");
         return NULL;
     }
-    unsigned long long ans = 0;
-    if (a < 0) {
-        unsigned long long a2 = safe_mod(a, m);
-        ans -= 1ULL * n * (n - 1) / 2 * ((a2 - a) / m);
-        a = a2;
-    }
-    if (b < 0) {
-        unsigned long long b2 = safe_mod(b, m);
-        ans -= 1ULL * n * ((b2 - b) / m);
-        b = b2;
-    }
-    ans += floor_sum_unsigned(n, m, a, b);
-    return PyLong_FromUnsignedLongLong(ans);
+    return PyLong_FromUnsignedLongLong(floor_sum_signed(n, m, a, b));
 }
 
 PyDoc_STRVAR(floor_sum_doc,
@@ -253,50 +512,1703 @@ PyDoc_STRVAR(floor_sum_doc,
 #define ACL_PYTHON_FLOOR_SUM_METHODDEF \
     {"floor_sum", (PyCFunction)(void(*)(void))floor_sum, METH_FASTCALL, floor_sum_doc},
 
+
 static PyObject *
-is_prime(PyObject *module, PyObject *arg) {
-    if (!PyLong_Check(arg)) {
-        PyErr_SetString(PyExc_TypeError, "is_prime() takes int");
+floor_sum_many(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"n", (char *)"m", (char *)"a", (char *)"b", (char *)"threads", NULL};
+    PyObject *n_obj, *m_obj, *a_obj, *b_obj;
+    int threads = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOO|$i", kwlist, &n_obj, &m_obj, &a_obj, &b_obj,
+                                     &threads)) return NULL;
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must be non-negative");
         return NULL;
     }
-    long n = PyLong_AsLong(arg);
-    if (n < 0 || n >= (1L << 31)) CANNOT_CONVERT("is_prime", 0, "non-negative int");
-    if (is_prime_constexpr((int)n)) Py_RETURN_TRUE;
-    Py_RETURN_FALSE;
+    int err = 0;
+    auto n = _PyObject_AsVectorLongLong(n_obj, &err);
+    if (err) return NULL;
+    auto m = _PyObject_AsVectorLongLong(m_obj, &err);
+    if (err) return NULL;
+    auto a = _PyObject_AsVectorLongLong(a_obj, &err);
+    if (err) return NULL;
+    auto b = _PyObject_AsVectorLongLong(b_obj, &err);
+    if (err) return NULL;
+    size_t k = n.size();
+    if (m.size() != k || a.size() != k || b.size() != k) {
+        PyErr_SetString(PyExc_ValueError, "all arrays need to have same length");
+        return NULL;
+    }
+    for (size_t i = 0; i < k; i++) {
+        if (0 > n[i] || n[i] >= (1LL << 32)) {
+            PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n[i] < 2^32");
+            return NULL;
+        }
+        if (1 > m[i] || m[i] >= (1LL << 32)) {
+            PyErr_SetString(PyExc_ValueError, "[constraints] 1 <= m[i] < 2^32");
+            return NULL;
+        }
+    }
+    std::vector<unsigned long long> res(k);
+    const size_t chunk = 1 << 14;
+    int tasks = (int)((k + chunk - 1) / chunk);
+    threads = internal::resolve_threads(threads);
+    Py_BEGIN_ALLOW_THREADS
+    internal::parallel_for(tasks, threads, [&](int t) {
+        for (size_t i = t * chunk; i < std::min(k, (t + 1) * chunk); i++) {
+            res[i] = floor_sum_signed(n[i], m[i], a[i], b[i]);
+        }
+    });
+    Py_END_ALLOW_THREADS
+    return _PyArray_FromVector(res, "Q");
 }
 
-PyDoc_STRVAR(is_prime_doc,
-"is_prime($module, n)\n"
+PyDoc_STRVAR(floor_sum_many_doc,
+"floor_sum_many($module, n, m, a, b, *, threads=0)\n"
 "--\n\n"
-"Miller-Rabin primality test for integer n\n\n"
+"floor_sum(n[i], m[i], a[i], b[i]) for every i\n\n"
 "Parameters\n"
 "----------\n"
-"n: int\n"
-"    the number tested for primality\n"
+"n : list[int] | buffer of integers\n"
+"    integers\n"
+"m : list[int] | buffer of integers\n"
+"    integers\n"
+"a : list[int] | buffer of integers\n"
+"    integers\n"
+"b : list[int] | buffer of integers\n"
+"    integers\n"
+"threads : int\n"
+"    number of threads (0: all the cores)\n"
 "\n"
 "Returns\n"
 "-------\n"
-"result : bool\n"
-"    whether n is prime or not\n"
+"result : array.array\n"
+"    typecode 'Q' (the sums mod 2^64)\n"
 "\n"
 "Constraints\n"
 "-----------\n"
-"0 <= n < 2^31\n"
+"the same length for all the arrays\n"
+"0 <= n[i] < 2^32\n"
+"1 <= m[i] < 2^32\n"
+"-2^63 <= a[i], b[i] < 2^63\n"
 "\n"
 "Complexity\n"
 "----------\n"
-"TODO"
+"\u039F(sum(logm[i]))"
 );
 
-#define ACL_PYTHON_IS_PRIME_METHODDEF \
-    {"is_prime", (PyCFunction)is_prime, METH_O, is_prime_doc},
+#define ACL_PYTHON_FLOOR_SUM_MANY_METHODDEF \
+    {"floor_sum_many", (PyCFunction)floor_sum_many, METH_VARARGS | METH_KEYWORDS, floor_sum_many_doc},
+
+
+static PyObject *
+floor_sum_ex(PyObject *module, PyObject *const *args, Py_ssize_t nargs) {
+    const char *name = "floor_sum_ex";
+    long long n = 0, m = 0, a = 0, b = 0;
+    if (nargs != 4) NARGS_VIOLATION(name, 4);
+    int overflow;
+    CONVERT_LONG_LONG(n, 0, overflow, name);
+    CONVERT_LONG_LONG(m, 1, overflow, name);
+    CONVERT_LONG_LONG(a, 2, overflow, name);
+    CONVERT_LONG_LONG(b, 3, overflow, name);
+    if (0 > n || n >= (1LL << 32)){
+        PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n < 2^32");
+        return NULL;
+    }
+    if (1 > m || m >= (1LL << 32)){
+        PyErr_SetString(PyExc_ValueError, "[constraints] 1 <= m < 2^32");
+        return NULL;
+    }
+    auto [f, fi, ff] = floor_sum_ex_signed(n, m, a, b);
+    return Py_BuildValue("(KKK)", f, fi, ff);
+}
+
+PyDoc_STRVAR(floor_sum_ex_doc,
+"floor_sum_ex($module, n, m, a, b)\n"
+"--\n\n"
+"With f(i) = (a * i + b) // m, calculate together\n"
+"sum(f(i) for i in range(n)), sum(i * f(i) for i in range(n))\n"
+"and sum(f(i)**2 for i in range(n)) (\"universal\" Euclidean algorithm).\n"
+"It returns the answers in mod 2^64, if overflowed\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    integer\n"
+"m : int\n"
+"    integer\n"
+"a : int\n"
+"    integer\n"
+"b : int\n"
+"    integer\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : tuple[int, int, int]\n"
+"    the three sums\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n < 2^32\n"
+"1 <= m < 2^32\n"
+"-2^63 <= a < 2^63\n"
+"-2^63 <= b < 2^63\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(log(m)^2)"
+);
+
+#define ACL_PYTHON_FLOOR_SUM_EX_METHODDEF \
+    {"floor_sum_ex", (PyCFunction)(void(*)(void))floor_sum_ex, METH_FASTCALL, floor_sum_ex_doc},
+
+
+/* prime counting  *****************************************/
+
+/*
+    >>> prime_count(10**10)
+    455052511
+    >>> multiplicative_sum(100, [-1, 1], lambda p, e: p**e - p**(e - 1), 10**9 + 7)
+    3044                            # sum of totient(i) for i <= 100
+
+    Lucy_Hedgehog's method: g(v) = sum(f(p) for primes p <= v) is only
+    needed at the O(sqrt(n)) values v = n // i, and is stored in two flat
+    arrays, lo[v] for v <= sqrt(n) and hi[i] for v = n // i > sqrt(n).
+    Min_25's recursion then adds the composite numbers.
+
+*/
+
+namespace internal {
+
+static unsigned long long
+isqrt_u64(unsigned long long n) {
+    unsigned long long r = (unsigned long long)std::sqrt((double)n);
+    while (r * r > n) r--;
+    while ((r + 1) * (r + 1) <= n) r++;
+    return r;
+}
+
+/* pi(n) by Lucy_Hedgehog's method, in O(n^(3/4)) */
+static long long
+prime_count_impl(long long n) {
+    if (n < 2) return 0;
+    long long r = (long long)isqrt_u64(n);
+    std::vector<long long> lo(r + 1), hi(r + 1);
+    for (long long i = 1; i <= r; i++) {
+        lo[i] = i - 1;
+        hi[i] = n / i - 1;
+    }
+    for (long long p = 2; p <= r; p++) {
+        if (lo[p] == lo[p - 1]) continue;
+        long long pc = lo[p - 1], q = p * p;
+        long long m = std::min(r, n / q);
+        for (long long i = 1; i <= m; i++) {
+            long long d = i * p;
+            hi[i] -= (d <= r ? hi[d] : lo[n / d]) - pc;
+        }
+        for (long long v = r; v >= q; v--) lo[v] -= lo[v / p] - pc;
+    }
+    return hi[1];
+}
+
+/* sum(i^k for 2 <= i <= v) mod m, for k <= 3 */
+static unsigned long long
+power_prefix_sum(unsigned long long v, int k, unsigned long long m) {
+    unsigned __int128 x = v, s;
+    if (k == 0) s = x;
+    else if (k == 1) s = x * (x + 1) / 2;
+    else if (k == 2) s = x * (x + 1) * (2 * x + 1) / 6;
+    else {
+        s = x * (x + 1) / 2 % m;
+        s = s * s;
+    }
+    return (unsigned long long)((s + m - 1) % m);
+}
+
+struct multiplicative_sum_impl {
+    unsigned long long n, r, m;
+    std::vector<unsigned int> primes;            // the primes <= sqrt(n)
+    std::vector<unsigned long long> lo, hi;      // sum of f(p) for primes p <= v
+    std::vector<unsigned long long> pre;         // pre[j] = f(primes[0]) + ... + f(primes[j - 1])
+    std::vector<unsigned long long> fpe;         // f(p^e) for e >= 1, packed per prime
+    std::vector<size_t> fpe_offset;
+
+    /* f(p) = poly[0] + poly[1] p + ... (mod m) on the primes */
+    multiplicative_sum_impl(unsigned long long n_, const std::vector<unsigned long long> &poly,
+                            unsigned long long m_)
+        : n(n_), r(isqrt_u64(n_)), m(m_), primes(sieve_small((unsigned int)r)),
+          lo(r + 1, 0), hi(r + 1, 0) {
+        std::vector<unsigned long long> glo(r + 1), ghi(r + 1);
+        for (int k = 0; k < (int)poly.size(); k++) {
+            if (poly[k] == 0) continue;
+            for (unsigned long long i = 1; i <= r; i++) {
+                glo[i] = power_prefix_sum(i, k, m);
+                ghi[i] = power_prefix_sum(n / i, k, m);
+            }
+            for (unsigned int p : primes) {
+                unsigned long long pk = 1, pc = glo[p - 1], q = (unsigned long long)p * p;
+                for (int t = 0; t < k; t++) pk = pk * (p % m) % m;
+                unsigned long long lim = std::min(r, n / q);
+                for (unsigned long long i = 1; i <= lim; i++) {
+                    unsigned long long d = i * p;
+                    unsigned long long g = d <= r ? ghi[d] : glo[n / d];
+                    ghi[i] = (ghi[i] + m - pk * ((g + m - pc) % m) % m) % m;
+                }
+                for (unsigned long long v = r; v >= q; v--) {
+                    glo[v] = (glo[v] + m - pk * ((glo[v / p] + m - pc) % m) % m) % m;
+                }
+            }
+            for (unsigned long long i = 1; i <= r; i++) {
+                lo[i] = (lo[i] + poly[k] * glo[i]) % m;
+                hi[i] = (hi[i] + poly[k] * ghi[i]) % m;
+            }
+        }
+        pre.assign(primes.size() + 1, 0);
+        for (size_t j = 0; j < primes.size(); j++) {
+            pre[j + 1] = (pre[j] + lo[primes[j]] + m - lo[primes[j] - 1]) % m;
+        }
+    }
+
+    unsigned long long g(unsigned long long v) const {
+        return v <= r ? lo[v] : hi[n / v];
+    }
+
+    /* sum of f(i) for 2 <= i <= x whose prime factors are all >= primes[j] */
+    unsigned long long sum(unsigned long long x, size_t j) const {
+        if (j > 0 && primes[j - 1] >= x) return 0;
+        unsigned long long res = (g(x) + m - pre[j]) % m;
+        for (size_t k = j; k < primes.size() && (unsigned long long)primes[k] * primes[k] <= x; k++) {
+            unsigned long long p = primes[k], pe = p;
+            for (size_t e = 0; pe * p <= x; e++, pe *= p) {
+                const unsigned long long *f = fpe.data() + fpe_offset[k];
+                res = (res + f[e] * sum(x / pe, k + 1) + f[e + 1]) % m;
+            }
+        }
+        return res;
+    }
+};
+
+} // namespace internal
+
+
+static PyObject *
+prime_count(PyObject *module, PyObject *arg) {
+    long long n = PyLong_AsLongLong(arg);
+    if (n == -1 && PyErr_Occurred()) return NULL;
+    if (n < 0 || n > 1000000000000LL) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n <= 10^12");
+        return NULL;
+    }
+    long long res;
+    Py_BEGIN_ALLOW_THREADS
+    res = internal::prime_count_impl(n);
+    Py_END_ALLOW_THREADS
+    return PyLong_FromLongLong(res);
+}
+
+PyDoc_STRVAR(prime_count_doc,
+"prime_count($module, n)\n"
+"--\n\n"
+"The number of primes less than or equal to n\n"
+"(Lucy_Hedgehog's method)\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    upper bound (inclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    pi(n)\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n <= 10^12\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n^(3/4))"
+);
+
+#define ACL_PYTHON_PRIME_COUNT_METHODDEF \
+    {"prime_count", (PyCFunction)prime_count, METH_O, prime_count_doc},
+
+
+static PyObject *
+multiplicative_sum(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"n", (char *)"poly", (char *)"f", (char *)"mod", NULL};
+    long long n, mod;
+    PyObject *poly_obj, *f_obj;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "LOOL", kwlist, &n, &poly_obj, &f_obj, &mod)) return NULL;
+    if (n < 0 || n > 1000000000000LL) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n <= 10^12");
+        return NULL;
+    }
+    if (mod < 1 || mod >= (1LL << 32)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 1 <= mod < 2^32");
+        return NULL;
+    }
+    if (!PyCallable_Check(f_obj)) {
+        PyErr_SetString(PyExc_TypeError, "f must be callable");
+        return NULL;
+    }
+    int err = 0;
+    auto coef = _PyObject_AsVectorLongLong(poly_obj, &err);
+    if (err) return NULL;
+    if (coef.size() > 4) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] len(poly) <= 4");
+        return NULL;
+    }
+    if (n == 0) return PyLong_FromLong(0);
+    unsigned long long m = mod;
+    std::vector<unsigned long long> poly(coef.size());
+    for (size_t k = 0; k < coef.size(); k++) poly[k] = safe_mod(coef[k], mod);
+
+    internal::multiplicative_sum_impl *impl;
+    Py_BEGIN_ALLOW_THREADS
+    impl = new internal::multiplicative_sum_impl(n, poly, m);
+    Py_END_ALLOW_THREADS
+    std::unique_ptr<internal::multiplicative_sum_impl> holder(impl);
+
+    // f(p) from poly, f(p^e) for e >= 2 from the callback
+    PyObject *mod_obj = PyLong_FromLongLong(mod);
+    if (mod_obj == NULL) return NULL;
+    for (unsigned int p : impl->primes) {
+        impl->fpe_offset.push_back(impl->fpe.size());
+        unsigned long long fp = 0;
+        for (size_t k = poly.size(); k-- > 0;) fp = (fp * (p % m) + poly[k]) % m;
+        impl->fpe.push_back(fp);
+        unsigned long long pe = (unsigned long long)p * p;
+        for (int e = 2;; e++, pe *= p) {
+            PyObject *v = PyObject_CallFunction(f_obj, "Ii", p, e);
+            PyObject *r = v == NULL ? NULL : PyNumber_Remainder(v, mod_obj);
+            Py_XDECREF(v);
+            if (r == NULL) {
+                Py_DECREF(mod_obj);
+                return NULL;
+            }
+            impl->fpe.push_back(PyLong_AsUnsignedLongLong(r));
+            Py_DECREF(r);
+            if (PyErr_Occurred()) {
+                Py_DECREF(mod_obj);
+                return NULL;
+            }
+            if (pe > (unsigned long long)n / p) break;
+        }
+    }
+    Py_DECREF(mod_obj);
+
+    unsigned long long res;
+    Py_BEGIN_ALLOW_THREADS
+    res = (1 + impl->sum(n, 0)) % m;
+    Py_END_ALLOW_THREADS
+    return PyLong_FromUnsignedLongLong(res);
+}
+
+PyDoc_STRVAR(multiplicative_sum_doc,
+"multiplicative_sum($module, n, poly, f, mod)\n"
+"--\n\n"
+"sum(f(i) for 1 <= i <= n) mod mod for a multiplicative function f\n"
+"(Lucy_Hedgehog's method for the primes, then Min_25's sieve)\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    upper bound (inclusive)\n"
+"poly : list[int]\n"
+"    f(p) = poly[0] + poly[1] * p + poly[2] * p^2 + ... for every prime p\n"
+"f : Callable[[int, int], int]\n"
+"    f(p, e) = f(p^e), called for e >= 2 and p <= sqrt(n) only\n"
+"mod : int\n"
+"    modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    the sum modulo mod (f(1) = 1)\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n <= 10^12\n"
+"len(poly) <= 4\n"
+"1 <= mod < 2^32\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(len(poly)n^(3/4) / log(n)) for the primes, plus the Min_25 recursion"
+);
+
+#define ACL_PYTHON_MULTIPLICATIVE_SUM_METHODDEF \
+    {"multiplicative_sum", (PyCFunction)multiplicative_sum, METH_VARARGS | METH_KEYWORDS, multiplicative_sum_doc},
+
+static PyObject *
+is_prime(PyObject *module, PyObject *arg) {
+    if (!PyLong_Check(arg)) {
+        PyErr_SetString(PyExc_TypeError, "is_prime() takes int");
+        return NULL;
+    }
+    unsigned long long n = PyLong_AsUnsignedLongLong(arg);
+    if (n == (unsigned long long)-1 && PyErr_Occurred()) {
+        PyErr_Clear();
+        CANNOT_CONVERT("is_prime", 0, "non-negative int less than 2^64");
+    }
+    if (is_prime_u64(n)) Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+PyDoc_STRVAR(is_prime_doc,
+"is_prime($module, n)\n"
+"--\n\n"
+"Miller-Rabin primality test for integer n\n"
+"It is deterministic for all n < 2^64.\n\n"
+"Parameters\n"
+"----------\n"
+"n: int\n"
+"    the number tested for primality\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : bool\n"
+"    whether n is prime or not\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n < 2^64\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(log(n))"
+);
+
+#define ACL_PYTHON_IS_PRIME_METHODDEF \
+    {"is_prime", (PyCFunction)is_prime, METH_O, is_prime_doc},
+
+
+/* bit i of the result (byte i / 8, from the least significant bit) is
+   whether a[i] is prime */
+static PyObject *
+is_prime_many(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"threads", NULL};
+    PyObject *a_obj;
+    int threads = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|$i", kwlist, &a_obj, &threads)) return NULL;
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must be non-negative");
+        return NULL;
+    }
+    int err = 0;
+    auto a = _PyObject_AsVectorUnsignedLongLong(a_obj, &err);
+    if (err) return NULL;
+    Py_ssize_t n = (Py_ssize_t)a.size();
+    PyObject *res = PyBytes_FromStringAndSize(NULL, (n + 7) / 8);
+    if (res == NULL) return NULL;
+    unsigned char *bits = (unsigned char *)PyBytes_AS_STRING(res);
+    // every task fills whole bytes
+    const Py_ssize_t chunk = 1 << 14;
+    int tasks = (int)((n + chunk - 1) / chunk);
+    threads = internal::resolve_threads(threads);
+    Py_BEGIN_ALLOW_THREADS
+    internal::parallel_for(tasks, threads, [&](int t) {
+        Py_ssize_t l = t * chunk, r = std::min(n, l + chunk);
+        for (Py_ssize_t i = l; i < r; i += 8) {
+            unsigned char b = 0;
+            for (Py_ssize_t j = i; j < std::min(r, i + 8); j++) {
+                b |= (unsigned char)is_prime_u64(a[j]) << (j - i);
+            }
+            bits[i >> 3] = b;
+        }
+    });
+    Py_END_ALLOW_THREADS
+    return res;
+}
+
+PyDoc_STRVAR(is_prime_many_doc,
+"is_prime_many($module, a, *, threads=0)\n"
+"--\n\n"
+"is_prime() for every element of a, as a bitmap:\n"
+"a[i] is prime iff (result[i // 8] >> (i % 8)) & 1.\n"
+"(numpy.unpackbits(numpy.frombuffer(result, numpy.uint8), bitorder='little')\n"
+"turns it into one byte per element.)\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int] | buffer of integers\n"
+"    the numbers tested for primality\n"
+"threads : int\n"
+"    number of threads (0: all the cores)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : bytes\n"
+"    bitmap of length (len(a) + 7) // 8\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= a[i] < 2^64\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nlog(max(a)))"
+);
+
+#define ACL_PYTHON_IS_PRIME_MANY_METHODDEF \
+    {"is_prime_many", (PyCFunction)is_prime_many, METH_VARARGS | METH_KEYWORDS, is_prime_many_doc},
+
+
+/* factorization  ******************************************/
+
+/*
+    >>> factorize(360)
+    [(2, 3), (3, 2), (5, 1)]
+    >>> primes, exponents, offsets = factorize_many([12, 1, 7])
+    >>> primes.tolist(), exponents.tolist(), offsets.tolist()
+    ([2, 3, 7], [2, 1, 1], [0, 2, 2, 3])
+        # the factors of a[i] are primes[offsets[i]:offsets[i + 1]]
+
+*/
+
+namespace internal {
+
+/* sorted (prime, exponent) pairs */
+static void
+factorize_pairs(unsigned long long n, std::vector<unsigned long long> &primes,
+                std::vector<unsigned char> &exponents) {
+    std::vector<unsigned long long> f;
+    factorize_u64(n, f);
+    std::sort(f.begin(), f.end());
+    for (size_t i = 0; i < f.size();) {
+        size_t j = i;
+        while (j < f.size() && f[j] == f[i]) j++;
+        primes.push_back(f[i]);
+        exponents.push_back((unsigned char)(j - i));
+        i = j;
+    }
+}
+
+} // namespace internal
+
+
+static PyObject *
+factorize(PyObject *module, PyObject *arg) {
+    if (!PyLong_Check(arg)) {
+        PyErr_SetString(PyExc_TypeError, "factorize() takes int");
+        return NULL;
+    }
+    unsigned long long n = PyLong_AsUnsignedLongLong(arg);
+    if ((n == (unsigned long long)-1 && PyErr_Occurred()) || n == 0) {
+        PyErr_Clear();
+        CANNOT_CONVERT("factorize", 0, "positive int less than 2^64");
+    }
+    std::vector<unsigned long long> primes;
+    std::vector<unsigned char> exponents;
+    internal::factorize_pairs(n, primes, exponents);
+    PyObject *list = PyList_New((Py_ssize_t)primes.size());
+    if (list == NULL) return NULL;
+    for (size_t i = 0; i < primes.size(); i++) {
+        PyObject *t = Py_BuildValue("(Ki)", primes[i], (int)exponents[i]);
+        if (t == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, t);
+    }
+    return list;
+}
+
+PyDoc_STRVAR(factorize_doc,
+"factorize($module, n)\n"
+"--\n\n"
+"Prime factorization of n\n"
+"(trial division by the primes below 2^10, then Pollard's rho)\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    the number to factorize\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : list[tuple[int, int]]\n"
+"    (prime, exponent) in increasing order of the primes; [] for n == 1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"1 <= n < 2^64\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n^(1/4)) expected"
+);
+
+#define ACL_PYTHON_FACTORIZE_METHODDEF \
+    {"factorize", (PyCFunction)factorize, METH_O, factorize_doc},
+
+
+static PyObject *
+factorize_many(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"a", (char *)"threads", NULL};
+    PyObject *a_obj;
+    int threads = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|$i", kwlist, &a_obj, &threads)) return NULL;
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must be non-negative");
+        return NULL;
+    }
+    int err = 0;
+    auto a = _PyObject_AsVectorUnsignedLongLong(a_obj, &err);
+    if (err) return NULL;
+    for (auto x : a) {
+        if (x == 0) {
+            PyErr_SetString(PyExc_ValueError, "[constraints] 1 <= a[i] < 2^64");
+            return NULL;
+        }
+    }
+    int n = (int)a.size();
+    const int chunk = 1 << 10;
+    int tasks = (n + chunk - 1) / chunk;
+    std::vector<std::vector<unsigned long long>> primes(tasks);
+    std::vector<std::vector<unsigned char>> exponents(tasks);
+    std::vector<long long> offsets(n + 1, 0);
+    threads = internal::resolve_threads(threads);
+    Py_BEGIN_ALLOW_THREADS
+    internal::parallel_for(tasks, threads, [&](int t) {
+        for (int i = t * chunk; i < std::min(n, (t + 1) * chunk); i++) {
+            size_t before = primes[t].size();
+            internal::factorize_pairs(a[i], primes[t], exponents[t]);
+            offsets[i + 1] = (long long)(primes[t].size() - before);
+        }
+    });
+    for (int i = 0; i < n; i++) offsets[i + 1] += offsets[i];
+    for (int t = 1; t < tasks; t++) {
+        primes[0].insert(primes[0].end(), primes[t].begin(), primes[t].end());
+        exponents[0].insert(exponents[0].end(), exponents[t].begin(), exponents[t].end());
+    }
+    Py_END_ALLOW_THREADS
+    if (tasks == 0) {
+        primes.emplace_back();
+        exponents.emplace_back();
+    }
+    PyObject *p_obj = _PyArray_FromVector(primes[0], "Q");
+    PyObject *e_obj = _PyArray_FromVector(exponents[0], "B");
+    PyObject *o_obj = _PyArray_FromVector(offsets, "q");
+    if (p_obj == NULL || e_obj == NULL || o_obj == NULL) {
+        Py_XDECREF(p_obj);
+        Py_XDECREF(e_obj);
+        Py_XDECREF(o_obj);
+        return NULL;
+    }
+    return Py_BuildValue("(NNN)", p_obj, e_obj, o_obj);
+}
+
+PyDoc_STRVAR(factorize_many_doc,
+"factorize_many($module, a, *, threads=0)\n"
+"--\n\n"
+"factorize() for every element of a, in CSR form:\n"
+"the factorization of a[i] is\n"
+"    zip(primes[offsets[i]:offsets[i + 1]], exponents[offsets[i]:offsets[i + 1]])\n\n"
+"Parameters\n"
+"----------\n"
+"a : list[int] | buffer of integers\n"
+"    the numbers to factorize\n"
+"threads : int\n"
+"    number of threads (0: all the cores)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : tuple[array.array, array.array, array.array]\n"
+"    primes ('Q'), exponents ('B') and offsets ('q', of length len(a) + 1)\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"1 <= a[i] < 2^64\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(sum(a[i]^(1/4))) expected"
+);
+
+#define ACL_PYTHON_FACTORIZE_MANY_METHODDEF \
+    {"factorize_many", (PyCFunction)factorize_many, METH_VARARGS | METH_KEYWORDS, factorize_many_doc},
+
+
+/* modular roots and logarithms  ***************************/
+
+/*
+    >>> primitive_root(998244353)
+    3
+    >>> discrete_log(3, 13, 17)     # 3^4 = 81 = 13 (mod 17)
+    4
+    >>> sqrt_mod(2, 7)              # 3^2 = 4^2 = 2 (mod 7)
+    3
+
+*/
+
+namespace internal {
+
+/* open addressing map from [0, 2^32) to int (the baby steps of BSGS) */
+struct bsgs_table {
+    int mask;
+    std::vector<unsigned int> keys;
+    std::vector<int> vals;   // -1: empty
+
+    explicit bsgs_table(int n) {
+        int size = 1;
+        while (size < 2 * n) size <<= 1;
+        mask = size - 1;
+        keys.assign(size, 0);
+        vals.assign(size, -1);
+    }
+
+    int slot(unsigned int key) const {
+        return (int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+    }
+
+    void set(unsigned int key, int val) {
+        int i = slot(key);
+        while (vals[i] != -1 && keys[i] != key) i = (i + 1) & mask;
+        keys[i] = key;
+        vals[i] = val;
+    }
+
+    int get(unsigned int key) const {
+        for (int i = slot(key); vals[i] != -1; i = (i + 1) & mask) {
+            if (keys[i] == key) return vals[i];
+        }
+        return -1;
+    }
+};
+
+/* the least x >= 0 with a^x = b (mod m), or -1 */
+static long long
+discrete_log_impl(long long a, long long b, long long m) {
+    a = safe_mod(a, m);
+    b = safe_mod(b, m);
+    // a^x = b  ->  k a^(x - add) = b (mod m) with gcd(a, m) = 1
+    long long k = 1 % m, add = 0;
+    for (long long g; (g = inv_gcd(a, m).first) > 1;) {
+        if (b == k) return add;
+        if (b % g) return -1;
+        b /= g;
+        m /= g;
+        add++;
+        k = k * (a / g) % m;
+    }
+    if (b == k) return add;
+    // k a^(in - j) = b  <->  k a^(in) = b a^j, 0 <= j < n, 1 <= i <= n
+    int n = 1;
+    while ((long long)n * n < m) n++;
+    bsgs_table baby(n);
+    unsigned long long x = b;
+    for (int j = 0; j < n; j++) {
+        baby.set((unsigned int)x, j);
+        x = x * a % m;
+    }
+    unsigned long long an = pow_mod_constexpr(a, n, (int)m), y = k;
+    for (int i = 1; i <= n; i++) {
+        y = y * an % m;
+        int j = baby.get((unsigned int)y);
+        if (j != -1) return add + (long long)i * n - j;
+    }
+    return -1;
+}
+
+/* the least primitive root of m, or -1 if there is none */
+static long long
+primitive_root_impl(long long m) {
+    if (m <= 4) return m - 1;
+    if (is_prime_constexpr((int)m)) return primitive_root_constexpr((int)m);
+    // m must be p^e or 2p^e for an odd prime p
+    long long odd = m % 2 == 0 ? m / 2 : m;
+    if (odd % 2 == 0) return -1;
+    std::vector<unsigned long long> f;
+    factorize_u64(odd, f);
+    std::sort(f.begin(), f.end());
+    if (f.front() != f.back()) return -1;
+    long long p = f[0], phi = odd / p * (p - 1);
+    // the prime factors of phi = p^(e-1) (p - 1)
+    f.clear();
+    factorize_u64(p - 1, f);
+    if (odd != p) f.push_back(p);
+    std::sort(f.begin(), f.end());
+    f.erase(std::unique(f.begin(), f.end()), f.end());
+    for (long long g = 2;; g++) {
+        if (inv_gcd(g, m).first != 1) continue;
+        bool ok = true;
+        for (auto q : f) {
+            if (pow_mod_constexpr(g, phi / q, (int)m) == 1) {
+                ok = false;
+                break;
+            }
+        }
+        if (ok) return g;
+    }
+}
+
+} // namespace internal
+
+
+static PyObject *
+primitive_root(PyObject *module, PyObject *arg) {
+    long long m = PyLong_AsLongLong(arg);
+    if (m == -1 && PyErr_Occurred()) return NULL;
+    if (m < 1 || m >= (1LL << 31)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 1 <= m < 2^31");
+        return NULL;
+    }
+    long long g = internal::primitive_root_impl(m);
+    if (g < 0) {
+        PyErr_Format(PyExc_ValueError, "%lld has no primitive root", m);
+        return NULL;
+    }
+    return PyLong_FromLongLong(g);
+}
+
+PyDoc_STRVAR(primitive_root_doc,
+"primitive_root($module, m)\n"
+"--\n\n"
+"The least primitive root modulo m\n"
+"(it exists iff m is 1, 2, 4, p^e or 2p^e for an odd prime p;\n"
+"ValueError otherwise)\n\n"
+"Parameters\n"
+"----------\n"
+"m : int\n"
+"    modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    the least g in [0, m) generating the units modulo m\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"1 <= m < 2^31\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(m^(1/4) + glog(m)^2), g: the answer"
+);
+
+#define ACL_PYTHON_PRIMITIVE_ROOT_METHODDEF \
+    {"primitive_root", (PyCFunction)primitive_root, METH_O, primitive_root_doc},
+
+
+static PyObject *
+discrete_log(PyObject *module, PyObject *const *args, Py_ssize_t nargs) {
+    const char *name = "discrete_log";
+    long long a = 0, b = 0, m = 0;
+    if (nargs != 3) NARGS_VIOLATION(name, 3);
+    int overflow;
+    CONVERT_LONG_LONG(a, 0, overflow, name);
+    CONVERT_LONG_LONG(b, 1, overflow, name);
+    CONVERT_LONG_LONG(m, 2, overflow, name);
+    if (m < 1 || m >= (1LL << 31)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 1 <= m < 2^31");
+        return NULL;
+    }
+    long long x;
+    Py_BEGIN_ALLOW_THREADS
+    x = internal::discrete_log_impl(a, b, m);
+    Py_END_ALLOW_THREADS
+    return PyLong_FromLongLong(x);
+}
+
+PyDoc_STRVAR(discrete_log_doc,
+"discrete_log($module, a, b, m)\n"
+"--\n\n"
+"The least x >= 0 with a^x = b (mod m), or -1 if there is none\n"
+"(baby-step giant-step; a and m need not be coprime)\n\n"
+"Parameters\n"
+"----------\n"
+"a : int\n"
+"    base\n"
+"b : int\n"
+"    target\n"
+"m : int\n"
+"    modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    the exponent, or -1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"-2^63 <= a, b < 2^63\n"
+"1 <= m < 2^31\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(sqrt(m))"
+);
+
+#define ACL_PYTHON_DISCRETE_LOG_METHODDEF \
+    {"discrete_log", (PyCFunction)(void(*)(void))discrete_log, METH_FASTCALL, discrete_log_doc},
+
+
+static PyObject *
+sqrt_mod(PyObject *module, PyObject *const *args, Py_ssize_t nargs) {
+    const char *name = "sqrt_mod";
+    long long a = 0, p = 0;
+    if (nargs != 2) NARGS_VIOLATION(name, 2);
+    int overflow;
+    CONVERT_LONG_LONG(a, 0, overflow, name);
+    CONVERT_LONG_LONG(p, 1, overflow, name);
+    if (p < 2 || p >= (1LL << 31) || !is_prime_constexpr((int)p)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] p is a prime less than 2^31");
+        return NULL;
+    }
+    long long x = sqrt_mod_constexpr(a, (int)p);
+    if (x > p - x) x = p - x;
+    return PyLong_FromLongLong(x);
+}
+
+PyDoc_STRVAR(sqrt_mod_doc,
+"sqrt_mod($module, a, p)\n"
+"--\n\n"
+"The least x >= 0 with x^2 = a (mod p), or -1 if a is not a square\n"
+"(Tonelli-Shanks; the other root is (p - x) % p)\n\n"
+"Parameters\n"
+"----------\n"
+"a : int\n"
+"    integer\n"
+"p : int\n"
+"    prime modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    the root, or -1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"-2^63 <= a < 2^63\n"
+"2 <= p < 2^31, p is prime\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(log(p)^2)"
+);
+
+#define ACL_PYTHON_SQRT_MOD_METHODDEF \
+    {"sqrt_mod", (PyCFunction)(void(*)(void))sqrt_mod, METH_FASTCALL, sqrt_mod_doc},
+
+
+/* sieves  *************************************************/
+
+/*
+    >>> primes_upto(30).tolist()
+    [2, 3, 5, 7, 11, 13, 17, 19, 23, 29]
+    >>> prime_range(100, 130).tolist()
+    [101, 103, 107, 109, 113, 127]
+    >>> linear_sieve(10).tolist()
+    [0, 1, 2, 3, 2, 5, 2, 7, 2, 3, 2]
+
+*/
+
+#define SIEVE_MAX (1ULL << 48)
+
+/* "O&" converter: non-negative int less than 2^64 */
+static int
+sieve_bound_converter(PyObject *obj, void *ptr) {
+    if (!PyLong_Check(obj)) {
+        PyErr_SetString(PyExc_TypeError, "required : int");
+        return 0;
+    }
+    unsigned long long v = PyLong_AsUnsignedLongLong(obj);
+    if (v == (unsigned long long)-1 && PyErr_Occurred()) {
+        PyErr_Clear();
+        PyErr_SetString(PyExc_ValueError, "[constraints] bounds must be in [0, 2^48]");
+        return 0;
+    }
+    *(unsigned long long *)ptr = v;
+    return 1;
+}
+
+/* array('I') if every prime fits in 32 bits, array('Q') otherwise */
+static PyObject *
+sieve_range_array(unsigned long long lo, unsigned long long hi, int threads) {
+    threads = internal::resolve_threads(threads);
+    if (hi <= (1ULL << 32)) {
+        std::vector<unsigned int> primes;
+        Py_BEGIN_ALLOW_THREADS
+        primes = internal::sieve_range<unsigned int>(lo, hi, threads);
+        Py_END_ALLOW_THREADS
+        return _PyArray_FromVector(primes, "I");
+    }
+    std::vector<unsigned long long> primes;
+    Py_BEGIN_ALLOW_THREADS
+    primes = internal::sieve_range<unsigned long long>(lo, hi, threads);
+    Py_END_ALLOW_THREADS
+    return _PyArray_FromVector(primes, "Q");
+}
+
+static PyObject *
+primes_upto(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"n", (char *)"threads", NULL};
+    unsigned long long n;
+    int threads = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|$i", kwlist, sieve_bound_converter, &n, &threads)) return NULL;
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must be non-negative");
+        return NULL;
+    }
+    if (n >= SIEVE_MAX) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n < 2^48");
+        return NULL;
+    }
+    return sieve_range_array(0, n + 1, threads);
+}
+
+PyDoc_STRVAR(primes_upto_doc,
+"primes_upto($module, n, *, threads=0)\n"
+"--\n\n"
+"The primes less than or equal to n, in increasing order\n"
+"(segmented sieve of Eratosthenes over the odd numbers)\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    upper bound (inclusive)\n"
+"threads : int\n"
+"    number of threads (0: all the cores)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'I' if n < 2^32, 'Q' otherwise\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n < 2^48\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nloglog(n))"
+);
+
+#define ACL_PYTHON_PRIMES_UPTO_METHODDEF \
+    {"primes_upto", (PyCFunction)primes_upto, METH_VARARGS | METH_KEYWORDS, primes_upto_doc},
+
+
+static PyObject *
+prime_range(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"lo", (char *)"hi", (char *)"threads", NULL};
+    unsigned long long lo, hi;
+    int threads = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&|$i", kwlist, sieve_bound_converter, &lo,
+                                     sieve_bound_converter, &hi, &threads)) return NULL;
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must be non-negative");
+        return NULL;
+    }
+    if (lo > hi || hi > SIEVE_MAX) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= lo <= hi <= 2^48");
+        return NULL;
+    }
+    return sieve_range_array(lo, hi, threads);
+}
+
+PyDoc_STRVAR(prime_range_doc,
+"prime_range($module, lo, hi, *, threads=0)\n"
+"--\n\n"
+"The primes p with lo <= p < hi, in increasing order\n"
+"(only the segments covering [lo, hi) are sieved)\n\n"
+"Parameters\n"
+"----------\n"
+"lo : int\n"
+"    lower bound (inclusive)\n"
+"hi : int\n"
+"    upper bound (exclusive)\n"
+"threads : int\n"
+"    number of threads (0: all the cores)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'I' if hi <= 2^32, 'Q' otherwise\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= lo <= hi <= 2^48\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F((hi - lo)loglog(hi) + sqrt(hi))"
+);
+
+#define ACL_PYTHON_PRIME_RANGE_METHODDEF \
+    {"prime_range", (PyCFunction)prime_range, METH_VARARGS | METH_KEYWORDS, prime_range_doc},
+
+
+static PyObject *
+linear_sieve(PyObject *module, PyObject *arg) {
+    long long n = PyLong_AsLongLong(arg);
+    if (n == -1 && PyErr_Occurred()) return NULL;
+    if (n < 0 || n > 1000000000) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n <= 10^9");
+        return NULL;
+    }
+    std::vector<int> spf;
+    Py_BEGIN_ALLOW_THREADS
+    spf = internal::linear_sieve_spf((int)n);
+    Py_END_ALLOW_THREADS
+    return _PyArray_FromVector(spf, "i");
+}
+
+PyDoc_STRVAR(linear_sieve_doc,
+"linear_sieve($module, n)\n"
+"--\n\n"
+"Smallest prime factor of every integer in [0, n]\n"
+"(spf[0] = 0, spf[1] = 1, spf[p] = p for a prime p)\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    upper bound (inclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"spf : array.array\n"
+"    typecode 'i', of length n + 1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n <= 10^9\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n)"
+);
+
+#define ACL_PYTHON_LINEAR_SIEVE_METHODDEF \
+    {"linear_sieve", (PyCFunction)linear_sieve, METH_O, linear_sieve_doc},
+
+
+/* arithmetic-function tables  *****************************/
+
+/*
+    >>> totient_table(10).tolist()
+    [0, 1, 1, 2, 2, 4, 2, 6, 4, 6, 4]
+    >>> phi, mu = arithmetic_tables(10, ["totient", "mobius"])    # one sieve pass
+
+*/
+
+#define ARITHMETIC_TABLE_MAX 1000000000
+
+/* the tables listed in which (0: totient, 1: mobius, 2: divisor_count,
+   3: divisor_sum) as a tuple of arrays */
+static PyObject *
+arithmetic_tables_impl(PyObject *n_obj, const std::vector<int> &which) {
+    long long n = PyLong_AsLongLong(n_obj);
+    if (n == -1 && PyErr_Occurred()) return NULL;
+    if (n < 0 || n > ARITHMETIC_TABLE_MAX) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n <= 10^9");
+        return NULL;
+    }
+    std::vector<int> phi, d;
+    std::vector<signed char> mu;
+    std::vector<long long> sigma;
+    internal::arithmetic_tables t;
+    for (int j : which) {
+        if (j == 0) t.totient = &phi;
+        if (j == 1) t.mobius = &mu;
+        if (j == 2) t.divisor_count = &d;
+        if (j == 3) t.divisor_sum = &sigma;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    internal::arithmetic_sieve((int)n, t);
+    Py_END_ALLOW_THREADS
+
+    PyObject *res = PyTuple_New((Py_ssize_t)which.size());
+    if (res == NULL) return NULL;
+    for (size_t i = 0; i < which.size(); i++) {
+        PyObject *a;
+        if (which[i] == 0) a = _PyArray_FromVector(phi, "i");
+        else if (which[i] == 1) a = _PyArray_FromVector(mu, "b");
+        else if (which[i] == 2) a = _PyArray_FromVector(d, "i");
+        else a = _PyArray_FromVector(sigma, "q");
+        if (a == NULL) {
+            Py_DECREF(res);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(res, i, a);
+    }
+    return res;
+}
+
+static PyObject *
+arithmetic_tables(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"n", (char *)"kinds", NULL};
+    static const char *names[] = {"totient", "mobius", "divisor_count", "divisor_sum"};
+    PyObject *n_obj, *kinds_obj;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", kwlist, &n_obj, &kinds_obj)) return NULL;
+    if (PyUnicode_Check(kinds_obj)) {
+        PyErr_SetString(PyExc_TypeError, "kinds must be a sequence of str");
+        return NULL;
+    }
+    PyObject *kinds = PySequence_Fast(kinds_obj, "kinds must be a sequence of str");
+    if (kinds == NULL) return NULL;
+    Py_ssize_t k = PySequence_Fast_GET_SIZE(kinds);
+    std::vector<int> which(k, -1);
+    for (Py_ssize_t i = 0; i < k; i++) {
+        PyObject *s = PySequence_Fast_GET_ITEM(kinds, i);
+        for (int j = 0; j < 4; j++) {
+            if (PyUnicode_Check(s) && PyUnicode_CompareWithASCIIString(s, names[j]) == 0) which[i] = j;
+        }
+        if (which[i] < 0) {
+            PyErr_Format(PyExc_ValueError, "unknown table: %R", s);
+            Py_DECREF(kinds);
+            return NULL;
+        }
+    }
+    Py_DECREF(kinds);
+    return arithmetic_tables_impl(n_obj, which);
+}
+
+PyDoc_STRVAR(arithmetic_tables_doc,
+"arithmetic_tables($module, n, kinds)\n"
+"--\n\n"
+"Several tables of 0..n computed in a single linear sieve pass\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    upper bound (inclusive)\n"
+"kinds : list[str]\n"
+"    any of \"totient\", \"mobius\", \"divisor_count\" and \"divisor_sum\"\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : tuple[array.array, ...]\n"
+"    the tables in the order of kinds, as returned by totient_table() etc.\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n <= 10^9\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n)"
+);
+
+#define ACL_PYTHON_ARITHMETIC_TABLES_METHODDEF \
+    {"arithmetic_tables", (PyCFunction)arithmetic_tables, METH_VARARGS | METH_KEYWORDS, arithmetic_tables_doc},
+
+
+/* one table of the sieve above */
+static PyObject *
+arithmetic_table(PyObject *n_obj, int kind) {
+    PyObject *t = arithmetic_tables_impl(n_obj, {kind});
+    if (t == NULL) return NULL;
+    PyObject *res = PyTuple_GET_ITEM(t, 0);
+    Py_INCREF(res);
+    Py_DECREF(t);
+    return res;
+}
+
+static PyObject *
+totient_table(PyObject *module, PyObject *arg) {
+    return arithmetic_table(arg, 0);
+}
+
+static PyObject *
+mobius_table(PyObject *module, PyObject *arg) {
+    return arithmetic_table(arg, 1);
+}
+
+static PyObject *
+divisor_count_table(PyObject *module, PyObject *arg) {
+    return arithmetic_table(arg, 2);
+}
+
+static PyObject *
+divisor_sum_table(PyObject *module, PyObject *arg) {
+    return arithmetic_table(arg, 3);
+}
+
+PyDoc_STRVAR(totient_table_doc,
+"totient_table($module, n)\n"
+"--\n\n"
+"Euler's totient phi(i) for 0 <= i <= n (phi(0) = 0)\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    upper bound (inclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'i', of length n + 1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n <= 10^9\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n)"
+);
+
+PyDoc_STRVAR(mobius_table_doc,
+"mobius_table($module, n)\n"
+"--\n\n"
+"Moebius function mu(i) for 0 <= i <= n (mu(0) = 0)\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    upper bound (inclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'b', of length n + 1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n <= 10^9\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n)"
+);
+
+PyDoc_STRVAR(divisor_count_table_doc,
+"divisor_count_table($module, n)\n"
+"--\n\n"
+"Number of divisors d(i) for 0 <= i <= n (d(0) = 0)\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    upper bound (inclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'i', of length n + 1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n <= 10^9\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n)"
+);
+
+PyDoc_STRVAR(divisor_sum_table_doc,
+"divisor_sum_table($module, n)\n"
+"--\n\n"
+"Sum of divisors sigma(i) for 0 <= i <= n (sigma(0) = 0)\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    upper bound (inclusive)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'q', of length n + 1\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= n <= 10^9\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n)"
+);
+
+#define ACL_PYTHON_TOTIENT_TABLE_METHODDEF \
+    {"totient_table", (PyCFunction)totient_table, METH_O, totient_table_doc},
+
+#define ACL_PYTHON_MOBIUS_TABLE_METHODDEF \
+    {"mobius_table", (PyCFunction)mobius_table, METH_O, mobius_table_doc},
+
+#define ACL_PYTHON_DIVISOR_COUNT_TABLE_METHODDEF \
+    {"divisor_count_table", (PyCFunction)divisor_count_table, METH_O, divisor_count_table_doc},
+
+#define ACL_PYTHON_DIVISOR_SUM_TABLE_METHODDEF \
+    {"divisor_sum_table", (PyCFunction)divisor_sum_table, METH_O, divisor_sum_table_doc},
+
+
+/* linear recurrence  **************************************/
+
+/* a[n] = c[0] a[n-1] + c[1] a[n-2] + ... + c[d-1] a[n-d]
+
+    >>> berlekamp_massey([1, 1, 2, 3, 5, 8])
+    [1, 1]                          # Fibonacci
+    >>> linear_recurrence_nth([1, 1], [0, 1], 10)
+    55
+
+*/
+
+namespace internal {
+
+/* the shortest recurrence; mod is prime */
+static std::vector<unsigned int>
+berlekamp_massey_impl(const std::vector<unsigned int> &s, unsigned int mod) {
+    std::vector<unsigned int> c = {1}, b = {1};
+    int l = 0, m = 1;
+    unsigned int bd = 1;
+    for (int n = 0; n < (int)s.size(); n++) {
+        unsigned long long d = s[n];
+        for (int i = 1; i <= l; i++) d = (d + (unsigned long long)c[i] * s[n - i]) % mod;
+        if (d == 0) {
+            m++;
+            continue;
+        }
+        // c <- c - (d / bd) x^m b
+        unsigned int coef = (unsigned int)(d * pow_mod_constexpr(bd, mod - 2, mod) % mod);
+        std::vector<unsigned int> t = c;
+        if (c.size() < b.size() + m) c.resize(b.size() + m, 0);
+        for (int i = 0; i < (int)b.size(); i++) {
+            unsigned int v = (unsigned int)((unsigned long long)coef * b[i] % mod);
+            c[i + m] = c[i + m] >= v ? c[i + m] - v : c[i + m] + mod - v;
+        }
+        if (2 * l <= n) {
+            l = n + 1 - l;
+            b = std::move(t);
+            bd = (unsigned int)d;
+            m = 1;
+        } else {
+            m++;
+        }
+    }
+    std::vector<unsigned int> res(l);
+    for (int i = 0; i < l; i++) res[i] = c[i + 1] ? mod - c[i + 1] : 0;
+    return res;
+}
+
+/* Bostan-Mori: [x^k] P / Q  with  Q = 1 - sum c[j] x^{j+1},  P = (A Q) mod x^d.
+   Each step replaces P / Q by  (P(x) Q(-x))_{even or odd} / (Q(x) Q(-x))_{even}.
+   In the bit-reversed output of the forward transform the frequencies
+   w and -w sit next to each other, so the transform of Q(-x) is the
+   transform of Q with the neighbours swapped. Without an NTT-friendly
+   mod the products are schoolbook. */
+static unsigned int
+linear_recurrence_nth_impl(const std::vector<unsigned int> &c, const std::vector<unsigned int> &a,
+                           unsigned long long k, unsigned int mod, bool use_ntt) {
+    int d = (int)c.size();
+    if (k < (unsigned long long)d) return a[k];
+    std::vector<unsigned int> q(d + 1), p(d);
+    q[0] = 1 % mod;
+    for (int i = 0; i < d; i++) q[i + 1] = c[i] ? mod - c[i] : 0;
+
+    if (use_ntt) {
+        p = convolution_mod(a, q, mod);
+        p.resize(d);
+        int z = 1 << ceil_pow2(2 * d + 1);
+        auto f = ntt_get_info(mod, z);
+        std::vector<unsigned int> u(z), v(z), w(z);
+        while (k) {
+            std::fill(std::copy(p.begin(), p.end(), u.begin()), u.end(), 0);
+            std::fill(std::copy(q.begin(), q.end(), v.begin()), v.end(), 0);
+            ntt_forward(u, *f);
+            ntt_forward(v, *f);
+            for (int i = 0; i < z; i += 2) {
+                w[i] = v[i + 1];
+                w[i + 1] = v[i];
+            }
+            ntt_mul(u, w, *f);
+            ntt_mul(v, w, *f);
+            ntt_inverse(u, *f);
+            ntt_inverse(v, *f);
+            for (int i = 0; i < d; i++) p[i] = u[2 * i + (k & 1)];
+            for (int i = 0; i <= d; i++) q[i] = v[2 * i];
+            k >>= 1;
+        }
+    } else {
+        for (int i = 0; i < d; i++) {
+            unsigned long long s = 0;
+            for (int j = 0; j <= i; j++) s = (s + (unsigned long long)a[i - j] * q[j]) % mod;
+            p[i] = (unsigned int)s;
+        }
+        std::vector<unsigned long long> u(2 * d + 1), v(2 * d + 1);
+        while (k) {
+            std::fill(u.begin(), u.end(), 0);
+            std::fill(v.begin(), v.end(), 0);
+            for (int j = 0; j <= d; j++) {
+                unsigned int qn = (j & 1) && q[j] ? mod - q[j] : q[j];
+                for (int i = 0; i < d; i++) u[i + j] = (u[i + j] + (unsigned long long)p[i] * qn) % mod;
+                for (int i = 0; i <= d; i++) v[i + j] = (v[i + j] + (unsigned long long)q[i] * qn) % mod;
+            }
+            for (int i = 0; i < d; i++) p[i] = (unsigned int)u[2 * i + (k & 1)];
+            for (int i = 0; i <= d; i++) q[i] = (unsigned int)v[2 * i];
+            k >>= 1;
+        }
+    }
+    // q[0] == 1
+    return p[0];
+}
+
+} // namespace internal
+
+
+static PyObject *
+berlekamp_massey(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"seq", (char *)"mod", NULL};
+    PyObject *s_obj;
+    long long mod = 998244353;
+    std::vector<unsigned int> s, r;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|L", kwlist, &s_obj, &mod)) return NULL;
+    if (mod < 2 || mod >= (1LL << 31) || !is_prime_constexpr((int)mod)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] mod is a prime less than 2^31");
+        return NULL;
+    }
+    int err = 0;
+    auto v = _PyObject_AsVectorLongLong(s_obj, &err);
+    if (err) return NULL;
+    s.resize(v.size());
+    for (size_t i = 0; i < v.size(); i++) s[i] = (unsigned int)safe_mod(v[i], mod);
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::berlekamp_massey_impl(s, (unsigned int)mod);
+    Py_END_ALLOW_THREADS
+    return _PyList_FromVector(r);
+}
+
+PyDoc_STRVAR(berlekamp_massey_doc,
+"berlekamp_massey($module, seq, mod=998244353)\n"
+"--\n\n"
+"It returns the coefficients c of the shortest linear recurrence\n"
+"    seq[i] == c[0] seq[i-1] + ... + c[d-1] seq[i-d]  (mod `mod`)\n"
+"satisfied by seq for all d <= i < len(seq).\n"
+"A recurrence of order d is determined by 2d terms.\n\n"
+"Parameters\n"
+"----------\n"
+"seq : list[int] | buffer of integers\n"
+"    terms of the sequence\n"
+"mod : int\n"
+"    prime modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"c : list[int]\n"
+"    coefficients of the recurrence\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"mod is a prime less than 2^31\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n^2)"
+);
+
+#define ACL_PYTHON_BERLEKAMP_MASSEY_METHODDEF \
+    {"berlekamp_massey", (PyCFunction)berlekamp_massey, METH_VARARGS | METH_KEYWORDS, berlekamp_massey_doc},
+
+
+static PyObject *
+linear_recurrence_nth(PyObject *module, PyObject *args, PyObject *kwargs) {
+    static char *kwlist[] = {(char *)"coeffs", (char *)"init", (char *)"k", (char *)"mod", NULL};
+    PyObject *c_obj, *a_obj, *k_obj;
+    long long mod = 998244353;
+    std::vector<unsigned int> c, a;
+    unsigned int r;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|L", kwlist, &c_obj, &a_obj, &k_obj, &mod)) return NULL;
+    unsigned long long k = PyLong_AsUnsignedLongLong(k_obj);
+    if (k == (unsigned long long)-1 && PyErr_Occurred()) {
+        if (PyErr_ExceptionMatches(PyExc_OverflowError)) {
+            PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= k < 2^64");
+        }
+        return NULL;
+    }
+    if (mod < 1 || mod >= (1LL << 31)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 1 <= mod < 2^31");
+        return NULL;
+    }
+    int err = 0;
+    auto cv = _PyObject_AsVectorLongLong(c_obj, &err);
+    if (err) return NULL;
+    auto av = _PyObject_AsVectorLongLong(a_obj, &err);
+    if (err) return NULL;
+    if (av.size() < cv.size()) {
+        PyErr_SetString(PyExc_ValueError, "len(init) >= len(coeffs) is required");
+        return NULL;
+    }
+    int d = (int)cv.size();
+    if (d == 0) return PyLong_FromLong(0);
+    c.resize(d);
+    a.resize(d);
+    for (int i = 0; i < d; i++) {
+        c[i] = (unsigned int)safe_mod(cv[i], mod);
+        a[i] = (unsigned int)safe_mod(av[i], mod);
+    }
+    bool use_ntt = d >= 32 && is_prime_constexpr((int)mod)
+                   && (mod - 1) % (1LL << internal::ceil_pow2(2 * d + 1)) == 0;
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::linear_recurrence_nth_impl(c, a, k, (unsigned int)mod, use_ntt);
+    Py_END_ALLOW_THREADS
+    return PyLong_FromUnsignedLong(r);
+}
+
+PyDoc_STRVAR(linear_recurrence_nth_doc,
+"linear_recurrence_nth($module, coeffs, init, k, mod=998244353)\n"
+"--\n\n"
+"It returns a[k] in mod `mod` of the sequence defined by\n"
+"    a[i] = init[i]  (i < d)\n"
+"    a[i] = coeffs[0] a[i-1] + ... + coeffs[d-1] a[i-d]  (i >= d)\n"
+"where d = len(coeffs). If d == 0, it returns 0.\n\n"
+"Parameters\n"
+"----------\n"
+"coeffs : list[int] | buffer of integers\n"
+"    coefficients of the recurrence (as returned by berlekamp_massey)\n"
+"init : list[int] | buffer of integers\n"
+"    first terms; only the first d are used\n"
+"k : int\n"
+"    index of the term\n"
+"mod : int\n"
+"    modulus\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    a[k] in mod `mod`\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"len(init) >= len(coeffs)\n"
+"0 <= k < 2^64\n"
+"1 <= mod < 2^31\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(dlogdlogk) if mod is a prime and (mod - 1) is divisible by 2 * bit_ceil(d + 1),\n"
+"\u039F(d^2logk) otherwise"
+);
+
+#define ACL_PYTHON_LINEAR_RECURRENCE_NTH_METHODDEF \
+    {"linear_recurrence_nth", (PyCFunction)linear_recurrence_nth, METH_VARARGS | METH_KEYWORDS, linear_recurrence_nth_doc},
 
 
 PyMethodDef mathfunctions[] = {
     ACL_PYTHON_INV_MOD_METHODDEF
     ACL_PYTHON_CRT_METHODDEF
+    ACL_PYTHON_CRT_BIG_METHODDEF
+    ACL_PYTHON_GARNER_METHODDEF
     ACL_PYTHON_FLOOR_SUM_METHODDEF
+    ACL_PYTHON_FLOOR_SUM_MANY_METHODDEF
+    ACL_PYTHON_FLOOR_SUM_EX_METHODDEF
+    ACL_PYTHON_PRIME_COUNT_METHODDEF
+    ACL_PYTHON_MULTIPLICATIVE_SUM_METHODDEF
     ACL_PYTHON_IS_PRIME_METHODDEF
+    ACL_PYTHON_IS_PRIME_MANY_METHODDEF
+    ACL_PYTHON_FACTORIZE_METHODDEF
+    ACL_PYTHON_FACTORIZE_MANY_METHODDEF
+    ACL_PYTHON_PRIMITIVE_ROOT_METHODDEF
+    ACL_PYTHON_DISCRETE_LOG_METHODDEF
+    ACL_PYTHON_SQRT_MOD_METHODDEF
+    ACL_PYTHON_PRIMES_UPTO_METHODDEF
+    ACL_PYTHON_PRIME_RANGE_METHODDEF
+    ACL_PYTHON_LINEAR_SIEVE_METHODDEF
+    ACL_PYTHON_TOTIENT_TABLE_METHODDEF
+    ACL_PYTHON_MOBIUS_TABLE_METHODDEF
+    ACL_PYTHON_DIVISOR_COUNT_TABLE_METHODDEF
+    ACL_PYTHON_DIVISOR_SUM_TABLE_METHODDEF
+    ACL_PYTHON_ARITHMETIC_TABLES_METHODDEF
+    ACL_PYTHON_BERLEKAMP_MASSEY_METHODDEF
+    ACL_PYTHON_LINEAR_RECURRENCE_NTH_METHODDEF
     {NULL} /* Sentinel */
 };
 
@@ -0,0 +1,1090 @@
+#ifndef ACL_PYTHON_MODMATRIX
+#define ACL_PYTHON_MODMATRIX
+
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <structmember.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+
+#include "atcoder/utils"
+#include "atcoder/internal_cpu"
+#include "atcoder/internal_math"
+#include "atcoder/modint"
+
+
+
+namespace atcoder_python {
+
+
+/* modmatrix object ***************************************/
+
+/* Dense matrix over Z/mZ, where m is the mod of ModInt.
+
+    >>> ModInt.set_mod(998244353)
+    >>> a = ModMatrix([[1, 1], [1, 0]])
+    >>> a ** 10
+    ModMatrix([[89, 55], [55, 34]])
+    >>> a.det()
+    998244352           # -1
+    >>> a.inv()
+    ModMatrix([[0, 1], [1, 998244352]])
+    >>> a @ a.inv() == ModMatrix.identity(2)
+    True
+    >>> a.solve([3, 2])
+    [2, 1]              # x + y == 3, x == 2
+
+    The elements are stored row-major in one array. A matrix remembers the
+    mod it was made with, and it refuses to work after ModInt.set_mod()
+    has changed the mod.
+
+*/
+
+
+extern PyTypeObject ModMatrixType;
+
+#define ModMatrix_Check(v) PyObject_TypeCheck(v, &ModMatrixType)
+
+
+struct ModMatrixObject
+{
+    PyObject_HEAD
+    int n, m;
+    unsigned int mod;
+    std::vector<unsigned int> a;
+};
+
+
+namespace internal {
+
+/* The mod and the Barrett constant of ModInt, copied so that the kernels
+   can run without the GIL. */
+struct modmatrix_barrett {
+    unsigned int mod;
+    unsigned long long im;
+
+    modmatrix_barrett() : mod(ModIntObject::mod), im(ModIntObject::im) {}
+
+    /* any z < 2^64 */
+    unsigned int reduce(unsigned long long z) const {
+        unsigned long long x = (unsigned long long)(((unsigned __int128)z * im) >> 64);
+        unsigned long long y = x * mod;
+        return (unsigned int)(z - y + (z < y ? mod : 0));
+    }
+    unsigned int mul(unsigned int a, unsigned int b) const {
+        return reduce((unsigned long long)a * b);
+    }
+    unsigned int pow(unsigned int a, unsigned long long n) const {
+        unsigned int r = 1 % mod;
+        while (n) {
+            if (n & 1) r = mul(r, a);
+            a = mul(a, a);
+            n >>= 1;
+        }
+        return r;
+    }
+    /* mod is prime, a != 0 */
+    unsigned int inv(unsigned int a) const {
+        return pow(a, mod - 2);
+    }
+};
+
+
+/* multiplication ******************************************/
+
+/* acc[j] += x * b[j]  for j < n
+
+   C = A B is computed in IB x JB tiles of C whose rows are accumulated in
+   uint64 over KB-long strips of the inner dimension, so that the strip of
+   B stays in cache for the whole tile. An accumulator is reduced only
+   every `lazy` terms, as many as fit into 64 bits. */
+
+#define MODMATRIX_BLOCK_I 64
+#define MODMATRIX_BLOCK_J 256
+#define MODMATRIX_BLOCK_K 256
+
+typedef void (*modmatrix_axpy_t)(unsigned long long *acc, const unsigned int *b,
+                                 unsigned int x, int n);
+
+static void
+modmatrix_axpy_scalar(unsigned long long *acc, const unsigned int *b, unsigned int x, int n) {
+    for (int j = 0; j < n; j++) acc[j] += (unsigned long long)x * b[j];
+}
+
+#ifdef ACL_PYTHON_X86_SIMD
+
+ACL_PYTHON_TARGET_AVX2 static void
+modmatrix_axpy_avx2(unsigned long long *acc, const unsigned int *b, unsigned int x, int n) {
+    __m256i vx = _mm256_set1_epi64x(x);
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256i b0 = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(b + j)));
+        __m256i b1 = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(b + j + 4)));
+        __m256i a0 = _mm256_loadu_si256((const __m256i *)(acc + j));
+        __m256i a1 = _mm256_loadu_si256((const __m256i *)(acc + j + 4));
+        a0 = _mm256_add_epi64(a0, _mm256_mul_epu32(b0, vx));
+        a1 = _mm256_add_epi64(a1, _mm256_mul_epu32(b1, vx));
+        _mm256_storeu_si256((__m256i *)(acc + j), a0);
+        _mm256_storeu_si256((__m256i *)(acc + j + 4), a1);
+    }
+    for (; j < n; j++) acc[j] += (unsigned long long)x * b[j];
+}
+
+ACL_PYTHON_AVX512_BEGIN
+
+ACL_PYTHON_TARGET_AVX512 static void
+modmatrix_axpy_avx512(unsigned long long *acc, const unsigned int *b, unsigned int x, int n) {
+    __m512i vx = _mm512_set1_epi64(x);
+    int j = 0;
+    for (; j + 16 <= n; j += 16) {
+        __m512i b0 = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i *)(b + j)));
+        __m512i b1 = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i *)(b + j + 8)));
+        __m512i a0 = _mm512_loadu_si512((const void *)(acc + j));
+        __m512i a1 = _mm512_loadu_si512((const void *)(acc + j + 8));
+        a0 = _mm512_add_epi64(a0, _mm512_mul_epu32(b0, vx));
+        a1 = _mm512_add_epi64(a1, _mm512_mul_epu32(b1, vx));
+        _mm512_storeu_si512((void *)(acc + j), a0);
+        _mm512_storeu_si512((void *)(acc + j + 8), a1);
+    }
+    for (; j < n; j++) acc[j] += (unsigned long long)x * b[j];
+}
+
+ACL_PYTHON_AVX512_END
+
+#endif
+
+static modmatrix_axpy_t modmatrix_axpy = modmatrix_axpy_scalar;
+
+/* called once from PyInit_atcoder, after cpu_detect() */
+static void
+modmatrix_select_kernel() {
+    modmatrix_axpy = modmatrix_axpy_scalar;
+#ifdef ACL_PYTHON_X86_SIMD
+    if (cpu.avx2) modmatrix_axpy = modmatrix_axpy_avx2;
+    if (cpu.avx2 && cpu.avx512f && cpu.avx512bw) modmatrix_axpy = modmatrix_axpy_avx512;
+#endif
+}
+
+/* c (n x m) = a (n x l) * b (l x m) */
+static void
+modmatrix_mul_impl(const unsigned int *a, const unsigned int *b, unsigned int *c,
+                   int n, int l, int m, const modmatrix_barrett &bt) {
+    unsigned long long e = bt.mod - 1;
+    int lazy = e <= 1 ? l + 1 : (int)std::min<unsigned long long>(
+        (~0ULL - e) / (e * e), (unsigned long long)l + 1);
+    modmatrix_axpy_t axpy = modmatrix_axpy;
+    std::vector<unsigned long long> acc((size_t)MODMATRIX_BLOCK_I * MODMATRIX_BLOCK_J);
+    for (int ii = 0; ii < n; ii += MODMATRIX_BLOCK_I) {
+        int ie = std::min(n, ii + MODMATRIX_BLOCK_I);
+        for (int jj = 0; jj < m; jj += MODMATRIX_BLOCK_J) {
+            int w = std::min(m, jj + MODMATRIX_BLOCK_J) - jj;
+            std::fill(acc.begin(), acc.end(), 0);
+            for (int kk = 0; kk < l; kk += MODMATRIX_BLOCK_K) {
+                int ke = std::min(l, kk + MODMATRIX_BLOCK_K);
+                for (int i = ii; i < ie; i++) {
+                    unsigned long long *ac = acc.data() + (size_t)(i - ii) * MODMATRIX_BLOCK_J;
+                    const unsigned int *ar = a + (size_t)i * l;
+                    for (int k = kk; k < ke; k++) {
+                        if (ar[k]) axpy(ac, b + (size_t)k * m + jj, ar[k], w);
+                        if ((k + 1) % lazy == 0) {
+                            for (int j = 0; j < w; j++) ac[j] = bt.reduce(ac[j]);
+                        }
+                    }
+                }
+            }
+            for (int i = ii; i < ie; i++) {
+                const unsigned long long *ac = acc.data() + (size_t)(i - ii) * MODMATRIX_BLOCK_J;
+                unsigned int *cr = c + (size_t)i * m + jj;
+                for (int j = 0; j < w; j++) cr[j] = bt.reduce(ac[j]);
+            }
+        }
+    }
+}
+
+/* a^k for a square matrix of size n */
+static std::vector<unsigned int>
+modmatrix_pow_impl(std::vector<unsigned int> a, int n, unsigned long long k,
+                   const modmatrix_barrett &bt) {
+    std::vector<unsigned int> r((size_t)n * n, 0), t((size_t)n * n);
+    for (int i = 0; i < n; i++) r[(size_t)i * n + i] = 1 % bt.mod;
+    bool first = true;
+    while (k) {
+        if (k & 1) {
+            if (first) {
+                r = a;
+                first = false;
+            } else {
+                modmatrix_mul_impl(r.data(), a.data(), t.data(), n, n, n, bt);
+                std::swap(r, t);
+            }
+        }
+        k >>= 1;
+        if (k) {
+            modmatrix_mul_impl(a.data(), a.data(), t.data(), n, n, n, bt);
+            std::swap(a, t);
+        }
+    }
+    return r;
+}
+
+
+/* elimination ********************************************/
+
+/* Gaussian elimination on the first `cols` columns of the n x w matrix a.
+   The pivot rows are scaled to 1; with `reduced` the pivot columns are
+   cleared above the pivots too (reduced row echelon form).
+   It returns the rank, puts the pivot columns into `pivots` and the
+   determinant of the leading n x n block (if cols == n) into *det.
+   mod has to be prime. */
+static int
+modmatrix_eliminate(std::vector<unsigned int> &a, int n, int w, int cols, bool reduced,
+                    const modmatrix_barrett &bt, std::vector<int> *pivots,
+                    unsigned int *det) {
+    unsigned int mod = bt.mod;
+    unsigned int d = 1 % mod;
+    int r = 0;
+    for (int c = 0; c < cols && r < n; c++) {
+        int p = r;
+        while (p < n && a[(size_t)p * w + c] == 0) p++;
+        if (p == n) {
+            d = 0;
+            continue;
+        }
+        unsigned int *pr = a.data() + (size_t)r * w;
+        if (p != r) {
+            std::swap_ranges(pr + c, pr + w, a.data() + (size_t)p * w + c);
+            d = d ? mod - d : 0;
+        }
+        d = bt.mul(d, pr[c]);
+        unsigned int iv = bt.inv(pr[c]);
+        for (int j = c; j < w; j++) pr[j] = bt.mul(pr[j], iv);
+        for (int i = reduced ? 0 : r + 1; i < n; i++) {
+            if (i == r) continue;
+            unsigned int *ir = a.data() + (size_t)i * w;
+            unsigned int f = ir[c];
+            if (!f) continue;
+            f = mod - f;
+            for (int j = c; j < w; j++) ir[j] = bt.reduce(ir[j] + (unsigned long long)f * pr[j]);
+        }
+        if (pivots) pivots->push_back(c);
+        r++;
+    }
+    if (r < cols) d = 0;
+    if (det) *det = d;
+    return r;
+}
+
+} // namespace internal
+
+
+
+static ModMatrixObject *
+modmatrix_alloc(int n, int m) {
+    ModMatrixObject *self = (ModMatrixObject *)ModMatrixType.tp_alloc(&ModMatrixType, 0);
+    if (self == NULL) return NULL;
+    self->n = n;
+    self->m = m;
+    self->mod = ModIntObject::mod;
+    self->a = std::vector<unsigned int>((size_t)n * m, 0);
+    return self;
+}
+
+static int
+modmatrix_check_mod(ModMatrixObject *self) {
+    if (ModIntObject::mod == 0) {
+        PyErr_SetString(PyExc_ValueError, "ModInt.set_mod() has not been called");
+        return -1;
+    }
+    if (self->mod != ModIntObject::mod) {
+        PyErr_Format(PyExc_ValueError,
+                     "the matrix was made in mod %u, but the mod of ModInt is %u now",
+                     self->mod, ModIntObject::mod);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+modmatrix_check_square(ModMatrixObject *self, const char *name) {
+    if (self->n != self->m) {
+        PyErr_Format(PyExc_ValueError, "%s() requires a square matrix (shape: %d x %d)",
+                     name, self->n, self->m);
+        return -1;
+    }
+    return 0;
+}
+
+static int
+modmatrix_check_prime(const char *name) {
+    if (!is_prime_u64(ModIntObject::mod)) {
+        PyErr_Format(PyExc_ValueError, "%s() requires a prime mod", name);
+        return -1;
+    }
+    return 0;
+}
+
+/* int or ModInt -> [0, mod) */
+static int
+modmatrix_convert_item(PyObject *o, unsigned int *v) {
+    if (!PyLong_Check(o) && !ModInt_Check(o)) {
+        PyErr_SetString(PyExc_TypeError, "required: 'int' or 'ModInt'");
+        return -1;
+    }
+    *v = UnsignedInt_FromPyObject(o);
+    if (*v == (unsigned int)-1 && PyErr_Occurred()) return -1;
+    return 0;
+}
+
+
+static PyObject *
+modmatrix_tolist_impl(ModMatrixObject *self) {
+    PyObject *list = PyList_New(self->n);
+    if (list == NULL) return NULL;
+    for (int i = 0; i < self->n; i++) {
+        PyObject *row = PyList_New(self->m);
+        if (row == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        const unsigned int *r = self->a.data() + (size_t)i * self->m;
+        for (int j = 0; j < self->m; j++) {
+            PyList_SET_ITEM(row, j, PyLong_FromUnsignedLong(r[j]));
+        }
+        PyList_SET_ITEM(list, i, row);
+    }
+    return list;
+}
+
+static PyObject *
+modmatrix_tolist(ModMatrixObject *self, PyObject *args) {
+    return modmatrix_tolist_impl(self);
+}
+
+PyDoc_STRVAR(modmatrix_tolist_doc,
+"tolist()\n"
+"--\n\n"
+"Conversion to list of rows\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : list[list[int]]\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm)"
+);
+
+#define ACL_PYTHON_MODMATRIX_TOLIST_METHODDEF \
+    {"tolist", (PyCFunction)modmatrix_tolist, METH_NOARGS, modmatrix_tolist_doc},
+
+
+static PyObject *
+modmatrix_repr(ModMatrixObject *self) {
+    PyObject *list = modmatrix_tolist_impl(self);
+    if (list == NULL) return NULL;
+    PyObject *name = PyUnicode_FromString("ModMatrix");
+    PyObject *res = sequential_object_repr((PyListObject *)list, name);
+    Py_DECREF(name);
+    Py_DECREF(list);
+    return res;
+}
+
+
+static PyObject *
+modmatrix_transpose(ModMatrixObject *self, PyObject *args) {
+    ModMatrixObject *z = modmatrix_alloc(self->m, self->n);
+    if (z == NULL) return NULL;
+    z->mod = self->mod;
+    for (int i = 0; i < self->n; i++) {
+        for (int j = 0; j < self->m; j++) {
+            z->a[(size_t)j * self->n + i] = self->a[(size_t)i * self->m + j];
+        }
+    }
+    return (PyObject *)z;
+}
+
+PyDoc_STRVAR(modmatrix_transpose_doc,
+"transpose()\n"
+"--\n\n"
+"It returns the transposed matrix.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : ModMatrix\n"
+"    m x n matrix\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm)"
+);
+
+#define ACL_PYTHON_MODMATRIX_TRANSPOSE_METHODDEF \
+    {"transpose", (PyCFunction)modmatrix_transpose, METH_NOARGS, modmatrix_transpose_doc},
+
+
+static PyObject *
+modmatrix_det(ModMatrixObject *self, PyObject *args) {
+    if (modmatrix_check_mod(self)) return NULL;
+    if (modmatrix_check_square(self, "det")) return NULL;
+    if (modmatrix_check_prime("det")) return NULL;
+    internal::modmatrix_barrett bt;
+    std::vector<unsigned int> a = self->a;
+    unsigned int d;
+    int n = self->n;
+    Py_BEGIN_ALLOW_THREADS
+    internal::modmatrix_eliminate(a, n, n, n, false, bt, NULL, &d);
+    Py_END_ALLOW_THREADS
+    return (PyObject *)ModInt_FromUnsignedInt(d);
+}
+
+PyDoc_STRVAR(modmatrix_det_doc,
+"det()\n"
+"--\n\n"
+"It returns the determinant.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : ModInt\n"
+"    determinant\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"n == m\n"
+"mod is prime\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n^3)"
+);
+
+#define ACL_PYTHON_MODMATRIX_DET_METHODDEF \
+    {"det", (PyCFunction)modmatrix_det, METH_NOARGS, modmatrix_det_doc},
+
+
+static PyObject *
+modmatrix_rank(ModMatrixObject *self, PyObject *args) {
+    if (modmatrix_check_mod(self)) return NULL;
+    if (modmatrix_check_prime("rank")) return NULL;
+    internal::modmatrix_barrett bt;
+    std::vector<unsigned int> a = self->a;
+    int n = self->n, m = self->m, r;
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::modmatrix_eliminate(a, n, m, m, false, bt, NULL, NULL);
+    Py_END_ALLOW_THREADS
+    return PyLong_FromLong(r);
+}
+
+PyDoc_STRVAR(modmatrix_rank_doc,
+"rank()\n"
+"--\n\n"
+"It returns the rank.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"    rank\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"mod is prime\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm min(n, m))"
+);
+
+#define ACL_PYTHON_MODMATRIX_RANK_METHODDEF \
+    {"rank", (PyCFunction)modmatrix_rank, METH_NOARGS, modmatrix_rank_doc},
+
+
+/* NULL with ValueError if it is singular */
+static ModMatrixObject *
+modmatrix_inv_impl(ModMatrixObject *self) {
+    int n = self->n, w = 2 * n, r;
+    internal::modmatrix_barrett bt;
+    std::vector<unsigned int> a((size_t)n * w, 0);
+    for (int i = 0; i < n; i++) {
+        std::copy(self->a.begin() + (size_t)i * n, self->a.begin() + (size_t)(i + 1) * n,
+                  a.begin() + (size_t)i * w);
+        a[(size_t)i * w + n + i] = 1 % bt.mod;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::modmatrix_eliminate(a, n, w, n, true, bt, NULL, NULL);
+    Py_END_ALLOW_THREADS
+    if (r < n) {
+        PyErr_SetString(PyExc_ValueError, "the matrix is singular");
+        return NULL;
+    }
+    ModMatrixObject *z = modmatrix_alloc(n, n);
+    if (z == NULL) return NULL;
+    for (int i = 0; i < n; i++) {
+        std::copy(a.begin() + (size_t)i * w + n, a.begin() + (size_t)(i + 1) * w,
+                  z->a.begin() + (size_t)i * n);
+    }
+    return z;
+}
+
+static PyObject *
+modmatrix_inv(ModMatrixObject *self, PyObject *args) {
+    if (modmatrix_check_mod(self)) return NULL;
+    if (modmatrix_check_square(self, "inv")) return NULL;
+    if (modmatrix_check_prime("inv")) return NULL;
+    return (PyObject *)modmatrix_inv_impl(self);
+}
+
+PyDoc_STRVAR(modmatrix_inv_doc,
+"inv()\n"
+"--\n\n"
+"It returns the inverse matrix.\n"
+"If the matrix is singular, it raises ValueError.\n\n"
+"Parameters\n"
+"----------\n"
+"Nothing\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : ModMatrix\n"
+"    inverse matrix\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"n == m\n"
+"mod is prime\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n^3)"
+);
+
+#define ACL_PYTHON_MODMATRIX_INV_METHODDEF \
+    {"inv", (PyCFunction)modmatrix_inv, METH_NOARGS, modmatrix_inv_doc},
+
+
+static PyObject *
+modmatrix_solve(ModMatrixObject *self, PyObject *arg) {
+    if (modmatrix_check_mod(self)) return NULL;
+    if (modmatrix_check_prime("solve")) return NULL;
+    if (!PyList_Check(arg) || PyList_GET_SIZE(arg) != self->n) {
+        PyErr_Format(PyExc_ValueError, "solve() takes a list of length %d", self->n);
+        return NULL;
+    }
+    int n = self->n, m = self->m, w = m + 1, r;
+    internal::modmatrix_barrett bt;
+    std::vector<unsigned int> a((size_t)n * w);
+    for (int i = 0; i < n; i++) {
+        std::copy(self->a.begin() + (size_t)i * m, self->a.begin() + (size_t)(i + 1) * m,
+                  a.begin() + (size_t)i * w);
+        if (modmatrix_convert_item(PyList_GET_ITEM(arg, i), &a[(size_t)i * w + m])) return NULL;
+    }
+    std::vector<int> pivots;
+    Py_BEGIN_ALLOW_THREADS
+    r = internal::modmatrix_eliminate(a, n, w, m, true, bt, &pivots, NULL);
+    Py_END_ALLOW_THREADS
+    for (int i = r; i < n; i++) {
+        if (a[(size_t)i * w + m]) Py_RETURN_NONE;
+    }
+    std::vector<unsigned int> x(m, 0);
+    for (int i = 0; i < r; i++) x[pivots[i]] = a[(size_t)i * w + m];
+    return _PyList_FromVector(x);
+}
+
+PyDoc_STRVAR(modmatrix_solve_doc,
+"solve(b)\n"
+"--\n\n"
+"It returns a solution x of A x = b, or None if there is none.\n"
+"The free variables of x are set to 0.\n\n"
+"Parameters\n"
+"----------\n"
+"b : list[int | ModInt]\n"
+"    right-hand side of length n\n"
+"\n"
+"Returns\n"
+"-------\n"
+"x : list[int] | None\n"
+"    solution of length m\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"len(b) == n\n"
+"mod is prime\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm min(n, m))"
+);
+
+#define ACL_PYTHON_MODMATRIX_SOLVE_METHODDEF \
+    {"solve", (PyCFunction)modmatrix_solve, METH_O, modmatrix_solve_doc},
+
+
+static PyObject *
+modmatrix_identity(PyObject *type, PyObject *arg) {
+    long n = PyLong_AsLong(arg);
+    CHECK_CONVERT(n);
+    if (n < 0 || n > (1L << 15)) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n <= 2^15");
+        return NULL;
+    }
+    if (ModIntObject::mod == 0) {
+        PyErr_SetString(PyExc_ValueError, "ModInt.set_mod() has not been called");
+        return NULL;
+    }
+    ModMatrixObject *z = modmatrix_alloc((int)n, (int)n);
+    if (z == NULL) return NULL;
+    for (int i = 0; i < n; i++) z->a[(size_t)i * n + i] = 1 % z->mod;
+    return (PyObject *)z;
+}
+
+PyDoc_STRVAR(modmatrix_identity_doc,
+"identity(n)\n"
+"--\n\n"
+"It returns the identity matrix of size n.\n\n"
+"Parameters\n"
+"----------\n"
+"n : int\n"
+"    size\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : ModMatrix\n"
+"    n x n identity matrix\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"mod is already set\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n^2)"
+);
+
+#define ACL_PYTHON_MODMATRIX_IDENTITY_METHODDEF \
+    {"identity", (PyCFunction)modmatrix_identity, METH_O | METH_CLASS, modmatrix_identity_doc},
+
+
+static PyMethodDef modmatrix_methods[] = {
+    ACL_PYTHON_MODMATRIX_TOLIST_METHODDEF
+    ACL_PYTHON_MODMATRIX_TRANSPOSE_METHODDEF
+    ACL_PYTHON_MODMATRIX_DET_METHODDEF
+    ACL_PYTHON_MODMATRIX_RANK_METHODDEF
+    ACL_PYTHON_MODMATRIX_INV_METHODDEF
+    ACL_PYTHON_MODMATRIX_SOLVE_METHODDEF
+    ACL_PYTHON_MODMATRIX_IDENTITY_METHODDEF
+    {NULL} /* Sentinel */
+};
+
+
+static PyObject *
+modmatrix_get_shape(ModMatrixObject *self, void *closure) {
+    return Py_BuildValue("(ii)", self->n, self->m);
+}
+
+static PyGetSetDef modmatrix_getsets[] = {
+    {"shape", (getter)modmatrix_get_shape, NULL, "(n, m)", NULL},
+    {NULL} /* Sentinel */
+};
+
+
+/* number protocol ****************************************/
+
+static PyObject *
+modmatrix_matmul(PyObject *v, PyObject *w) {
+    if (!ModMatrix_Check(v) || !ModMatrix_Check(w)) Py_RETURN_NOTIMPLEMENTED;
+    ModMatrixObject *a = (ModMatrixObject *)v, *b = (ModMatrixObject *)w;
+    if (modmatrix_check_mod(a) || modmatrix_check_mod(b)) return NULL;
+    if (a->m != b->n) {
+        PyErr_Format(PyExc_ValueError, "shapes (%d x %d) and (%d x %d) are not aligned",
+                     a->n, a->m, b->n, b->m);
+        return NULL;
+    }
+    ModMatrixObject *z = modmatrix_alloc(a->n, b->m);
+    if (z == NULL) return NULL;
+    internal::modmatrix_barrett bt;
+    // copied with the GIL held: another thread may re-initialize a or b
+    std::vector<unsigned int> x = a->a, y;
+    if (b != a) y = b->a;
+    const unsigned int *yp = b != a ? y.data() : x.data();
+    int n = a->n, l = a->m, m = b->m;
+    Py_BEGIN_ALLOW_THREADS
+    internal::modmatrix_mul_impl(x.data(), yp, z->a.data(), n, l, m, bt);
+    Py_END_ALLOW_THREADS
+    return (PyObject *)z;
+}
+
+static PyObject *
+modmatrix_scale(ModMatrixObject *a, PyObject *c) {
+    unsigned int x;
+    if (modmatrix_check_mod(a)) return NULL;
+    if (modmatrix_convert_item(c, &x)) return NULL;
+    internal::modmatrix_barrett bt;
+    ModMatrixObject *z = modmatrix_alloc(a->n, a->m);
+    if (z == NULL) return NULL;
+    for (size_t i = 0; i < a->a.size(); i++) z->a[i] = bt.mul(a->a[i], x);
+    return (PyObject *)z;
+}
+
+static PyObject *
+modmatrix_mul(PyObject *v, PyObject *w) {
+    if (ModMatrix_Check(v) && ModMatrix_Check(w)) return modmatrix_matmul(v, w);
+    if (ModMatrix_Check(v) && (PyLong_Check(w) || ModInt_Check(w))) {
+        return modmatrix_scale((ModMatrixObject *)v, w);
+    }
+    if (ModMatrix_Check(w) && (PyLong_Check(v) || ModInt_Check(v))) {
+        return modmatrix_scale((ModMatrixObject *)w, v);
+    }
+    Py_RETURN_NOTIMPLEMENTED;
+}
+
+/* sign = 1: v + w, sign = -1: v - w */
+static PyObject *
+modmatrix_add_impl(PyObject *v, PyObject *w, int sign) {
+    if (!ModMatrix_Check(v) || !ModMatrix_Check(w)) Py_RETURN_NOTIMPLEMENTED;
+    ModMatrixObject *a = (ModMatrixObject *)v, *b = (ModMatrixObject *)w;
+    if (modmatrix_check_mod(a) || modmatrix_check_mod(b)) return NULL;
+    if (a->n != b->n || a->m != b->m) {
+        PyErr_Format(PyExc_ValueError, "shapes (%d x %d) and (%d x %d) differ",
+                     a->n, a->m, b->n, b->m);
+        return NULL;
+    }
+    ModMatrixObject *z = modmatrix_alloc(a->n, a->m);
+    if (z == NULL) return NULL;
+    unsigned int mod = a->mod;
+    for (size_t i = 0; i < a->a.size(); i++) {
+        unsigned int x = a->a[i], y = b->a[i];
+        if (sign < 0) y = y ? mod - y : 0;
+        x += y;
+        if (x >= mod) x -= mod;
+        z->a[i] = x;
+    }
+    return (PyObject *)z;
+}
+
+static PyObject *
+modmatrix_add(PyObject *v, PyObject *w) {
+    return modmatrix_add_impl(v, w, 1);
+}
+
+static PyObject *
+modmatrix_sub(PyObject *v, PyObject *w) {
+    return modmatrix_add_impl(v, w, -1);
+}
+
+static PyObject *
+modmatrix_neg(PyObject *v) {
+    ModMatrixObject *a = (ModMatrixObject *)v;
+    if (modmatrix_check_mod(a)) return NULL;
+    ModMatrixObject *z = modmatrix_alloc(a->n, a->m);
+    if (z == NULL) return NULL;
+    for (size_t i = 0; i < a->a.size(); i++) z->a[i] = a->a[i] ? a->mod - a->a[i] : 0;
+    return (PyObject *)z;
+}
+
+static PyObject *
+modmatrix_pos(PyObject *v) {
+    Py_INCREF(v);
+    return v;
+}
+
+static PyObject *
+modmatrix_pow(PyObject *v, PyObject *w, PyObject *x) {
+    if (!ModMatrix_Check(v) || !PyLong_Check(w) || x != Py_None) Py_RETURN_NOTIMPLEMENTED;
+    ModMatrixObject *a = (ModMatrixObject *)v;
+    if (modmatrix_check_mod(a)) return NULL;
+    if (modmatrix_check_square(a, "pow")) return NULL;
+    int overflow;
+    long long k = PyLong_AsLongLongAndOverflow(w, &overflow);
+    if (overflow) {
+        PyErr_SetString(PyExc_OverflowError, "exponent -> long long");
+        return NULL;
+    }
+    CHECK_CONVERT(k);
+    unsigned long long e = (unsigned long long)k;
+    ModMatrixObject *base = a;
+    Py_INCREF(base);
+    if (k < 0) {
+        Py_DECREF(base);
+        if (modmatrix_check_prime("pow")) return NULL;
+        base = modmatrix_inv_impl(a);
+        if (base == NULL) return NULL;
+        e = 0ULL - e;  // |k|, also for k = -2^63
+    }
+    ModMatrixObject *z = modmatrix_alloc(a->n, a->n);
+    if (z == NULL) {
+        Py_DECREF(base);
+        return NULL;
+    }
+    internal::modmatrix_barrett bt;
+    int n = a->n;
+    // copied with the GIL held: another thread may re-initialize base
+    std::vector<unsigned int> b = base->a;
+    Py_DECREF(base);
+    Py_BEGIN_ALLOW_THREADS
+    z->a = internal::modmatrix_pow_impl(std::move(b), n, e, bt);
+    Py_END_ALLOW_THREADS
+    return (PyObject *)z;
+}
+
+
+static PyNumberMethods modmatrix_as_number = {
+    .nb_add = (binaryfunc)modmatrix_add,
+    .nb_subtract = (binaryfunc)modmatrix_sub,
+    .nb_multiply = (binaryfunc)modmatrix_mul,
+    .nb_power = (ternaryfunc)modmatrix_pow,
+    .nb_negative = (unaryfunc)modmatrix_neg,
+    .nb_positive = (unaryfunc)modmatrix_pos,
+    .nb_matrix_multiply = (binaryfunc)modmatrix_matmul,
+};
+
+
+/* mapping protocol: M[i, j] ******************************/
+
+static int
+modmatrix_parse_index(ModMatrixObject *self, PyObject *key, int *i, int *j) {
+    if (!PyTuple_Check(key) || PyTuple_GET_SIZE(key) != 2) {
+        PyErr_SetString(PyExc_TypeError, "ModMatrix indices must be a pair (i, j)");
+        return -1;
+    }
+    long x = PyLong_AsLong(PyTuple_GET_ITEM(key, 0));
+    if (x == -1 && PyErr_Occurred()) return -1;
+    long y = PyLong_AsLong(PyTuple_GET_ITEM(key, 1));
+    if (y == -1 && PyErr_Occurred()) return -1;
+    if (x < 0) x += self->n;
+    if (y < 0) y += self->m;
+    if (x < 0 || x >= self->n || y < 0 || y >= self->m) {
+        PyErr_SetString(PyExc_IndexError, "ModMatrix index out of range");
+        return -1;
+    }
+    *i = (int)x;
+    *j = (int)y;
+    return 0;
+}
+
+static PyObject *
+modmatrix_subscript(ModMatrixObject *self, PyObject *key) {
+    int i, j;
+    if (modmatrix_parse_index(self, key, &i, &j)) return NULL;
+    return (PyObject *)ModInt_FromUnsignedInt(self->a[(size_t)i * self->m + j]);
+}
+
+static int
+modmatrix_ass_subscript(ModMatrixObject *self, PyObject *key, PyObject *value) {
+    int i, j;
+    unsigned int v;
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "ModMatrix elements cannot be deleted");
+        return -1;
+    }
+    if (modmatrix_check_mod(self)) return -1;
+    if (modmatrix_parse_index(self, key, &i, &j)) return -1;
+    if (modmatrix_convert_item(value, &v)) return -1;
+    self->a[(size_t)i * self->m + j] = v;
+    return 0;
+}
+
+static Py_ssize_t
+modmatrix_length(ModMatrixObject *self) {
+    return (Py_ssize_t)self->n;
+}
+
+static PyMappingMethods modmatrix_as_mapping = {
+    .mp_length = (lenfunc)modmatrix_length,
+    .mp_subscript = (binaryfunc)modmatrix_subscript,
+    .mp_ass_subscript = (objobjargproc)modmatrix_ass_subscript,
+};
+
+
+static PyObject *
+modmatrix_richcompare(PyObject *self, PyObject *other, int op) {
+    if (!ModMatrix_Check(self) || !ModMatrix_Check(other)) Py_RETURN_NOTIMPLEMENTED;
+    if (op != Py_EQ && op != Py_NE) Py_RETURN_NOTIMPLEMENTED;
+    ModMatrixObject *a = (ModMatrixObject *)self, *b = (ModMatrixObject *)other;
+    bool eq = a->n == b->n && a->m == b->m && a->mod == b->mod && a->a == b->a;
+    if (eq == (op == Py_EQ)) Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+
+PyDoc_STRVAR(modmatrix_doc,
+"Dense matrix over the integers modulo the mod of ModInt.\n\n"
+"The following operations are supported:\n"
+"    '+', '-' (between ModMatrix of the same shape)\n"
+"    '@', '*' (matrix product; '*' also scales by an int or ModInt)\n"
+"    '**' (power of a square matrix; negative exponents use the inverse)\n"
+"    M[i, j] (get or set an element), '==', '!='\n\n"
+"You must first set the mod using the method ModInt.set_mod().\n"
+"A matrix keeps the mod it was made with and raises ValueError\n"
+"if the mod of ModInt has been changed since then.\n\n"
+"ModMatrix(a)  (Constructor 1)\n"
+"    Parameters\n"
+"    ----------\n"
+"    a : list[list[int | ModInt]]\n"
+"        rows of the same length\n"
+"    \n"
+"    Returns\n"
+"    -------\n"
+"    mat : ModMatrix\n"
+"    \n"
+"    Constraints\n"
+"    -----------\n"
+"    mod is already set\n"
+"    \n"
+"    Complexity\n"
+"    ----------\n"
+"    \u039F(nm)\n\n"
+"ModMatrix(n, m)  (Constructor 2)\n"
+"    Parameters\n"
+"    ----------\n"
+"    n : int\n"
+"        number of rows\n"
+"    m : int\n"
+"        number of columns\n"
+"    \n"
+"    Returns\n"
+"    -------\n"
+"    mat : ModMatrix\n"
+"        zero matrix\n"
+"    \n"
+"    Constraints\n"
+"    -----------\n"
+"    mod is already set\n"
+"    0 <= n, m and n * m <= 2^28\n"
+"    \n"
+"    Complexity\n"
+"    ----------\n"
+"    \u039F(nm)\n\n"
+"Operations ('@', '*' between matrices)\n"
+"    Cache-blocked product with SIMD inner loops; the sums are kept in\n"
+"    64 bits and reduced only every few terms.\n"
+"    \n"
+"    Complexity\n"
+"    ----------\n"
+"    \u039F(nml)\n\n"
+"Operations ('**')\n"
+"    Complexity\n"
+"    ----------\n"
+"    \u039F(n^3 log(k))"
+);
+
+
+static int
+modmatrix_init(ModMatrixObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *o, *o2 = NULL;
+    if (!PyArg_ParseTuple(args, "O|O", &o, &o2)) return -1;
+    if (ModIntObject::mod == 0) {
+        PyErr_SetString(PyExc_ValueError, "ModInt.set_mod() has not been called");
+        return -1;
+    }
+    self->mod = ModIntObject::mod;
+    if (o2 != NULL) {
+        long n = PyLong_AsLong(o);
+        if (n == -1 && PyErr_Occurred()) return -1;
+        long m = PyLong_AsLong(o2);
+        if (m == -1 && PyErr_Occurred()) return -1;
+        if (n < 0 || m < 0 || (n && m > (1L << 28) / n)) {
+            PyErr_SetString(PyExc_ValueError, "[constraints] 0 <= n, m and n * m <= 2^28");
+            return -1;
+        }
+        self->n = (int)n;
+        self->m = (int)m;
+        self->a = std::vector<unsigned int>((size_t)n * m, 0);
+        return 0;
+    }
+    if (!PyList_Check(o)) {
+        PyErr_SetString(PyExc_TypeError, "required: 'list[list[int]]' or (n, m)");
+        return -1;
+    }
+    Py_ssize_t n = PyList_GET_SIZE(o), m = 0;
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *row = PyList_GET_ITEM(o, i);
+        if (!PyList_Check(row)) {
+            PyErr_SetString(PyExc_TypeError, "required: 'list[list[int]]' or (n, m)");
+            return -1;
+        }
+        if (i == 0) m = PyList_GET_SIZE(row);
+        if (PyList_GET_SIZE(row) != m) {
+            PyErr_SetString(PyExc_ValueError, "all the rows must have the same length");
+            return -1;
+        }
+    }
+    if (n && m > (1L << 28) / n) {
+        PyErr_SetString(PyExc_ValueError, "[constraints] n * m <= 2^28");
+        return -1;
+    }
+    std::vector<unsigned int> a((size_t)n * m);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *row = PyList_GET_ITEM(o, i);
+        for (Py_ssize_t j = 0; j < m; j++) {
+            if (modmatrix_convert_item(PyList_GET_ITEM(row, j), &a[(size_t)i * m + j])) return -1;
+        }
+    }
+    self->n = (int)n;
+    self->m = (int)m;
+    self->a = std::move(a);
+    return 0;
+}
+
+static PyObject *
+modmatrix_new(PyTypeObject *type, PyObject *args, PyObject *kwargs) {
+    ModMatrixObject *self;
+    self = (ModMatrixObject *)type->tp_alloc(type, 0);
+    if (self != NULL) {
+        self->n = self->m = 0;
+        self->a = std::vector<unsigned int>();
+    }
+    return (PyObject *)self;
+}
+
+static void
+modmatrix_dealloc(ModMatrixObject *self) {
+    std::vector<unsigned int>().swap(self->a);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+
+PyTypeObject ModMatrixType = {
+    .ob_base = {PyObject_HEAD_INIT(NULL) 0},
+    .tp_name = "atcoder.ModMatrix",
+    .tp_basicsize = sizeof(ModMatrixObject),
+    .tp_itemsize = 0,
+    .tp_dealloc = (destructor)modmatrix_dealloc,
+    .tp_repr = (reprfunc)modmatrix_repr,
+    .tp_as_number = &modmatrix_as_number,
+    .tp_as_mapping = &modmatrix_as_mapping,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = modmatrix_doc,
+    .tp_richcompare = modmatrix_richcompare,
+    .tp_methods = modmatrix_methods,
+    .tp_getset = modmatrix_getsets,
+    .tp_init = (initproc)modmatrix_init,
+    .tp_new = modmatrix_new,
+    .tp_free = PyObject_Del,
+};
+
+
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_MODMATRIX
@@ -0,0 +1,442 @@
+#ifndef ACL_PYTHON_RANKSELECT
+#define ACL_PYTHON_RANKSELECT
+
+
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <structmember.h>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+#include "atcoder/utils"
+#include "atcoder/bitset"
+#include "atcoder/internal_rankselect"
+
+namespace atcoder_python {
+
+/* rank select object *****************************************/
+
+/* Rank/select index over the words of a BitSet, read in place. The index
+    holds a reference to the BitSet and counts as one of its exports, so the
+    words can not be reallocated (re-initialized) under it; the extra space
+    is the directory (about n / 32 bits) and the select samples. Changing
+    the bits afterwards leaves the index stale.
+
+    >>> bs = BitSet("10110")  # bits 1, 2, 4 are set
+    >>> rs = RankSelect(bs)
+    >>> rs.rank1(3)           # ones in [0, 3)
+    2
+    >>> rs.select1(2)         # position of the third one
+    4
+    >>> rs.select0(1)         # position of the second zero
+    3
+    >>> list(rs.rank1_many([0, 1, 2, 5]))
+    [0, 0, 1, 3]
+
+*/
+
+
+struct RankSelectObject {
+    PyObject_HEAD
+    internal::rank_select_index index;
+    BitSetObject *bs;   // owner of index.words, pinned through its exports
+};
+
+static void
+_rankselect_release(RankSelectObject *self) {
+    if (self->bs == NULL) return;
+    self->bs->exports--;
+    Py_CLEAR(self->bs);
+}
+
+PyDoc_STRVAR(rankselect_doc,
+"Rank/select index over the bits of a BitSet.\n"
+"The bits are read from the BitSet, which can not be re-initialized while\n"
+"the index is alive. After other changes to the BitSet the results are\n"
+"unspecified; build a new RankSelect instead.\n\n"
+"RankSelect(bs)\n"
+"    Parameters\n"
+"    ----------\n"
+"    bs : BitSet\n"
+"        bits to index\n"
+"    \n"
+"    Returns\n"
+"    -------\n"
+"    rs : RankSelect\n"
+"    \n"
+"    Complexity\n"
+"    ----------\n"
+"    \u039F(n / w), using about n / 32 bits besides the BitSet"
+);
+
+
+static Py_ssize_t
+rankselect_length(RankSelectObject *self) {
+    return (Py_ssize_t)self->index.n;
+}
+
+static PyObject *
+rankselect_item(RankSelectObject *self, Py_ssize_t i) {
+    if (i < 0 || i >= self->index.n) {
+        PyErr_Format(PyExc_IndexError, "index %zd is out of range", i);
+        return NULL;
+    }
+    return PyLong_FromLong((long)(self->index.words[i >> 6] >> (i & 63) & 1));
+}
+
+static PySequenceMethods rankselect_as_sequence = {
+    .sq_length = (lenfunc)rankselect_length,
+    .sq_item = (ssizeargfunc)rankselect_item,
+};
+
+
+static PyObject *
+rankselect_count(RankSelectObject *self, PyObject *args) {
+    return PyLong_FromLongLong(self->index.ones);
+}
+
+PyDoc_STRVAR(rankselect_count_doc,
+"count()\n"
+"--\n\n"
+"Number of ones.\n\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(1)"
+);
+
+#define ACL_PYTHON_RANKSELECT_COUNT_METHODDEF \
+    {"count", (PyCFunction)rankselect_count, METH_NOARGS, rankselect_count_doc},
+
+
+/* index argument checked against [0, bound) */
+static long long
+_rankselect_arg(PyObject *o, long long bound, const char *what) {
+    long long i = PyLong_AsLongLong(o);
+    if (i == -1 && PyErr_Occurred()) return -1;
+    if (i < 0 || i >= bound) {
+        PyErr_Format(PyExc_IndexError, "%s %lld is out of range", what, i);
+        return -1;
+    }
+    return i;
+}
+
+static PyObject *
+rankselect_rank1(RankSelectObject *self, PyObject *arg) {
+    long long i = _rankselect_arg(arg, self->index.n + 1, "index");
+    if (i < 0) return NULL;
+    return PyLong_FromLongLong(self->index.rank1(i));
+}
+
+PyDoc_STRVAR(rankselect_rank1_doc,
+"rank1(i)\n"
+"--\n\n"
+"Number of ones in [0, i).\n\n"
+"Parameters\n"
+"----------\n"
+"i : int\n"
+"    index\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= i <= n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(1)"
+);
+
+#define ACL_PYTHON_RANKSELECT_RANK1_METHODDEF \
+    {"rank1", (PyCFunction)rankselect_rank1, METH_O, rankselect_rank1_doc},
+
+
+static PyObject *
+rankselect_rank0(RankSelectObject *self, PyObject *arg) {
+    long long i = _rankselect_arg(arg, self->index.n + 1, "index");
+    if (i < 0) return NULL;
+    return PyLong_FromLongLong(i - self->index.rank1(i));
+}
+
+PyDoc_STRVAR(rankselect_rank0_doc,
+"rank0(i)\n"
+"--\n\n"
+"Number of zeros in [0, i).\n\n"
+"Parameters\n"
+"----------\n"
+"i : int\n"
+"    index\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= i <= n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(1)"
+);
+
+#define ACL_PYTHON_RANKSELECT_RANK0_METHODDEF \
+    {"rank0", (PyCFunction)rankselect_rank0, METH_O, rankselect_rank0_doc},
+
+
+static PyObject *
+rankselect_select1(RankSelectObject *self, PyObject *arg) {
+    long long k = _rankselect_arg(arg, self->index.ones, "rank");
+    if (k < 0) return NULL;
+    return PyLong_FromLongLong(self->index.select1(k));
+}
+
+PyDoc_STRVAR(rankselect_select1_doc,
+"select1(k)\n"
+"--\n\n"
+"Position of the k-th one (0-indexed).\n\n"
+"Parameters\n"
+"----------\n"
+"k : int\n"
+"    rank\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= k < count()\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(log(n / 512)) worst case, \u039F(1) when the ones are spread evenly"
+);
+
+#define ACL_PYTHON_RANKSELECT_SELECT1_METHODDEF \
+    {"select1", (PyCFunction)rankselect_select1, METH_O, rankselect_select1_doc},
+
+
+static PyObject *
+rankselect_select0(RankSelectObject *self, PyObject *arg) {
+    long long k = _rankselect_arg(arg, self->index.n - self->index.ones, "rank");
+    if (k < 0) return NULL;
+    return PyLong_FromLongLong(self->index.select0(k));
+}
+
+PyDoc_STRVAR(rankselect_select0_doc,
+"select0(k)\n"
+"--\n\n"
+"Position of the k-th zero (0-indexed).\n\n"
+"Parameters\n"
+"----------\n"
+"k : int\n"
+"    rank\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= k < n - count()\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(log(n / 512)) worst case, \u039F(1) when the zeros are spread evenly"
+);
+
+#define ACL_PYTHON_RANKSELECT_SELECT0_METHODDEF \
+    {"select0", (PyCFunction)rankselect_select0, METH_O, rankselect_select0_doc},
+
+
+/* f applied to every element of a list or integer buffer, each checked
+   against [0, bound); the results as array.array('i') */
+template <class F>
+static PyObject *
+_rankselect_many(PyObject *arg, long long bound, const char *what, F f) {
+    int err = 0;
+    std::vector<long long> q = _PyObject_AsVector<long long>(arg, &err);
+    if (err) return NULL;
+    std::vector<int> res(q.size());
+    for (size_t j = 0; j < q.size(); j++) {
+        if (q[j] < 0 || q[j] >= bound) {
+            PyErr_Format(PyExc_IndexError, "%s %lld is out of range", what, q[j]);
+            return NULL;
+        }
+        res[j] = (int)f(q[j]);
+    }
+    return _PyArray_FromVector(res, "i");
+}
+
+static PyObject *
+rankselect_rank1_many(RankSelectObject *self, PyObject *arg) {
+    const internal::rank_select_index &index = self->index;
+    return _rankselect_many(arg, index.n + 1, "index", [&](long long i) { return index.rank1(i); });
+}
+
+PyDoc_STRVAR(rankselect_rank1_many_doc,
+"rank1_many(indices)\n"
+"--\n\n"
+"rank1 of every index.\n\n"
+"Parameters\n"
+"----------\n"
+"indices : list[int] or buffer of integers\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'i'\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= indices[j] <= n\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(len(indices))"
+);
+
+#define ACL_PYTHON_RANKSELECT_RANK1_MANY_METHODDEF \
+    {"rank1_many", (PyCFunction)rankselect_rank1_many, METH_O, rankselect_rank1_many_doc},
+
+
+static PyObject *
+rankselect_select1_many(RankSelectObject *self, PyObject *arg) {
+    const internal::rank_select_index &index = self->index;
+    return _rankselect_many(arg, index.ones, "rank", [&](long long k) { return index.select1(k); });
+}
+
+PyDoc_STRVAR(rankselect_select1_many_doc,
+"select1_many(ks)\n"
+"--\n\n"
+"select1 of every rank.\n\n"
+"Parameters\n"
+"----------\n"
+"ks : list[int] or buffer of integers\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'i'\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= ks[j] < count()\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(len(ks) log(n / 512))"
+);
+
+#define ACL_PYTHON_RANKSELECT_SELECT1_MANY_METHODDEF \
+    {"select1_many", (PyCFunction)rankselect_select1_many, METH_O, rankselect_select1_many_doc},
+
+
+static PyObject *
+rankselect_select0_many(RankSelectObject *self, PyObject *arg) {
+    const internal::rank_select_index &index = self->index;
+    return _rankselect_many(arg, index.n - index.ones, "rank", [&](long long k) { return index.select0(k); });
+}
+
+PyDoc_STRVAR(rankselect_select0_many_doc,
+"select0_many(ks)\n"
+"--\n\n"
+"select0 of every rank.\n\n"
+"Parameters\n"
+"----------\n"
+"ks : list[int] or buffer of integers\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'i'\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"0 <= ks[j] < n - count()\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(len(ks) log(n / 512))"
+);
+
+#define ACL_PYTHON_RANKSELECT_SELECT0_MANY_METHODDEF \
+    {"select0_many", (PyCFunction)rankselect_select0_many, METH_O, rankselect_select0_many_doc},
+
+
+static PyMethodDef rankselect_methods[] = {
+    ACL_PYTHON_RANKSELECT_COUNT_METHODDEF
+    ACL_PYTHON_RANKSELECT_RANK1_METHODDEF
+    ACL_PYTHON_RANKSELECT_RANK0_METHODDEF
+    ACL_PYTHON_RANKSELECT_SELECT1_METHODDEF
+    ACL_PYTHON_RANKSELECT_SELECT0_METHODDEF
+    ACL_PYTHON_RANKSELECT_RANK1_MANY_METHODDEF
+    ACL_PYTHON_RANKSELECT_SELECT1_MANY_METHODDEF
+    ACL_PYTHON_RANKSELECT_SELECT0_MANY_METHODDEF
+    {NULL} /* Sentinel */
+};
+
+
+static int
+rankselect_init(RankSelectObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {(char*)"bs", NULL};
+    PyObject *o;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist, &BitSetType, &o)) return -1;
+    BitSetObject *bs = (BitSetObject *)o;
+    Py_INCREF(bs);
+    bs->exports++;
+    _rankselect_release(self);
+    self->bs = bs;
+    self->index.build(bs->bs.data(), bs->n);
+    return 0;
+}
+
+
+static PyObject *
+rankselect_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+    RankSelectObject *self;
+    self = (RankSelectObject *)type->tp_alloc(type, 0);
+    if (self == NULL) return NULL;
+    new (&self->index) internal::rank_select_index();
+    self->bs = NULL;
+    return (PyObject *)self;
+}
+
+static void
+rankselect_dealloc(RankSelectObject *self) {
+    self->index.~rank_select_index();
+    _rankselect_release(self);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+PyTypeObject RankSelectType = {
+    .ob_base = {PyObject_HEAD_INIT(NULL) 0},
+    .tp_name = "atcoder.RankSelect",
+    .tp_basicsize = sizeof(RankSelectObject),
+    .tp_itemsize = 0,
+    .tp_dealloc = (destructor)rankselect_dealloc,
+    .tp_as_sequence = &rankselect_as_sequence,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = rankselect_doc,
+    .tp_methods = rankselect_methods,
+    .tp_init = (initproc)rankselect_init,
+    .tp_new = rankselect_new,
+    .tp_free = PyObject_Del,
+};
+
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_RANKSELECT
@@ -0,0 +1,354 @@
+#ifndef ACL_PYTHON_STRING
+#define ACL_PYTHON_STRING
+
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "atcoder/utils"
+#include "atcoder/internal_bitset"
+#include "atcoder/internal_thread"
+
+
+
+namespace atcoder_python {
+namespace internal {
+
+
+/* bit-parallel string distances ***************************/
+
+/* LCS length and Levenshtein distance of a pattern a (length n) against
+   texts b, with the DP column over a packed into w = ceil(n / 64) words,
+   so one text character costs w word operations.
+
+   peq holds for every symbol c of a the mask of the positions i with
+   a[i] == c (bit i & 63 of word i >> 6, as in BitSet); the symbols of a
+   text that do not occur in a all use the zero row at index sigma.
+
+   lcs: Hyyrö's form of the Allison-Dix recurrence. V has a 0 at row i
+   iff the LCS of a[0..i] and the text so far grew at i; per character
+   with the match mask M,
+       V = (V + (V & M)) | (V & ~M)
+   where the addition runs over the words with a carry. The result is the
+   number of zeros of V.
+
+   levenshtein: Myers' bit-vector algorithm, with the vertical deltas of
+   the column in Pv/Mv (+1 / -1). Blocks are chained as in edlib: a block
+   takes the horizontal delta of the row above it and passes on the one of
+   its last row, so no carry is needed. The top row is D[0][j] = j, and
+   the score follows D[n][j] through the delta at bit n - 1.
+
+   The column updates are written as one fused loop over the words rather
+   than as calls to the bitset_kernels passes: the multiword addition (and
+   the block chaining of levenshtein) has no kernel, and composing the lcs
+   step from and_/andnot_/or_ around a scalar add pass reads the column
+   four times per character, which measured 1.3x (w = 256) to 3x (w <= 4)
+   slower. Only the final count goes through bitset_kernels.popcount.
+*/
+
+struct bitparallel_pattern {
+    int n = 0, w = 0;
+    std::vector<long long> symbols;        // sorted distinct symbols of a
+    std::vector<unsigned long long> peq;   // (symbols.size() + 1) x w
+
+    explicit bitparallel_pattern(const std::vector<long long> &a) {
+        n = (int)a.size();
+        w = (n + 63) >> 6;
+        symbols = a;
+        std::sort(symbols.begin(), symbols.end());
+        symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+        peq.assign((symbols.size() + 1) * w, 0);
+        for (int i = 0; i < n; i++) {
+            size_t c = std::lower_bound(symbols.begin(), symbols.end(), a[i]) - symbols.begin();
+            peq[c * w + (i >> 6)] |= 1ULL << (i & 63);
+        }
+    }
+
+    /* the peq row of every character of b */
+    std::vector<const unsigned long long *> rows(const std::vector<long long> &b) const {
+        std::vector<const unsigned long long *> res(b.size());
+        for (size_t j = 0; j < b.size(); j++) {
+            size_t c = std::lower_bound(symbols.begin(), symbols.end(), b[j]) - symbols.begin();
+            if (c < symbols.size() && symbols[c] != b[j]) c = symbols.size();
+            res[j] = peq.data() + c * w;
+        }
+        return res;
+    }
+
+    long long lcs(const std::vector<long long> &b) const {
+        if (n == 0) return 0;
+        std::vector<unsigned long long> v(w, ~0ULL);
+        for (const unsigned long long *m : rows(b)) {
+            unsigned long long carry = 0;
+            for (int k = 0; k < w; k++) {
+                unsigned long long x = v[k] & m[k], t = v[k] + x, s = t + carry;
+                carry = (t < x) | (s < t);
+                v[k] = s | (v[k] & ~m[k]);
+            }
+        }
+        if (n & 63) v[w - 1] &= (1ULL << (n & 63)) - 1;
+        return n - bitset_kernels.popcount(v.data(), w);
+    }
+
+    long long levenshtein(const std::vector<long long> &b) const {
+        if (n == 0) return (long long)b.size();
+        std::vector<unsigned long long> pv(w, ~0ULL), mv(w, 0);
+        long long score = n;
+        int last = (n - 1) & 63;
+        for (const unsigned long long *m : rows(b)) {
+            int hin = 1;  // D[0][j] - D[0][j - 1]
+            for (int k = 0; k < w; k++) {
+                unsigned long long eq = m[k], hneg = hin < 0 ? 1 : 0;
+                unsigned long long xv = eq | mv[k];
+                eq |= hneg;
+                unsigned long long xh = (((eq & pv[k]) + pv[k]) ^ pv[k]) | eq;
+                unsigned long long ph = mv[k] | ~(xh | pv[k]);
+                unsigned long long mh = pv[k] & xh;
+                int bit = k == w - 1 ? last : 63;
+                int hout = (int)(ph >> bit & 1) - (int)(mh >> bit & 1);
+                ph = ph << 1 | (hin > 0 ? 1 : 0);
+                mh = mh << 1 | hneg;
+                pv[k] = mh | ~(xv | ph);
+                mv[k] = ph & xv;
+                hin = hout;
+            }
+            score += hin;
+        }
+        return score;
+    }
+};
+
+} // namespace internal
+
+
+/* str -> code points; bytes-like, list[int] -> their values */
+static int
+_string_as_symbols(PyObject *o, std::vector<long long> &res) {
+    if (PyUnicode_Check(o)) {
+        if (PyUnicode_READY(o) == -1) return -1;
+        Py_ssize_t n = PyUnicode_GET_LENGTH(o);
+        int kind = PyUnicode_KIND(o);
+        const void *data = PyUnicode_DATA(o);
+        res.resize(n);
+        for (Py_ssize_t i = 0; i < n; i++) res[i] = (long long)PyUnicode_READ(kind, data, i);
+        return 0;
+    }
+    int err = 0;
+    res = _PyObject_AsVector<long long>(o, &err);
+    return err ? -1 : 0;
+}
+
+/* the shared part of lcs_length and levenshtein */
+template <class F>
+static PyObject *
+_string_distance(PyObject *args, const char *name, F f) {
+    PyObject *a_obj, *b_obj;
+    if (!PyArg_UnpackTuple(args, name, 2, 2, &a_obj, &b_obj)) return NULL;
+    std::vector<long long> a, b;
+    if (_string_as_symbols(a_obj, a) || _string_as_symbols(b_obj, b)) return NULL;
+    // the shorter string is the pattern: a smaller table for the same work
+    if (a.size() > b.size()) std::swap(a, b);
+    long long res;
+    Py_BEGIN_ALLOW_THREADS
+    internal::bitparallel_pattern p(a);
+    res = f(p, b);
+    Py_END_ALLOW_THREADS
+    return PyLong_FromLongLong(res);
+}
+
+/* the shared part of lcs_length_many and levenshtein_many */
+template <class F>
+static PyObject *
+_string_distance_many(PyObject *args, PyObject *kwargs, F f) {
+    static char *kwlist[] = {(char *)"a", (char *)"bs", (char *)"threads", NULL};
+    PyObject *a_obj, *bs_obj;
+    int threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|$i", kwlist, &a_obj, &bs_obj, &threads)) return NULL;
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must be non-negative");
+        return NULL;
+    }
+    std::vector<long long> a;
+    if (_string_as_symbols(a_obj, a)) return NULL;
+    PyObject *seq = PySequence_Fast(bs_obj, "bs must be a sequence of strings");
+    if (seq == NULL) return NULL;
+    Py_ssize_t k = PySequence_Fast_GET_SIZE(seq);
+    std::vector<std::vector<long long>> bs(k);
+    for (Py_ssize_t i = 0; i < k; i++) {
+        if (_string_as_symbols(PySequence_Fast_GET_ITEM(seq, i), bs[i])) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+    }
+    Py_DECREF(seq);
+    std::vector<long long> res(k);
+    threads = internal::resolve_threads(threads);
+    Py_BEGIN_ALLOW_THREADS
+    internal::bitparallel_pattern p(a);
+    internal::parallel_for((int)k, threads, [&](int i) {
+        res[i] = f(p, bs[i]);
+        std::vector<long long>().swap(bs[i]);
+    });
+    Py_END_ALLOW_THREADS
+    return _PyArray_FromVector(res, "q");
+}
+
+
+static PyObject *
+lcs_length(PyObject *module, PyObject *args) {
+    return _string_distance(args, "lcs_length", [](const internal::bitparallel_pattern &p,
+                                                   const std::vector<long long> &b) { return p.lcs(b); });
+}
+
+PyDoc_STRVAR(lcs_length_doc,
+"lcs_length($module, a, b, /)\n"
+"--\n\n"
+"It returns the length of the longest common subsequence of a and b,\n"
+"by the bit-parallel algorithm of Allison-Dix and Hyyrö.\n\n"
+"Parameters\n"
+"----------\n"
+"a : str | bytes-like | list[int]\n"
+"b : str | bytes-like | list[int]\n"
+"    sequences compared by code point / value\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm / w + (n + m) log(n))"
+);
+
+#define ACL_PYTHON_LCS_LENGTH_METHODDEF \
+    {"lcs_length", (PyCFunction)lcs_length, METH_VARARGS, lcs_length_doc},
+
+
+static PyObject *
+levenshtein(PyObject *module, PyObject *args) {
+    return _string_distance(args, "levenshtein", [](const internal::bitparallel_pattern &p,
+                                                    const std::vector<long long> &b) { return p.levenshtein(b); });
+}
+
+PyDoc_STRVAR(levenshtein_doc,
+"levenshtein($module, a, b, /)\n"
+"--\n\n"
+"It returns the edit distance (insertions, deletions and substitutions\n"
+"of cost 1) between a and b, by Myers' bit-vector algorithm.\n\n"
+"Parameters\n"
+"----------\n"
+"a : str | bytes-like | list[int]\n"
+"b : str | bytes-like | list[int]\n"
+"    sequences compared by code point / value\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : int\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(nm / w + (n + m) log(n))"
+);
+
+#define ACL_PYTHON_LEVENSHTEIN_METHODDEF \
+    {"levenshtein", (PyCFunction)levenshtein, METH_VARARGS, levenshtein_doc},
+
+
+static PyObject *
+lcs_length_many(PyObject *module, PyObject *args, PyObject *kwargs) {
+    return _string_distance_many(args, kwargs, [](const internal::bitparallel_pattern &p,
+                                                  const std::vector<long long> &b) { return p.lcs(b); });
+}
+
+PyDoc_STRVAR(lcs_length_many_doc,
+"lcs_length_many($module, a, bs, *, threads=0)\n"
+"--\n\n"
+"lcs_length(a, b) for every b in bs. The bit masks of a are built once.\n\n"
+"Parameters\n"
+"----------\n"
+"a : str | bytes-like | list[int]\n"
+"    query\n"
+"bs : Sequence[str | bytes-like | list[int]]\n"
+"    candidates\n"
+"threads : int\n"
+"    number of threads (0: all the cores)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'q'\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n sum(len(b)) / w)"
+);
+
+#define ACL_PYTHON_LCS_LENGTH_MANY_METHODDEF \
+    {"lcs_length_many", (PyCFunction)lcs_length_many, METH_VARARGS | METH_KEYWORDS, lcs_length_many_doc},
+
+
+static PyObject *
+levenshtein_many(PyObject *module, PyObject *args, PyObject *kwargs) {
+    return _string_distance_many(args, kwargs, [](const internal::bitparallel_pattern &p,
+                                                  const std::vector<long long> &b) { return p.levenshtein(b); });
+}
+
+PyDoc_STRVAR(levenshtein_many_doc,
+"levenshtein_many($module, a, bs, *, threads=0)\n"
+"--\n\n"
+"levenshtein(a, b) for every b in bs. The bit masks of a are built once.\n\n"
+"Parameters\n"
+"----------\n"
+"a : str | bytes-like | list[int]\n"
+"    query\n"
+"bs : Sequence[str | bytes-like | list[int]]\n"
+"    candidates\n"
+"threads : int\n"
+"    number of threads (0: all the cores)\n"
+"\n"
+"Returns\n"
+"-------\n"
+"result : array.array\n"
+"    typecode 'q'\n"
+"\n"
+"Constraints\n"
+"-----------\n"
+"Nothing\n"
+"\n"
+"Complexity\n"
+"----------\n"
+"\u039F(n sum(len(b)) / w)"
+);
+
+#define ACL_PYTHON_LEVENSHTEIN_MANY_METHODDEF \
+    {"levenshtein_many", (PyCFunction)levenshtein_many, METH_VARARGS | METH_KEYWORDS, levenshtein_many_doc},
+
+
+PyMethodDef stringfunctions[] = {
+    ACL_PYTHON_LCS_LENGTH_METHODDEF
+    ACL_PYTHON_LEVENSHTEIN_METHODDEF
+    ACL_PYTHON_LCS_LENGTH_MANY_METHODDEF
+    ACL_PYTHON_LEVENSHTEIN_MANY_METHODDEF
+    {NULL} /* Sentinel */
+};
+
+
+} // namespace atcoder_python
+
+
+#endif  // ACL_PYTHON_STRING
@@ -3,6 +3,8 @@
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
+#include <cstring>
+#include <type_traits>
 #include <vector>
 
 namespace atcoder_python {
@@ -84,7 +86,6 @@ _PyList_FromVector(std::vector<int> &v) {
     return list;
 }
 
-/* unused
 static PyObject *
 _PyList_FromVector(std::vector<long long> &v) {
     int n = v.size();
@@ -94,7 +95,16 @@ _PyList_FromVector(std::vector<long long> &v) {
     }
     return list;
 }
-*/
+
+static PyObject *
+_PyList_FromVector(std::vector<unsigned int> &v) {
+    int n = v.size();
+    PyObject *list = PyList_New(n);
+    for (int i = 0; i < n; i++) {
+        PyList_SetItem(list, i, PyLong_FromUnsignedLong((unsigned long)v[i]));
+    }
+    return list;
+}
 
 
 
@@ -116,6 +126,70 @@ _PyList_FromVectorVectorInt(std::vector<std::vector<int>> &v) {
 
 
 
+/* little-endian 64-bit limbs -> non-negative int */
+static PyObject *
+_PyLong_FromLimbs(const std::vector<unsigned long long> &limbs) {
+    if (limbs.empty()) return PyLong_FromLong(0);
+    unsigned char *bytes = (unsigned char *)PyMem_Malloc(limbs.size() * 8);
+    if (bytes == NULL) return PyErr_NoMemory();
+    for (size_t i = 0; i < limbs.size(); i++) {
+        for (int j = 0; j < 8; j++) bytes[8 * i + j] = (unsigned char)(limbs[i] >> (8 * j));
+    }
+    PyObject *res = _PyLong_FromByteArray(bytes, limbs.size() * 8, 1, 0);
+    PyMem_Free(bytes);
+    return res;
+}
+
+/* non-negative int -> count little-endian 64-bit limbs; -1 with
+   OverflowError if it is negative or does not fit */
+static int
+_PyLong_AsLimbs(PyObject *v, unsigned long long *limbs, size_t count) {
+    if (count == 0) {
+        int sign = _PyLong_Sign(v);
+        if (sign == 0) return 0;
+        PyErr_SetString(PyExc_OverflowError, sign < 0 ? "negative value" : "int too big to convert");
+        return -1;
+    }
+    unsigned char *bytes = (unsigned char *)PyMem_Malloc(count * 8);
+    if (bytes == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+#if PY_VERSION_HEX >= 0x030d0000
+    int r = _PyLong_AsByteArray((PyLongObject *)v, bytes, count * 8, 1, 0, 1);
+#else
+    int r = _PyLong_AsByteArray((PyLongObject *)v, bytes, count * 8, 1, 0);
+#endif
+    if (r == 0) {
+        for (size_t i = 0; i < count; i++) {
+            unsigned long long x = 0;
+            for (int j = 0; j < 8; j++) x |= (unsigned long long)bytes[8 * i + j] << (8 * j);
+            limbs[i] = x;
+        }
+    }
+    PyMem_Free(bytes);
+    return r;
+}
+
+/* vector -> array.array of the given typecode (the element size has to match) */
+template <class T>
+static PyObject *
+_PyArray_FromVector(const std::vector<T> &v, const char *typecode) {
+    PyObject *mod = PyImport_ImportModule("array");
+    if (mod == NULL) return NULL;
+    PyObject *res;
+    if (v.empty()) {
+        res = PyObject_CallMethod(mod, "array", "s", typecode);
+    } else {
+        res = PyObject_CallMethod(mod, "array", "sy#", typecode, (const char *)v.data(),
+                                  (Py_ssize_t)(v.size() * sizeof(T)));
+    }
+    Py_DECREF(mod);
+    return res;
+}
+
+
+
 /* list[int] -> vector<long long> */
 static std::vector<long long>
 _PyList_AsVectorLongLong(PyObject *list, int *err) {
@@ -123,22 +197,19 @@ _PyList_AsVectorLongLong(PyObject *list, int *err) {
     int overflow;
     std::vector<long long> res(n);
     for (int i = 0; i < n; i++) {
-        PyObject *v = PyList_GetItem(list, i);
+        PyObject *v = PyList_GetItem(list, i);  // borrowed reference
         if (!PyLong_Check(v)) {
             PyErr_SetString(PyExc_TypeError, "required : list[int]");
-            Py_DECREF(v);
             *err = 1;
             return res;
         }
         long long x = PyLong_AsLongLongAndOverflow(v, &overflow);
         if (overflow) {
             PyErr_SetString(PyExc_OverflowError, "overflow");
-            Py_DECREF(v);
             *err = 1;
             return res;
         }
         res[i] = x;
-        Py_DECREF(v);
     }
     return res;
 }
@@ -146,6 +217,114 @@ _PyList_AsVectorLongLong(PyObject *list, int *err) {
 
 
 
+/* buffer of integers (array.array, numpy.ndarray, ...) -> vector<R> */
+template <class R, class T>
+static int
+_buffer_copy_as(const char *p, Py_ssize_t n, std::vector<R> &res) {
+    res.resize(n);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        T v;
+        std::memcpy(&v, p + i * sizeof(T), sizeof(T));
+        if (std::is_signed<R>::value && std::is_unsigned<T>::value && sizeof(T) == 8
+            && (unsigned long long)v >> 63) {
+            PyErr_SetString(PyExc_OverflowError, "overflow");
+            return -1;
+        }
+        if (std::is_unsigned<R>::value && std::is_signed<T>::value && v < 0) {
+            PyErr_SetString(PyExc_OverflowError, "negative value");
+            return -1;
+        }
+        res[i] = (R)v;
+    }
+    return 0;
+}
+
+/* list[int] / tuple[int] / buffer of integers -> vector<R>
+   (R is long long or unsigned long long) */
+template <class R>
+static std::vector<R>
+_PyObject_AsVector(PyObject *o, int *err) {
+    std::vector<R> res;
+    if (PyObject_CheckBuffer(o)) {
+        Py_buffer view;
+        if (PyObject_GetBuffer(o, &view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) < 0) {
+            *err = 1;
+            return res;
+        }
+        const char *fmt = view.format ? view.format : "B";
+        if (*fmt == '@' || *fmt == '=' || *fmt == '<') fmt++;
+        const char *p = (const char *)view.buf;
+        Py_ssize_t n = view.itemsize ? view.len / view.itemsize : 0;
+        int r = -2;
+        if (fmt[0] && !fmt[1]) {
+            switch (fmt[0]) {
+                case 'b': r = _buffer_copy_as<R, signed char>(p, n, res); break;
+                case 'B': r = _buffer_copy_as<R, unsigned char>(p, n, res); break;
+                case 'h': r = _buffer_copy_as<R, short>(p, n, res); break;
+                case 'H': r = _buffer_copy_as<R, unsigned short>(p, n, res); break;
+                case 'i': r = _buffer_copy_as<R, int>(p, n, res); break;
+                case 'I': r = _buffer_copy_as<R, unsigned int>(p, n, res); break;
+                case 'l': r = _buffer_copy_as<R, long>(p, n, res); break;
+                case 'L': r = _buffer_copy_as<R, unsigned long>(p, n, res); break;
+                case 'q': r = _buffer_copy_as<R, long long>(p, n, res); break;
+                case 'Q': r = _buffer_copy_as<R, unsigned long long>(p, n, res); break;
+                case 'n': r = _buffer_copy_as<R, Py_ssize_t>(p, n, res); break;
+                case 'N': r = _buffer_copy_as<R, size_t>(p, n, res); break;
+            }
+        }
+        if (r == -2) PyErr_Format(PyExc_TypeError, "unsupported buffer format '%s'", view.format);
+        if (r) *err = 1;
+        PyBuffer_Release(&view);
+        return res;
+    }
+    PyObject *seq = PySequence_Fast(o, "required : list[int] or buffer of integers");
+    if (!seq) {
+        *err = 1;
+        return res;
+    }
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    res.resize(n);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *v = PySequence_Fast_GET_ITEM(seq, i);
+        if (!PyLong_Check(v)) {
+            PyErr_SetString(PyExc_TypeError, "required : list[int]");
+            *err = 1;
+            break;
+        }
+        if (std::is_signed<R>::value) {
+            int overflow;
+            res[i] = (R)PyLong_AsLongLongAndOverflow(v, &overflow);
+            if (overflow) {
+                PyErr_SetString(PyExc_OverflowError, "overflow");
+                *err = 1;
+                break;
+            }
+        } else {
+            res[i] = (R)PyLong_AsUnsignedLongLong(v);
+            if (PyErr_Occurred()) {
+                *err = 1;
+                break;
+            }
+        }
+    }
+    Py_DECREF(seq);
+    return res;
+}
+
+static std::vector<long long>
+_PyObject_AsVectorLongLong(PyObject *o, int *err) {
+    if (PyList_Check(o)) return _PyList_AsVectorLongLong(o, err);
+    return _PyObject_AsVector<long long>(o, err);
+}
+
+static std::vector<unsigned long long>
+_PyObject_AsVectorUnsignedLongLong(PyObject *o, int *err) {
+    return _PyObject_AsVector<unsigned long long>(o, err);
+}
+
+
+
+
 /* repr function for sequential object
 reference : https://github.com/python/cpython/blob/3.11/Objects/listobject.c
             379: list_repr
@@ -1,10 +1,13 @@
 from setuptools import setup, Extension
 
 sources = ['./aclpython/atcoder/atcoder.cpp']
-extra_compile_args = ['-std=c++17', '-O2', '-mtune=native',
-                      '-march=native', '-I./aclpython']
+# no -march=native: the SIMD kernels are compiled per function and
+# selected at import time, so the wheel runs on baseline x86-64
+extra_compile_args = ['-std=c++17', '-O2', '-pthread', '-I./aclpython']
+extra_link_args = ['-pthread']
 extensions = [Extension('atcoder',
                         sources=sources,
-                        extra_compile_args=extra_compile_args)]
+                        extra_compile_args=extra_compile_args,
+                        extra_link_args=extra_link_args)]
 
 setup(name='atcoder', version='0.1', ext_modules=extensions)
\ No newline at end of file